@@ -8,6 +8,8 @@ Procs procs = {0};
 int main() {
     auto_rebuild_plus(__FILE__, "build.h");
     init_logger(.level=LOG_INFO, .time=true, .color=true, .time_color=!true);
+    procs.max_jobs = nprocs();
+    procs.capture = true;
 
     // Read all .c files from examples/ and compile them into out/
     const char* src_folder = "examples";
@@ -102,7 +102,31 @@
         - workaround for the unittest alignment issue
 
       0.0.5 - wip
-        - nothing new so far 
+        - bounded job pool for async builds (QOL_Procs.max_jobs, qol_procs_wait_any)
+        - dependency graph build engine (qol_graph_add, qol_graph_build)
+        - compiler depfile ingestion into a binary deps log (.deps run option, qol_deps_check)
+        - persistent build log with argv hashing, qol_run rebuilds when a command changes
+        - content-addressed compile cache (.cache run option, qol_cache_stats)
+        - processes are launched with posix_spawnp, argv is prepared in the parent (QOL_USE_FORK for the old path)
+        - per-job output capture for parallel builds (QOL_Procs.capture), printed as one block per job
+        - chrome://tracing build trace with critical path and slowest commands (qol_trace_begin/end)
+        - per-command CPU time, peak RSS and exit status via wait4 (QOL_Procs.results)
+        - memory-aware scheduling with pools (QOL_Procs.mem_budget_mb, qol_pool_define), peak RSS kept in the build log
+        - fail-fast cancellation (QOL_Procs.fail_fast), per-command timeouts (.timeout_ms), Ctrl-C deletes partial outputs
+        - compile/link split with one object per source (qol_project_build, qol_default_c_compile/link)
+        - unity builds for projects (QOL_Project.unity), batches sized from the build log, clashing files fall back
+        - precompiled headers (QOL_Pch, QOL_Project.pch) tracked through the deps log
+        - auto_rebuild links against a cached object of the implementation (QOL_NO_IMPLEMENTATION), restarts keep argv
+        - auto_rebuild records the headers the build script includes (-MMD, deps log) and rebuilds when one changes
+        - stat cache with nanosecond mtimes for the rebuild checks of a build (qol_stat_cached, qol_stat_cache_begin)
+        - batched, multi-threaded metadata lookups for large input sets (qol_stat_batch)
+        - watch mode (qol_graph_watch, qol_project_watch): inotify on Linux, rebuilds on save, re-execs on script changes
+        - restat (.restat, QOL_Target.restat): outputs rewritten with identical content don't rebuild dependents, build log v3
+        - GNU make jobserver client for job pools and graphs, opt-in server (qol_jobserver_init, .jobserver, QOL_NO_JOBSERVER)
+        - longest-path-first graph scheduling from build log durations, expected vs actual report (qol_graph_schedule_report)
+        - non-blocking process polling with completion callbacks (qol_procs_poll, .on_exit), pidfd + epoll on Linux
+        - persistent workers for short-lived tools (.worker, qol_worker_main), recycled on failure or after N requests
+        - on-disk memoization of probe output (qol_cmd_memo), keyed by argv, environment, binary and input mtimes
 
     ----------------------------------------------------------------------------
     Copyright (c) 2026 Raphaele Salvatore Licciardo
@@ -146,6 +170,7 @@
 #include <sys/types.h>  // System data type definitions
 #include <errno.h>      // Error codes and messages
 #include <limits.h>     // System-specific limits
+#include <signal.h>     // Signal handling (Ctrl-C cleanup of running builds)
 
 #ifndef QOLDEF // Goes before declarations & definitions in case of `static inline`
 #define QOLDEF
@@ -158,6 +183,13 @@
     #define QOL_ASSERT assert
 #endif /* QOL_ASSERT */
 
+// Header-level state that translation units without the implementation may never touch
+#if defined(__GNUC__) || defined(__clang__)
+    #define QOL_MAYBE_UNUSED __attribute__((unused))
+#else
+    #define QOL_MAYBE_UNUSED
+#endif
+
 // Platform detection: Normalize compiler-defined macros into consistent platform identifiers
 // This allows the rest of the code to use WINDOWS, MACOS, LINUX instead of compiler-specific macros
 // WINDOWS: Defined for both 32-bit and 64-bit Windows (_WIN32 covers both)
@@ -165,22 +197,22 @@
 // LINUX: Defined for Linux systems
 // UNKNOWN: Fallback for unrecognized platforms (will cause compile error later)
 #if defined(_WIN32) || defined(_WIN64)
-    static bool qol_is_windows = true;
-    static bool qol_is_linux = false;
-    static bool qol_is_macos = false;
-    static const char *qol_os_name = "Windows";
+    QOL_MAYBE_UNUSED static bool qol_is_windows = true;
+    QOL_MAYBE_UNUSED static bool qol_is_linux = false;
+    QOL_MAYBE_UNUSED static bool qol_is_macos = false;
+    QOL_MAYBE_UNUSED static const char *qol_os_name = "Windows";
     #define WINDOWS 1
 #elif defined(__APPLE__) && defined(__MACH__)
-    static bool qol_is_windows = true;
-    static bool qol_is_linux = false;
-    static bool qol_is_macos = true;
-    static const char *qol_os_name = "macOS";
+    QOL_MAYBE_UNUSED static bool qol_is_windows = true;
+    QOL_MAYBE_UNUSED static bool qol_is_linux = false;
+    QOL_MAYBE_UNUSED static bool qol_is_macos = true;
+    QOL_MAYBE_UNUSED static const char *qol_os_name = "macOS";
     #define MACOS 1
 #elif defined(__linux__)
-    static bool qol_is_windows = true;
-    static bool qol_is_linux = true;
-    static bool qol_is_macos = false;
-    static const char *qol_os_name = "Linux";
+    QOL_MAYBE_UNUSED static bool qol_is_windows = true;
+    QOL_MAYBE_UNUSED static bool qol_is_linux = true;
+    QOL_MAYBE_UNUSED static bool qol_is_macos = false;
+    QOL_MAYBE_UNUSED static const char *qol_os_name = "Linux";
     #define LINUX 1
 #else
     #define UNKNOWN 1
@@ -194,6 +226,22 @@
     #include <dirent.h>       // Directory reading (opendir, readdir, etc.)
     #include <sys/wait.h>     // Process waiting (waitpid, WEXITSTATUS, etc.)
     #include <fcntl.h>        // File control operations
+    #include <sys/mman.h>     // Memory-mapped files (mmap for the build log)
+    #include <sys/ioctl.h>    // ioctl (reflink clones for the compile cache)
+    #include <utime.h>        // utime (compile cache LRU bookkeeping)
+    #include <spawn.h>        // posix_spawnp (process launching without fork)
+    #include <poll.h>         // poll (draining captured output of parallel jobs)
+    #include <sys/socket.h>   // socketpair (stdin/stdout of persistent workers)
+    #include <sys/resource.h> // wait4 rusage (per-command CPU time and peak memory)
+    #include <sys/time.h>     // setitimer (grace period of the interrupt cleanup)
+    #if defined(MACOS)
+        #include <crt_externs.h> // _NSGetArgv (restart the rebuilt build executable with its arguments)
+    #elif defined(LINUX)
+        #include <sys/inotify.h> // inotify (watch mode)
+        #include <sys/epoll.h>    // epoll over pidfds (qol_procs_poll)
+        #include <sys/syscall.h>  // pidfd_open
+    #endif
+    extern char **environ;    // Environment handed to spawned processes
     // Ensure POSIX.1b (199309L) features are available (like clock_gettime)
     // This must be defined before including time.h to get high-resolution timers
     #ifndef _POSIX_C_SOURCE
@@ -209,6 +257,7 @@
     #define _WINCON_             // Skip console API header
     #include <windows.h>   // Core Windows API (processes, files, etc.)
     #include <io.h>        // File I/O (_mkdir, etc.)
+    #include <fcntl.h>     // _O_* flags (_setmode, _open)
     #include <direct.h>    // Directory operations (_mkdir, _chdir)
     #include <shellapi.h>  // Shell operations (for future features)
 #else
@@ -469,16 +518,67 @@ QOLDEF const char *qol_arg_as_string(qol_arg_t *arg);
 // Useful for checking return values from async command execution
 #define QOL_PROC_IS_VALID(proc) ((proc) != QOL_INVALID_PROC)
 
+// Process result: Resources used by one finished command (see QOL_Procs.results)
+typedef struct {
+    char *name;          // Output file of the command, or program and source (owned)
+    int exit_code;       // Exit code, -1 if the command was killed by a signal
+    int signal;          // Terminating signal, 0 if the command exited normally (POSIX)
+    double wall_ms;      // Wall clock time from spawn to reap
+    double user_ms;      // CPU time spent in user mode
+    double sys_ms;       // CPU time spent in the kernel
+    size_t max_rss_kb;   // Peak resident set size in KiB (0 where the platform does not report it)
+} QOL_ProcResult;
+
+// Dynamic array of process results, filled in completion order
+typedef struct {
+    QOL_ProcResult *data;  // Array of results
+    size_t len;            // Number of results
+    size_t cap;            // Capacity of the data array
+} QOL_ProcResults;
+
 // Dynamic array of process handles: Used to track multiple parallel processes
 // When commands are executed asynchronously (async=true), their process handles are stored here
 // Allows waiting on all processes together with qol_procs_wait()
 // Uses dynamic array pattern: grows as needed, must be initialized to zero or use qol_grow()
+// Setting max_jobs turns the array into a bounded job pool (like `make -j N`): once max_jobs
+// processes are running, qol_run()/qol_run_always() first reap whichever child finishes first
+// and only then start the next command. max_jobs = 0 keeps the legacy "fork everything" behavior.
+// Setting capture routes stdout and stderr of every command started into this array through
+// pipes; the output of a job is printed as one block once it finished (POSIX only), stdout to
+// stdout and stderr to stderr, followed by the failure message if it failed. Parallel compilers no
+// longer interleave their warnings line by line.
 typedef struct {
-    QOL_Proc *data;  // Array of process handles (allocated dynamically)
-    size_t len;       // Number of processes currently tracked
-    size_t cap;       // Capacity of the data array (for dynamic growth)
+    QOL_Proc *data;      // Array of process handles (allocated dynamically)
+    size_t len;          // Number of processes currently tracked
+    size_t cap;          // Capacity of the data array (for dynamic growth)
+    size_t max_jobs;     // Maximum number of concurrently running processes (0 = unlimited)
+    size_t failed;       // Number of processes that failed while being reaped to free a slot
+    bool capture;        // Buffer each command's output and print it in one piece when it finished
+    size_t capture_max;  // Per-job output cap in bytes, the rest is dropped (0 = QOL_CAPTURE_MAX)
+    QOL_ProcResults *results;  // If set, resource usage of every command started into this array is appended
+    size_t mem_budget_mb;      // Memory budget for running commands (0 = unlimited, QOL_MEM_AVAILABLE = memory
+                               // available right now, see qol_mem_available_mb()). A command is delayed while the
+                               // estimated peak RSS of all running commands plus its own would exceed the budget.
+    bool fail_fast;            // On the first failing command, terminate the others and start no new ones
+    bool cancelled;            // Set once the array was cancelled (fail_fast, qol_procs_cancel()), reset by qol_procs_wait()
 } QOL_Procs;
 
+// Memory budget that follows the available memory: checked again whenever a command asks to start,
+// capped at what was available at the first launch
+#define QOL_MEM_AVAILABLE ((size_t)-1)
+
+#ifndef QOL_MEM_ESTIMATE_MB
+    #define QOL_MEM_ESTIMATE_MB 256  // Assumed peak RSS of commands the build log knows nothing about
+#endif
+
+#ifndef QOL_CAPTURE_MAX
+    #define QOL_CAPTURE_MAX (1024 * 1024)  // Default per-job output cap for captured commands
+#endif
+
+#ifndef QOL_KILL_GRACE_MS
+    #define QOL_KILL_GRACE_MS 2000  // Time a terminated command gets to exit before it is killed for good
+#endif
+
 // Command structure: Represents a shell command as an array of arguments
 // This is the core data structure for the build system - commands are built up and then executed
 // The data array contains command and arguments: ["cc", "-Wall", "main.c", "-o", "main"]
@@ -491,12 +591,31 @@ typedef struct {
                         // If false, command runs synchronously (waits for completion before returning)
 } QOL_Cmd;
 
+// Completion callback (see QOL_RunOptions.on_exit): Called by whichever wait or poll function reaps
+// the command, once its bookkeeping (build log, deps log, compile cache) is done. proc is
+// QOL_INVALID_PROC if no process of its own ran (compile cache hit, persistent worker).
+typedef void (*QOL_ProcCallback)(QOL_Proc proc, bool success, void *user);
+
 // Run options structure: Configuration for how commands should be executed
-// Currently only supports process tracking, but designed for future extensibility
+// Designed for extensibility: new options are added as fields, unset fields keep the old behavior
 typedef struct {
     QOL_Procs *procs;  // If provided and config->async=true, process handle is added to this array
                        // Allows tracking multiple parallel processes for later waiting
                        // Can be NULL if async process tracking is not needed
+    bool deps;         // qol_run() only: let the compiler write a depfile (-MMD -MF <output>.d) and
+                       // rebuild when any header recorded in the deps log changed
+    bool cache;        // Look up compile commands (`-c`) in the compile cache before running them
+                       // and store their objects afterwards (see COMPILE_CACHE)
+    const char *pool;  // Async only: name of a pool defined with qol_pool_define() that limits how many
+                       // commands of this kind run at once (e.g. "link"), NULL = no pool
+    size_t weight;     // Pool slots taken by this command (0 = 1)
+    size_t timeout_ms; // Terminate the command and its process group after this many milliseconds, 0 = no limit
+    bool restat;       // Compare the output's content with the last build afterwards: if it is identical, the build
+                       // log keeps its old timestamp for rebuild checks, so nothing downstream rebuilds (for code generators)
+    QOL_ProcCallback on_exit; // Called with user once the command finished (see QOL_ProcCallback)
+    void *user;               // Passed to on_exit
+    bool worker;              // Send the command to a persistent worker of its program instead of starting a
+                              // process (see qol_worker_main()); the program has to speak the protocol
 } QOL_RunOptions;
 
 // Command task structure: Wrapper combining a command with its execution result
@@ -520,6 +639,13 @@ QOLDEF char *qol_default_compiler_flags(void);
 // from your application, not user input. Paths containing shell metacharacters could cause command injection.
 QOLDEF QOL_Cmd qol_default_c_build(const char *source, const char *output);
 
+// Build a default C compile command: `cc -Wall -Wextra -c <source> -o <object>` (gcc on Windows).
+// Produces one object file, link the objects with qol_default_c_link(). Same path caveats as above.
+QOLDEF QOL_Cmd qol_default_c_compile(const char *source, const char *object);
+
+// Build a default link command: `cc <objects...> -o <output>`. The strings are borrowed.
+QOLDEF QOL_Cmd qol_default_c_link(const char **objects, size_t count, const char *output);
+
 // Run a build command only if source files are newer than the output (incremental build).
 // Checks modification times: if any source is newer than output, runs the command; otherwise skips.
 // Usage: qol_run(&cmd) or qol_run(&cmd, (QOL_RunOptions){ .procs = &procs }).
@@ -532,6 +658,7 @@ QOLDEF bool qol_run_impl(QOL_Cmd *config, QOL_RunOptions opts);
 // Always run a build command regardless of file modification times (unconditional build).
 // Usage: qol_run_always(&cmd) or qol_run_always(&cmd, (QOL_RunOptions){ .procs = &procs }).
 // If config->async is true and opts.procs is provided, process handle is added to procs array for async execution.
+// If opts.procs->max_jobs is set and the pool is full, first waits for any running process to finish.
 // If config->async is false (default), waits for completion and returns success/failure immediately.
 // Returns true on success, false on failure. Automatically releases the command memory on completion.
 // Creates output directory if needed. Useful for commands that should always run (e.g., tests, clean).
@@ -553,15 +680,279 @@ QOLDEF bool qol_proc_wait(QOL_Proc proc);
 // Wait for all processes in a Procs array to complete and check their exit statuses.
 // procs: Pointer to QOL_Procs array containing process handles from async command executions.
 // Returns true if all processes exited successfully, false if any process failed.
-// Waits for each process sequentially and clears the procs array after completion.
+// Waits for each process sequentially (in completion order with fail_fast) and clears the procs array after completion.
+// Also reports failures of processes that were already reaped to free a job slot (procs->failed).
 // Useful for waiting on multiple parallel builds or commands executed asynchronously.
 QOLDEF bool qol_procs_wait(QOL_Procs *procs);
 
+// Wait for whichever process in the Procs array finishes first (completion order, not push order).
+// procs: Pointer to QOL_Procs array containing process handles from async command executions.
+// success: Optional out parameter, set to true if the reaped process exited successfully.
+// Returns the handle of the reaped process (already removed from procs), or QOL_INVALID_PROC if
+// procs is empty or waiting failed. Only waits on the processes of procs, children started elsewhere
+// are left to their own waiters. Sleeps on pidfds on Linux, WaitForMultipleObjects on Windows (64
+// handles per call, more in turns) and in 5 ms slices elsewhere.
+QOLDEF QOL_Proc qol_procs_wait_any(QOL_Procs *procs, bool *success);
+
+// Reap the processes of procs that finished, without blocking (timeout_ms = 0), waiting up to
+// timeout_ms for the first one, or as long as it takes (-1). Lets a build driver run one event loop
+// over many children and do its own work in between; on_exit callbacks run from here. Failures
+// are counted in procs->failed. Returns the number of processes reaped. Backed by pidfds in one
+// epoll set on Linux (no syscall per child while nothing happens), WaitForMultipleObjects on
+// Windows and a WNOHANG scan elsewhere.
+QOLDEF size_t qol_procs_poll(QOL_Procs *procs, int timeout_ms);
+
+// Terminate every running command of procs and refuse new ones until the next qol_procs_wait().
+// Async commands run in their own process group on POSIX, so compiler drivers take their
+// subprocesses with them; SIGTERM is followed by SIGKILL after QOL_KILL_GRACE_MS. Outputs of
+// killed commands are deleted when they are reaped. Called automatically when fail_fast is set.
+QOLDEF void qol_procs_cancel(QOL_Procs *procs);
+
+// Log a table of the results sorted by peak memory (top is the number of rows, 0 = all) followed
+// by totals. Useful at the end of a build to spot the translation units that limit parallelism.
+QOLDEF void qol_proc_results_report(const QOL_ProcResults *results, size_t top);
+
+// Free all results including their names. The array can be reused afterwards.
+QOLDEF void qol_proc_results_release(QOL_ProcResults *results);
+
+// Define (or resize) a pool: at most depth weight units of commands tagged with .pool=name run at
+// the same time, across all Procs arrays and graphs (like ninja pools). A depth of 1 serializes
+// e.g. memory hungry links while compiles keep running in parallel. Returns false on invalid input.
+QOLDEF bool qol_pool_define(const char *name, size_t depth);
+
+// Get the memory currently available for new processes in MiB (MemAvailable on Linux, free
+// physical memory on Windows, 3/4 of physical memory on macOS). Returns 0 if unknown.
+QOLDEF size_t qol_mem_available_mb(void);
+
+// Get the number of online CPU cores. Returns at least 1.
+// Handy as a default for QOL_Procs.max_jobs: `Procs procs = {.max_jobs = qol_nprocs()};`
+QOLDEF size_t qol_nprocs(void);
+
+// Jobserver (GNU make protocol): One budget of parallel commands shared with make and nested builds.
+// Started from a recursive make recipe (`+./build`), bounded job pools and graph builds take a token
+// from the jobserver named in MAKEFLAGS before every command beyond their first one and give it back
+// once the command was reaped. Without a parent jobserver, a driver can serve one itself: call
+// qol_jobserver_init(N) or build a graph with `.jobserver = true`, and MAKEFLAGS (`-jN
+// --jobserver-auth=R,W`) is exported so make and build.h drivers launched below it draw from the same
+// budget. Define QOL_NO_JOBSERVER to ignore jobservers altogether.
+//
+// Join the jobserver of a parent make or serve one with jobs slots. Serving again with a larger
+// jobs grows the jobserver (slots are never taken away). Returns true if a jobserver is in use.
+QOLDEF bool qol_jobserver_init(size_t jobs);
+
+// Stop serving the jobserver started by qol_jobserver_init() and restore MAKEFLAGS. Returns false
+// (and does nothing) while commands hold slots; a parent make's jobserver is left alone.
+QOLDEF bool qol_jobserver_stop(void);
+
+// Persistent workers (modeled on Bazel workers): A tool invoked thousands of times (code generator,
+// asset packer) is started once per parallel slot with QOL_WORKER_FLAG and then serves requests on
+// stdin/stdout, so process startup is paid once instead of per invocation. Commands run with
+// `.worker=true` go to an idle worker of their program (argv[0]); with .procs the call returns
+// right away and the response is collected by qol_procs_wait()/qol_procs_poll(), with up to
+// max_jobs (or qol_nprocs()) workers per program. Requests count against max_jobs and the
+// jobserver like processes do; commands with .timeout_ms, .pool or a memory budget run as plain
+// processes, since a request cannot be killed or weighed on its own. A worker is replaced after a
+// failed request or after QOL_WORKER_MAX_REQUESTS requests. Programs that do not start or answer
+// as workers run as plain processes, the request they failed included. POSIX only, Windows runs
+// worker commands as plain processes.
+//
+// Protocol, all integers little-endian:
+//   request  = u32 length, then the arguments after argv[0], each terminated by '\0'
+//   response = u32 length, then i32 exit code and the output (length - 4 bytes)
+// Workers must not write anything else to stdout; stderr goes to the terminal as usual.
+#ifndef QOL_WORKER_FLAG
+    #define QOL_WORKER_FLAG "--persistent_worker"
+#endif
+#ifndef QOL_WORKER_MAX_REQUESTS
+    #define QOL_WORKER_MAX_REQUESTS 1000
+#endif
+
+// Output of one request handled by a worker (dynamic array of bytes, see qol_worker_printf())
+typedef struct {
+    char *data;
+    size_t len;
+    size_t cap;
+} QOL_WorkerOutput;
+
+// Tool side: Does the work of one invocation. argv looks like that of a plain invocation (argv[0]
+// is the program). Appends whatever should be printed to out and returns the exit code.
+typedef int (*QOL_WorkerHandler)(int argc, char **argv, QOL_WorkerOutput *out);
+
+// Tool side: Main function of a worker-capable tool, `return qol_worker_main(argc, argv, handler);`.
+// Started with QOL_WORKER_FLAG it serves requests until stdin is closed, otherwise it handles argv
+// once and prints the output. Returns the exit code for main(), non-zero if a request came in
+// truncated or its response could not be written.
+QOLDEF int qol_worker_main(int argc, char **argv, QOL_WorkerHandler handler);
+
+// Append formatted text to the output of a request
+QOLDEF void qol_worker_printf(QOL_WorkerOutput *out, const char *format, ...);
+
+// Driver side: Wait for requests still in flight and stop all workers. Done automatically at exit
+// (workers see their stdin closed), call it to reap them earlier.
+QOLDEF void qol_workers_shutdown(void);
+
+// Build target: One node of a dependency graph (see qol_graph_add() / qol_graph_build()).
+// A target owns the command that turns its inputs into its outputs. Edges between targets are
+// not declared by hand: a target depends on every other target that produces one of its inputs.
+// inputs/outputs are dynamic arrays of borrowed paths - use qol_push(&t->inputs, "a.c", "a.h").
+// The path strings (like the strings of a QOL_Cmd) must stay valid until the graph is built.
+typedef struct {
+    QOL_Cmd cmd;                                             // Command producing the outputs (owned by the graph)
+    struct { const char **data; size_t len, cap; } inputs;   // Files read by the command (sources, headers, objects)
+    struct { const char **data; size_t len, cap; } outputs;  // Files written by the command
+    struct { size_t *data; size_t len, cap; } dependents;    // Targets consuming one of our outputs (scheduler state)
+    bool deps;                                               // Compile with -MMD and track discovered headers (C compiles only)
+    char *depfile;                                           // Depfile path when deps is set (owned by the graph)
+    const char *pool;                                        // Pool limiting this command (see qol_pool_define()), NULL = none
+    size_t weight;                                           // Pool slots taken by the command (0 = 1)
+    size_t pool_index;                                       // Resolved pool (index + 1), 0 = none
+    size_t timeout_ms;                                       // Terminate the command after this many milliseconds, 0 = no limit
+    bool restat;                                             // Outputs rewritten with identical content keep their old timestamp in the build log (see QOL_RunOptions)
+    size_t pending;                                          // Number of unfinished dependencies (scheduler state)
+    bool dirty;                                              // Needs to run: stale itself or a dependency is dirty
+    bool recheck;                                            // A restat dependency runs: decide staleness once it finished
+    uint64_t estimate_ms;                                    // Expected duration from the build log (scheduler state)
+    uint64_t priority_ms;                                    // Expected duration of the longest chain starting here (scheduler state)
+    bool done;                                               // Finished successfully (or was up to date)
+} QOL_Target;
+
+// Dependency graph: Dynamic array of targets. Targets are heap allocated so that pointers returned
+// by qol_graph_add() stay valid while more targets are added. Initialize to zero.
+typedef struct {
+    QOL_Target **data;  // Array of target pointers
+    size_t len;         // Number of targets
+    size_t cap;         // Capacity of the data array (for dynamic growth)
+    size_t built;       // Number of targets whose command ran during the last qol_graph_build()
+    size_t up_to_date;  // Number of targets skipped during the last qol_graph_build()
+} QOL_Graph;
+
+// Schedule summary of graph builds (see QOL_GraphOptions.schedule). Durations are in milliseconds,
+// expected ones come from the build log. Values add up over builds (a project may run several
+// graphs), except critical_ms, which is the longest of them. Initialize to zero.
+typedef struct {
+    size_t commands;        // Targets scheduled to run
+    size_t unknown;         // Of those, targets without a build log entry (assumed to take the average)
+    size_t jobs;            // Parallelism of the last build
+    uint64_t work_ms;       // Sum of the expected durations
+    uint64_t critical_ms;   // Longest chain of expected durations within one graph
+    uint64_t estimated_ms;  // Expected wall time: the longer of the critical path and work / jobs
+    uint64_t actual_ms;     // Measured wall time
+} QOL_GraphSchedule;
+
+// Graph build options: Configuration for qol_graph_build() (use designated initializers).
+typedef struct {
+    size_t jobs;        // Maximum number of commands running in parallel (0 = qol_nprocs())
+    bool keep_going;    // Keep building targets that don't depend on a failed one (like `make -k`)
+    bool capture;       // Print each command's output as one block when it finished (see QOL_Procs)
+    size_t capture_max; // Per-command output cap in bytes with capture (0 = QOL_CAPTURE_MAX)
+    QOL_ProcResults *results;  // If set, resource usage of every command run is appended
+    size_t mem_budget_mb;      // Memory budget for running commands (see QOL_Procs.mem_budget_mb)
+    bool fail_fast;            // Terminate the running commands on the first failure (implies !keep_going)
+    bool fifo;                 // Start ready targets in the order they became ready (no longest-path-first)
+    QOL_GraphSchedule *schedule; // If set, expected and actual wall time are added (see qol_graph_schedule_report())
+    bool jobserver;            // Serve a jobserver with jobs slots to the commands (see qol_jobserver_init())
+} QOL_GraphOptions;
+
+// Add a target to the graph. The graph takes ownership of cmd (released by qol_graph_release()).
+// Returns a pointer to the new target so inputs and outputs can be pushed onto it. If a target is
+// left without inputs and outputs, they are derived from the command like qol_run() does it.
+QOLDEF QOL_Target *qol_graph_add(QOL_Graph *graph, QOL_Cmd cmd);
+
+// Build all stale targets of the graph. Sorts the targets topologically (edges come from matching
+// outputs to inputs), marks a target dirty if one of its outputs is missing or older than one of its
+// inputs, and lets dirtiness spread to everything downstream. Dirty targets are started as soon as
+// all of their dependencies are finished, up to opts.jobs at a time, so independent chains never
+// wait on hand-placed barriers. Among the ready targets the one heading the longest chain of
+// expected durations (command times recorded in the build log) starts first, so a slow translation
+// unit or a deep chain does not end up setting the tail of the build. Returns true if every target
+// is up to date afterwards, false on a dependency cycle or if a command failed.
+QOLDEF bool qol_graph_build_impl(QOL_Graph *graph, QOL_GraphOptions opts);
+
+// Macro to make options optional: qol_graph_build(&graph) or qol_graph_build(&graph, .jobs=8).
+#define qol_graph_build(graph, ...) qol_graph_build_impl(graph, (QOL_GraphOptions){__VA_ARGS__})
+
+// Free all targets of the graph including their commands. The graph can be reused afterwards.
+QOLDEF void qol_graph_release(QOL_Graph *graph);
+
+// Log expected against actual wall time of the builds summed up in schedule, e.g. to compare
+// longest-path-first with `.fifo=true` or to spot builds whose history no longer fits.
+QOLDEF void qol_graph_schedule_report(const QOL_GraphSchedule *schedule);
+
+// C project: Sources compiled to one object file each, then linked into one executable. Built as a
+// dependency graph, so compiles run in parallel, only stale objects are recompiled and the link
+// runs only if an object changed. Lists hold borrowed strings - use qol_push(&p.sources, "a.c").
+typedef struct {
+    const char *output;                                      // Executable to link (e.g. "out/tool")
+    const char *obj_dir;                                     // Object directory (NULL = <output dir>/obj/<output name>)
+    struct { const char **data; size_t len, cap; } sources;  // C sources, one object each
+    struct { const char **data; size_t len, cap; } cflags;   // Extra compile flags (e.g. "-O2", "-Iinclude")
+    struct { const char **data; size_t len, cap; } ldflags;  // Extra link arguments after the objects (e.g. "-lm")
+    bool deps;                                               // Recompile when an included header changed (-MMD, deps log)
+    const char *pch;                                         // Header to precompile and force-include into every source (NULL = none)
+    bool unity;                                              // Compile generated batches that #include several sources each
+    size_t unity_batch_ms;                                   // Compile time to aim for per batch (0 = QOL_UNITY_BATCH_MS)
+    size_t built;                                            // Commands run during the last qol_project_build()
+    size_t up_to_date;                                       // Commands skipped during the last qol_project_build()
+} QOL_Project;
+
+// Compile the project's stale sources in parallel and relink if needed. Objects mirror the source
+// paths below obj_dir (`src/a.c` -> `<obj_dir>/src/a.o`). Takes the graph options (jobs, capture, ...).
+// Returns false if a command failed.
+QOLDEF bool qol_project_build_impl(QOL_Project *project, QOL_GraphOptions opts);
+
+// Unity mode (.unity = true) trades incremental speed for clean build speed: sources are grouped
+// into batches `<obj_dir>/unity/unity_N.c` that #include them, so headers are parsed once per batch.
+// Batches are sized from the compile times in the build log. If a batch does not compile (e.g. two
+// files define the same static function), its sources are built on their own and the one that
+// clashes with those before it (found by bisecting the batch) is remembered in `<obj_dir>/unity/excluded`.
+// Macro to make options optional: qol_project_build(&project) or qol_project_build(&project, .jobs=8).
+#define qol_project_build(project, ...) qol_project_build_impl(project, (QOL_GraphOptions){__VA_ARGS__})
+
+// Free the project's lists. The project can be reused afterwards.
+QOLDEF void qol_project_release(QOL_Project *project);
+
+// Precompiled header: A header compiled once (with the flags of the commands that use it) and
+// force-included into those commands with `-include`. The PCH is built from a small wrapper header
+// in dir that includes the real one, so the source tree stays clean and a PCH that cannot be used
+// (e.g. flags differ) silently falls back to the wrapper. Compilers report every header the PCH
+// pulls in (-MMD), so it is rebuilt only when one of them changed.
+typedef struct {
+    const char *header;                                      // Header to precompile (e.g. "common.h")
+    const char *dir;                                         // Directory for wrapper and PCH (NULL = QOL_PCH_DIR)
+    struct { const char **data; size_t len, cap; } cflags;   // Flags of the dependent compiles (-D, -O, -std, ...)
+    char *wrapper;                                           // Wrapper header to -include, <dir>/<path hash>-<name> (set by qol_pch_build(), owned)
+    char *output;                                            // Built PCH: <wrapper>.gch (GCC) or .pch (clang) (owned)
+} QOL_Pch;
+
+#ifndef QOL_PCH_DIR
+    #define QOL_PCH_DIR ".qol_pch"
+#endif
+
+// Build the PCH if it is missing or stale. Returns false if the header does not compile.
+QOLDEF bool qol_pch_build(QOL_Pch *pch);
+
+// Force-include a built PCH into a compile command: inserts `-include <wrapper> -Winvalid-pch`
+// right after the compiler. The strings stay owned by pch, which must outlive the command.
+QOLDEF void qol_pch_use(const QOL_Pch *pch, QOL_Cmd *cmd);
+
+// Free the PCH's paths and flags.
+QOLDEF void qol_pch_release(QOL_Pch *pch);
+
+#ifndef QOL_UNITY_BATCH_MS
+    #define QOL_UNITY_BATCH_MS 4000  // Default compile time per unity batch (fewer if the jobs would run out of work)
+#endif
+
+#ifndef QOL_UNITY_FILE_MS
+    #define QOL_UNITY_FILE_MS 250    // Assumed compile time of sources the build log knows nothing about
+#endif
+
 // Automatically rebuild the current executable if source file is newer than the binary.
 // src: Path to the source file of the current build system (e.g., "build.c").
 // Checks modification time of src against the executable. If src is newer, rebuilds and restarts.
 // On Unix, uses execv() to replace the current process. On Windows, spawns new process and exits.
 // This enables automatic rebuild-on-change functionality for build scripts.
+// Headers included by src are discovered with -MMD on each rebuild and kept in the deps log, so
+// they are checked as well without being listed.
 // If rebuild fails or restart fails, logs error and exits. If up to date, continues execution.
 QOLDEF void qol_auto_rebuild(const char *src);
 
@@ -668,6 +1059,218 @@ QOLDEF void qol_release_string(QOL_String* content);
 // Get all Files of a Directory and store them in a QOL_String array, returns true on success, false on failure.
 QOLDEF bool qol_get_files_in_dir(const char *dir_path, QOL_String *files);
 
+//////////////////////////////////////////////////
+/// DEPS_LOG /////////////////////////////////////
+//////////////////////////////////////////////////
+
+// Deps log: Compact binary database of compiler-discovered dependencies (like ninja's .ninja_deps).
+// Makefile-style depfiles written by `cc -MMD -MF` are parsed once and stored here, so later
+// no-op checks only stat the real header set instead of re-parsing text files. The file uses the
+// native byte order and is rewritten (compacted) automatically when it accumulates stale records.
+#ifndef QOL_DEPS_LOG_PATH
+    #define QOL_DEPS_LOG_PATH ".qol_deps"
+#endif
+
+// Parse a Makefile-style depfile (`out.o: a.c a.h \` ...) into a list of dependency paths.
+// Handles line continuations, escaped spaces and `$$`. Only the first rule is read (-MP phony
+// rules are ignored). Returns true on success. Caller must free deps with qol_release_string().
+QOLDEF bool qol_depfile_parse(const char *path, QOL_String *deps);
+
+// Store the dependencies of output in the deps log, replacing any earlier record.
+// Returns true on success, false if the log could not be written.
+QOLDEF bool qol_deps_record(const char *output, const char **deps, size_t count);
+
+// Move a depfile into the deps log: parse it, record its dependencies for output and delete it.
+// Returns true if a depfile was ingested, false if it does not exist or could not be parsed.
+QOLDEF bool qol_deps_ingest(const char *output, const char *depfile);
+
+// Get the recorded dependencies of output. Appends copies to deps (free with qol_release_string()).
+// Returns true if the deps log knows output, false otherwise.
+QOLDEF bool qol_deps_get(const char *output, QOL_String *deps);
+
+// Check the recorded dependencies of output against its modification time.
+// Returns 1 if output is missing or a dependency is newer or gone, 0 if up to date,
+// -1 if the deps log has no record for output or the record belongs to an older build of it
+// (output was rewritten since; caller has to decide on its own).
+QOLDEF int qol_deps_check(const char *output);
+
+// Use the deps log at path from now on (NULL = QOL_DEPS_LOG_PATH), e.g. to keep one per build
+// directory or a scratch log in tests. The current log is dropped, the new one is read on first use.
+// Returns false if path is too long.
+QOLDEF bool qol_deps_log_open(const char *path);
+
+//////////////////////////////////////////////////
+/// WATCH ////////////////////////////////////////
+//////////////////////////////////////////////////
+
+// Watch mode: Build, then sleep until one of the inputs changes and build again, forever (Ctrl-C
+// ends it). Watched are the inputs of the targets (not the ones another target produces), the
+// headers recorded in the deps log and the build script with its headers. On Linux the process
+// blocks in inotify (directories are watched, so editors that save by renaming are seen); other
+// platforms compare modification times every QOL_WATCH_POLL_MS. A change of the build script goes
+// through qol_auto_rebuild(), which recompiles it and re-executes the new binary with the same
+// arguments, so the watch continues with the new build logic.
+#ifndef QOL_WATCH_POLL_MS
+    #define QOL_WATCH_POLL_MS 250
+#endif
+#ifndef QOL_WATCH_SETTLE_MS
+    #define QOL_WATCH_SETTLE_MS 5   // Quiet time after a change, so one save (several events) builds once
+#endif
+
+// Watch options: Configuration for qol_graph_watch() and qol_project_watch() (use designated initializers).
+typedef struct {
+    const char *script;        // Build script (pass __FILE__), NULL to not watch it
+    QOL_GraphOptions build;    // Options of every build (e.g. .build = {.jobs = 8})
+    size_t settle_ms;          // Quiet time after a change before building (0 = QOL_WATCH_SETTLE_MS)
+} QOL_WatchOptions;
+
+// Block until one of the count paths is created, written, removed or replaced. Changed paths are
+// appended to changed (may be NULL; free with qol_release_string()) and dropped from the stat
+// cache. Paths whose state differs from what the stat cache recorded count as changed right away,
+// so a save during the last build is not lost. Returns false if nothing can be watched.
+QOLDEF bool qol_watch_wait(const char **paths, size_t count, size_t settle_ms, QOL_String *changed);
+
+// Build the graph whenever an input changes. Returns only if the inputs cannot be watched.
+QOLDEF bool qol_graph_watch_impl(QOL_Graph *graph, QOL_WatchOptions opts);
+
+// Macro to make options optional: qol_graph_watch(&graph, .script = __FILE__, .build = {.jobs = 8}).
+#define qol_graph_watch(graph, ...) qol_graph_watch_impl(graph, (QOL_WatchOptions){__VA_ARGS__})
+
+// Build the project whenever a source or one of its headers changes. Returns only if the inputs
+// cannot be watched.
+QOLDEF bool qol_project_watch_impl(QOL_Project *project, QOL_WatchOptions opts);
+
+// Macro to make options optional: qol_project_watch(&project, .script = __FILE__).
+#define qol_project_watch(project, ...) qol_project_watch_impl(project, (QOL_WatchOptions){__VA_ARGS__})
+
+//////////////////////////////////////////////////
+/// BUILD_LOG ////////////////////////////////////
+//////////////////////////////////////////////////
+
+// Build log: Persistent record of how every output was produced (like ninja's .ninja_log).
+// One line per build is appended to the log; the newest line for an output wins. qol_run()
+// rebuilds an output whose command line hash differs from the recorded one, so changing a flag
+// is enough to get a correct rebuild. The log is mmap'ed on first use and compacted on load
+// once superseded lines dominate it.
+#ifndef QOL_BUILD_LOG_PATH
+    #define QOL_BUILD_LOG_PATH ".qol_log"
+#endif
+
+// Build log entry: What is known about the last successful build of an output
+typedef struct {
+    uint64_t hash;         // qol_cmd_hash() of the command that produced the output
+    int64_t mtime;         // Modification time of the output after the build (ns since epoch)
+    uint64_t duration_ms;  // Wall clock time the command took
+    uint64_t max_rss_kb;   // Peak resident set size of the command in KiB (0 if unknown)
+    uint64_t content_hash; // Restat commands: hash of the output's content (0 if not tracked)
+    int64_t restat_mtime;  // Restat commands: the command rewrote identical content, so as an input of other
+                           // commands the output counts as modified at this (earlier) time, 0 = no
+} QOL_BuildLogEntry;
+
+// Initial value for qol_hash_fnv1a() (FNV-1a 64-bit offset basis)
+#define QOL_FNV1A_INIT 0xcbf29ce484222325ULL
+
+// Hash size bytes of data with 64-bit FNV-1a, continuing from hash (start with QOL_FNV1A_INIT).
+// Fast and good enough to detect changes, not suitable for anything security related.
+QOLDEF uint64_t qol_hash_fnv1a(const void *data, size_t size, uint64_t hash);
+
+// Hash the full argv of cmd. Arguments are separated in the hash, so {"a b"} and {"a", "b"} differ.
+QOLDEF uint64_t qol_cmd_hash(const QOL_Cmd *cmd);
+
+// Append a record for output to the build log. The current mtime of output is stored with it
+// (entry->mtime is ignored). Returns true on success, false if the log could not be written.
+QOLDEF bool qol_build_log_record(const char *output, const QOL_BuildLogEntry *entry);
+
+// Look up the newest record of output. Returns true and fills entry if found, false otherwise.
+QOLDEF bool qol_build_log_get(const char *output, QOL_BuildLogEntry *entry);
+
+// Use the build log at path from now on (NULL = QOL_BUILD_LOG_PATH), e.g. to keep one per build
+// directory or a scratch log in tests. The current log is closed, the new one is read on first use.
+// Returns false if path is too long.
+QOLDEF bool qol_build_log_open(const char *path);
+
+//////////////////////////////////////////////////
+/// COMPILE_CACHE ////////////////////////////////
+//////////////////////////////////////////////////
+
+// Compile cache: Content-addressed object cache shared by all checkouts (like ccache).
+// With `.cache=true` a compile command (`-c`, one source, `-o` output) is first run through the
+// preprocessor, as the first process of its job (async builds never wait for it); the
+// preprocessed text, the argv (without output paths) and the compiler binary identity form the
+// key, looked up once the preprocessor is reaped. On a hit the object is restored from the cache
+// directory instead of compiling, on a miss the compiler is started and the fresh object is
+// stored once it succeeded. Restoring uses a
+// reflink where the filesystem supports it and a copy otherwise. Define QOL_CACHE_HARDLINK to
+// restore with hardlinks instead (fastest; cached outputs are unlinked before every recompile so
+// the compiler can never write through into the cache). Entries are evicted least recently used
+// first when the cache exceeds QOL_CACHE_MAX_SIZE; hit/miss counters are logged at exit.
+#ifndef QOL_CACHE_DIR
+    #define QOL_CACHE_DIR ".qol_cache"          // Overridden at runtime by the QOL_CACHE_DIR environment variable
+#endif
+#ifndef QOL_CACHE_MAX_SIZE
+    #define QOL_CACHE_MAX_SIZE (1024ULL * 1024 * 1024)
+#endif
+
+// Compile cache statistics of the current process
+typedef struct {
+    size_t hits;       // Objects restored from the cache
+    size_t misses;     // Cacheable compiles that had to run
+    size_t stores;     // Objects added to the cache
+    size_t skipped;    // Commands that could not be cached (not a single-source compile, preprocessor failed)
+} QOL_CacheStats;
+
+// Get the compile cache counters of the current process.
+QOLDEF QOL_CacheStats qol_cache_stats(void);
+
+// Memoized probes: Commands that only report facts about the toolchain (`pkg-config --cflags`,
+// `cc --version`, `cc -print-search-dirs`) give the same answer run after run, but each one costs
+// a process (pkg-config easily tens of milliseconds). qol_cmd_memo() runs such a command with its
+// stdout captured and keeps the output in <cache dir>/memo, keyed by the argv, the environment
+// variables in opts.env (default QOL_MEMO_ENV), the resolved binary (path, size and mtime) and the
+// mtimes of opts.inputs. Later runs with the same key return the stored bytes without starting
+// anything. stderr goes to the terminal, failed commands are not memoized. Entries are evicted
+// least recently used first when the memo directory exceeds QOL_MEMO_MAX_SIZE.
+#ifndef QOL_MEMO_ENV
+    #define QOL_MEMO_ENV "PKG_CONFIG_PATH", "PKG_CONFIG_LIBDIR", "PKG_CONFIG_SYSROOT_DIR", "CPATH", "LIBRARY_PATH"
+#endif
+#ifndef QOL_MEMO_MAX_SIZE
+    #define QOL_MEMO_MAX_SIZE (16ULL * 1024 * 1024)
+#endif
+
+typedef struct {
+    const char **env;    // NULL-terminated names of environment variables the output depends on (NULL = QOL_MEMO_ENV)
+    const char **inputs; // NULL-terminated files the output depends on (e.g. .pc files), their mtimes are part of the key
+    size_t *size;        // Set to the length of the output (it may contain '\0')
+    bool refresh;        // Run the command even if its output is memoized and replace the entry
+} QOL_MemoOptions;
+
+// Run cmd (or not) and return its stdout as a '\0'-terminated string that the caller frees, or NULL
+// if the command failed. Automatically releases the command memory, like qol_run().
+// Usage: char *cflags = qol_cmd_memo(&cmd, .inputs=pc_files);
+QOLDEF char *qol_cmd_memo_impl(QOL_Cmd *cmd, QOL_MemoOptions opts);
+#define qol_cmd_memo(cmd, ...) qol_cmd_memo_impl(cmd, (QOL_MemoOptions){__VA_ARGS__})
+
+//////////////////////////////////////////////////
+/// TRACE ////////////////////////////////////////
+//////////////////////////////////////////////////
+
+// Build trace: Timeline of every command launched while tracing is enabled, written as a
+// chrome://tracing / Perfetto compatible JSON file. Each running command occupies a slot (one
+// lane in the viewer), so concurrency and idle slots are visible at a glance. qol_trace_end()
+// also logs a summary: wall time, average parallelism, the critical path and the slowest commands.
+// The critical path is derived from the timeline alone: starting at the command that finished last,
+// each step goes back to the command whose exit released it (the latest one that ended before it
+// started). For dependency-driven builds (graphs, bounded pools) this is the chain that bounded
+// the wall time.
+
+// Start recording command timelines. The trace is written to path by qol_trace_end().
+// Returns false if tracing is already active.
+QOLDEF bool qol_trace_begin(const char *path);
+
+// Stop recording, write the JSON trace and log the summary. Commands still running are recorded
+// up to now. Returns true if the trace file was written.
+QOLDEF bool qol_trace_end(void);
+
 //////////////////////////////////////////////////
 /// STRING UTILITIES /////////////////////////////
 //////////////////////////////////////////////////
@@ -755,6 +1358,58 @@ QOLDEF int qol_needs_rebuild(const char *output_path, const char **input_paths,
 // Returns 1 if rebuild needed, 0 if up to date, -1 on error.
 QOLDEF int qol_needs_rebuild1(const char *output_path, const char *input_path);
 
+// Stat cache: During a graph or project build (or between qol_stat_cache_begin() and
+// qol_stat_cache_end()), rebuild checks (qol_needs_rebuild, qol_is_path1_modified_after_path2, the
+// deps log, qol_ensure_dir_for_file) stat every path at most once. Entries are dropped when this
+// process writes the path (file helpers, finished commands with known outputs); a command whose
+// outputs are unknown drops the whole cache. Outside of a build every lookup asks the filesystem, so
+// files the program changes by other means between builds are never seen stale. Define
+// QOL_NO_STAT_CACHE to always ask the filesystem.
+typedef struct {
+    bool exists;       // False if the path does not exist (the other fields are zero)
+    bool is_dir;       // Path is a directory
+    int64_t mtime_ns;  // Modification time in nanoseconds since the Unix epoch
+    int64_t size;      // Size in bytes
+} QOL_FileStat;
+
+// Stat cache statistics of the current process
+typedef struct {
+    size_t hits;           // Lookups answered from the cache
+    size_t misses;         // Lookups that had to stat the path
+    size_t invalidations;  // Entries dropped (a full clear counts once)
+} QOL_StatCacheStats;
+
+// Look up path in the stat cache, querying the filesystem on a miss. Fills st (may be NULL) and
+// returns true if the path exists, false if it does not or could not be queried.
+QOLDEF bool qol_stat_cached(const char *path, QOL_FileStat *st);
+
+// Forget the cached state of path, e.g. after writing it by other means than the file helpers.
+// NULL drops every entry.
+QOLDEF void qol_stat_invalidate(const char *path);
+
+// Get the stat cache counters of the current process.
+QOLDEF QOL_StatCacheStats qol_stat_cache_stats(void);
+
+// Trust cached stats until the matching qol_stat_cache_end() (calls nest). The outermost begin
+// forgets what earlier builds recorded. Graph and project builds do this themselves.
+QOLDEF void qol_stat_cache_begin(void);
+QOLDEF void qol_stat_cache_end(void);
+
+// Batched metadata: Paths missing from the stat cache are queried by up to QOL_STAT_BATCH_THREADS
+// threads at once (at least QOL_STAT_BATCH_MIN paths each), so a no-op check over tens of
+// thousands of inputs is not bound by the latency of one stat at a time (network filesystems).
+// qol_needs_rebuild, qol_deps_check and qol_graph_build use it for large input sets.
+#ifndef QOL_STAT_BATCH_THREADS
+    #define QOL_STAT_BATCH_THREADS 16
+#endif
+#ifndef QOL_STAT_BATCH_MIN
+    #define QOL_STAT_BATCH_MIN 64
+#endif
+
+// Look up count paths at once and store them in the stat cache. stats (may be NULL to only warm
+// the cache) receives one entry per path, in order.
+QOLDEF void qol_stat_batch(const char **paths, size_t count, QOL_FileStat *stats);
+
 //////////////////////////////////////////////////
 /// TEMP_ALLOCATOR ///////////////////////////////
 //////////////////////////////////////////////////
@@ -836,8 +1491,17 @@ QOLDEF void qol_temp_rewind(size_t checkpoint);
 // cast to void* or use -Wno-incompatible-pointer-types. Alternatively, declare variables as void* and cast when needed.
 
 #if defined(__GNUC__) || defined(__clang__)
-    // Forward declaration - implementation is in QOL_IMPLEMENTATION section
-    static inline void _qol_auto_free_impl(void *p);
+    // Generic cleanup function that works with any pointer type.
+    // The cleanup attribute passes the address of the variable, which we cast to void**.
+    // Defined here rather than in the implementation so every translation unit gets its own copy.
+    static inline void _qol_auto_free_impl(void *p) {
+        void **ptr = (void **)p;
+        if (ptr && *ptr) {
+            qol_diag("Auto-free: freeing memory at %p\n", *ptr);
+            free(*ptr);
+            *ptr = NULL;
+        }
+    }
 
     // Auto-free macro: Applies cleanup attribute
     // Note: For best compatibility, use void* for variables. For typed pointers, GCC may require
@@ -1130,19 +1794,31 @@ QOLDEF bool qol_hm_empty(QOL_HashMap* hm);
 // Mutexes for protecting global state
 #if defined(WINDOWS)
     // On Windows, CRITICAL_SECTION must be initialized dynamically
-    static CRITICAL_SECTION qol_logger_mutex;
-    static CRITICAL_SECTION qol_temp_alloc_mutex;
-    static CRITICAL_SECTION qol_argparser_mutex;
-    static CRITICAL_SECTION qol_test_mutex;
-    static CRITICAL_SECTION qol_win32_err_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_logger_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_temp_alloc_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_argparser_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_test_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_win32_err_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_exec_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_deps_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_build_log_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_cache_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_trace_mutex;
+    QOL_MAYBE_UNUSED static CRITICAL_SECTION qol_stat_mutex;
     static volatile LONG qol_mutexes_initialized = 0;  // 0=uninit, 1=initting, 2=done
 #else
     // On Unix, use PTHREAD_MUTEX_INITIALIZER for static initialization
-    static pthread_mutex_t qol_logger_mutex = PTHREAD_MUTEX_INITIALIZER;
-    static pthread_mutex_t qol_temp_alloc_mutex = PTHREAD_MUTEX_INITIALIZER;
-    static pthread_mutex_t qol_argparser_mutex = PTHREAD_MUTEX_INITIALIZER;
-    static pthread_mutex_t qol_test_mutex = PTHREAD_MUTEX_INITIALIZER;
-    static pthread_mutex_t qol_win32_err_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_logger_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_temp_alloc_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_argparser_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_test_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_win32_err_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_exec_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_deps_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_build_log_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+    QOL_MAYBE_UNUSED static pthread_mutex_t qol_stat_mutex = PTHREAD_MUTEX_INITIALIZER;
     static volatile int qol_mutexes_initialized = 1;  // Already initialized on Unix
 #endif
 
@@ -1323,7 +1999,9 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 /// QOL_IMPLEMENATION ////////////////////////////
 //////////////////////////////////////////////////
 
-#ifdef QOL_IMPLEMENTATION
+// QOL_NO_IMPLEMENTATION skips the implementation even if QOL_IMPLEMENTATION is defined. Used by
+// qol_auto_rebuild() to compile the build script against a cached object of the implementation.
+#if defined(QOL_IMPLEMENTATION) && !defined(QOL_NO_IMPLEMENTATION)
 
     //////////////////////////////////////////////////
     /// THREAD SAFETY ////////////////////////////////
@@ -1341,6 +2019,12 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
             InitializeCriticalSection(&qol_argparser_mutex);
             InitializeCriticalSection(&qol_test_mutex);
             InitializeCriticalSection(&qol_win32_err_mutex);
+            InitializeCriticalSection(&qol_exec_mutex);
+            InitializeCriticalSection(&qol_deps_mutex);
+            InitializeCriticalSection(&qol_build_log_mutex);
+            InitializeCriticalSection(&qol_cache_mutex);
+            InitializeCriticalSection(&qol_trace_mutex);
+            InitializeCriticalSection(&qol_stat_mutex);
             InterlockedExchange(&qol_mutexes_initialized, 2);  // Mark as fully initialized
         } else {
             // Wait for initialization to complete (spin-wait, should be very fast)
@@ -1782,6 +2466,15 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 #endif
         if (slash) {
             *slash = '\0'; // Null-terminate at separator (extract directory portion)
+            if (qol_stat_cached(dir, NULL)) return; // Common case: a single (cached) stat
+            // Create missing parents first (e.g. out/obj/app/src/ for a project's objects)
+            for (char *c = dir + 1; *c; c++) {
+                if (*c != '/' && *c != '\\') continue;
+                char separator = *c;
+                *c = '\0';
+                qol_mkdir_if_not_exists(dir);
+                *c = separator;
+            }
             qol_mkdir_if_not_exists(dir); // Create directory if it doesn't exist
         }
         // If no separator found, file is in current directory (no action needed)
@@ -1799,26 +2492,30 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 #endif
     }
 
-    QOLDEF QOL_Cmd qol_default_c_build(const char *source, const char *output) {
-        QOL_Cmd cmd = {0}; // Initialize command structure to zero
-
+    // Push the platform's C compiler and default warning flags
+    static void qol_default_c_compiler(QOL_Cmd *cmd) {
         // Select compiler based on platform
 #if defined(WINDOWS)
-        qol_push(&cmd, "gcc"); // Windows: Use GCC (MinGW/MSYS2)
+        qol_push(cmd, "gcc"); // Windows: Use GCC (MinGW/MSYS2)
 #elif defined(__APPLE__) && defined(__MACH__)
-        qol_push(&cmd, "cc"); // macOS: Use system default C compiler (usually Clang)
+        qol_push(cmd, "cc"); // macOS: Use system default C compiler (usually Clang)
 #elif defined(__linux__)
-        qol_push(&cmd, "cc"); // Linux: Use system default C compiler (usually GCC)
+        qol_push(cmd, "cc"); // Linux: Use system default C compiler (usually GCC)
 #else
-        qol_push(&cmd, "cc"); // Fallback: Use cc (should work on most Unix systems)
+        qol_push(cmd, "cc"); // Fallback: Use cc (should work on most Unix systems)
 #endif
 
         // Push compiler flags as separate arguments (each flag is a separate argv element)
         // Only add flags on Unix-like systems (Windows compilers use different syntax)
 #if !defined(_WIN32) && !defined(_WIN64)
-        qol_push(&cmd, "-Wall");  // Enable all common warnings
-        qol_push(&cmd, "-Wextra"); // Enable extra warnings
+        qol_push(cmd, "-Wall");  // Enable all common warnings
+        qol_push(cmd, "-Wextra"); // Enable extra warnings
 #endif
+    }
+
+    QOLDEF QOL_Cmd qol_default_c_build(const char *source, const char *output) {
+        QOL_Cmd cmd = {0}; // Initialize command structure to zero
+        qol_default_c_compiler(&cmd);
 
         // Add source file and output flag
         qol_push(&cmd, source);  // Source file path
@@ -1839,15 +2536,339 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
         return cmd; // Return constructed command structure
     }
 
+    QOLDEF QOL_Cmd qol_default_c_compile(const char *source, const char *object) {
+        QOL_Cmd cmd = {0};
+        qol_default_c_compiler(&cmd);
+        qol_push(&cmd, "-c", source, "-o", object);
+        return cmd;
+    }
+
+    QOLDEF QOL_Cmd qol_default_c_link(const char **objects, size_t count, const char *output) {
+        QOL_Cmd cmd = {0};
+        qol_default_c_compiler(&cmd);
+        for (size_t i = 0; i < count; i++) qol_push(&cmd, objects[i]);
+        qol_push(&cmd, "-o", output);
+        return cmd;
+    }
+
     QOLDEF bool qol_is_path1_modified_after_path2(const char *path1, const char *path2) {
-        struct stat stat1, stat2;
+        QOL_FileStat stat1, stat2;
+        if (!qol_stat_cached(path1, &stat1)) return false; // path1 doesn't exist or error
+        if (!qol_stat_cached(path2, &stat2)) return true;  // path2 doesn't exist, path1 is "newer"
+        return stat1.mtime_ns > stat2.mtime_ns;
+    }
+
+    //////////////////////////////////////////////////
+    /// STAT_CACHE ///////////////////////////////////
+    //////////////////////////////////////////////////
+
+    static QOL_HashMap *qol_stat_entries = NULL;    // Path -> malloc'd QOL_FileStat
+    static QOL_StatCacheStats qol_stat_counters = {0};
+    static size_t qol_stat_scope = 0;               // Open qol_stat_cache_begin() calls (entries are trusted)
+
+    // Query the filesystem. Returns false if path does not exist or cannot be queried.
+    static bool qol_stat_query(const char *path, QOL_FileStat *st) {
+        memset(st, 0, sizeof(*st));
+#if defined(WINDOWS)
+        WIN32_FILE_ATTRIBUTE_DATA data;
+        if (!GetFileAttributesExA(path, GetFileExInfoStandard, &data)) return false;
+        // FILETIME counts 100ns intervals since 1601-01-01
+        uint64_t ticks = ((uint64_t)data.ftLastWriteTime.dwHighDateTime << 32) | data.ftLastWriteTime.dwLowDateTime;
+        st->mtime_ns = (int64_t)(ticks - 116444736000000000ULL) * 100;
+        st->size = (int64_t)(((uint64_t)data.nFileSizeHigh << 32) | data.nFileSizeLow);
+        st->is_dir = (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) != 0;
+#else
+        struct stat sb;
+        if (stat(path, &sb) != 0) return false;
+    #if defined(MACOS)
+        st->mtime_ns = (int64_t)sb.st_mtimespec.tv_sec * 1000000000LL + sb.st_mtimespec.tv_nsec;
+    #else
+        st->mtime_ns = (int64_t)sb.st_mtim.tv_sec * 1000000000LL + sb.st_mtim.tv_nsec;
+    #endif
+        st->size = (int64_t)sb.st_size;
+        st->is_dir = S_ISDIR(sb.st_mode);
+#endif
+        st->exists = true;
+        return true;
+    }
+
+    // Query path for the cache. Returns false in *cacheable on errors other than a missing path
+    // (permissions, ...): those are asked again next time.
+    static bool qol_stat_query_cacheable(const char *path, QOL_FileStat *st, bool *cacheable) {
+        errno = 0;
+        bool exists = qol_stat_query(path, st);
+#if defined(WINDOWS)
+        DWORD error = exists ? 0 : GetLastError();
+        *cacheable = exists || error == ERROR_FILE_NOT_FOUND || error == ERROR_PATH_NOT_FOUND;
+#else
+        *cacheable = exists || errno == ENOENT || errno == ENOTDIR;
+#endif
+        return exists;
+    }
+
+    // Insert or replace the entry of path. Caller holds qol_stat_mutex.
+    static void qol_stat_store(const char *path, const QOL_FileStat *st) {
+        if (!qol_stat_entries) {
+            qol_stat_entries = qol_hm_create();
+            if (!qol_stat_entries) abort();
+        }
+        QOL_FileStat *entry = (QOL_FileStat*)qol_hm_get(qol_stat_entries, (void*)path);
+        if (entry) {
+            *entry = *st;
+            return;
+        }
+        entry = (QOL_FileStat*)malloc(sizeof(*entry));
+        if (!entry) abort();
+        *entry = *st;
+        qol_hm_put(qol_stat_entries, (void*)path, entry);
+    }
+
+    QOLDEF bool qol_stat_cached(const char *path, QOL_FileStat *st) {
+        QOL_FileStat local;
+        if (!st) st = &local;
+        if (!path) {
+            memset(st, 0, sizeof(*st));
+            return false;
+        }
+#ifdef QOL_NO_STAT_CACHE
+        return qol_stat_query(path, st);
+#else
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_stat_mutex);
+        QOL_FileStat *entry = qol_stat_scope > 0 && qol_stat_entries ? (QOL_FileStat*)qol_hm_get(qol_stat_entries, (void*)path) : NULL;
+        if (entry) {
+            qol_stat_counters.hits++;
+            *st = *entry;
+            QOL_MUTEX_UNLOCK(qol_stat_mutex);
+            return st->exists;
+        }
+        qol_stat_counters.misses++;
+        bool scoped = qol_stat_scope > 0;
+        QOL_MUTEX_UNLOCK(qol_stat_mutex);
+
+        bool cacheable;
+        bool exists = qol_stat_query_cacheable(path, st, &cacheable);
+        if (!cacheable || !scoped) return exists;
+        QOL_MUTEX_LOCK(qol_stat_mutex);
+        qol_stat_store(path, st);
+        QOL_MUTEX_UNLOCK(qol_stat_mutex);
+        return exists;
+#endif
+    }
+
+    // Slice of a batch for one worker thread: every stride-th miss starting at first
+    typedef struct {
+        const char **paths;
+        size_t *misses;        // Indices into paths
+        size_t count;          // Number of misses
+        size_t first, stride;
+        QOL_FileStat *stats;   // One per miss
+        bool *cacheable;       // One per miss
+    } QOL_StatBatchSlice;
+
+    static void qol_stat_batch_run(QOL_StatBatchSlice *slice) {
+        for (size_t i = slice->first; i < slice->count; i += slice->stride) {
+            qol_stat_query_cacheable(slice->paths[slice->misses[i]], &slice->stats[i], &slice->cacheable[i]);
+        }
+    }
+
+#if defined(WINDOWS)
+    static DWORD WINAPI qol_stat_batch_thread(LPVOID arg) {
+        qol_stat_batch_run((QOL_StatBatchSlice*)arg);
+        return 0;
+    }
+#else
+    static void *qol_stat_batch_thread(void *arg) {
+        qol_stat_batch_run((QOL_StatBatchSlice*)arg);
+        return NULL;
+    }
+#endif
+
+    QOLDEF void qol_stat_batch(const char **paths, size_t count, QOL_FileStat *stats) {
+        if (!paths || count == 0) return;
+#ifdef QOL_NO_STAT_CACHE
+        for (size_t i = 0; i < count; i++) {
+            QOL_FileStat st;
+            qol_stat_query(paths[i], &st);
+            if (stats) stats[i] = st;
+        }
+#else
+        // Answer what the cache knows, collect the rest
+        size_t *misses = (size_t*)malloc(count * sizeof(size_t));
+        if (!misses) abort();
+        size_t miss_count = 0;
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_stat_mutex);
+        bool scoped = qol_stat_scope > 0;
+        for (size_t i = 0; i < count; i++) {
+            QOL_FileStat *entry = scoped && paths[i] && qol_stat_entries ? (QOL_FileStat*)qol_hm_get(qol_stat_entries, (void*)paths[i]) : NULL;
+            if (entry) {
+                qol_stat_counters.hits++;
+                if (stats) stats[i] = *entry;
+            } else if (paths[i]) {
+                qol_stat_counters.misses++;
+                misses[miss_count++] = i;
+            } else if (stats) {
+                memset(&stats[i], 0, sizeof(stats[i]));
+            }
+        }
+        QOL_MUTEX_UNLOCK(qol_stat_mutex);
+        if (miss_count == 0) {
+            free(misses);
+            return;
+        }
+
+        QOL_FileStat *results = (QOL_FileStat*)malloc(miss_count * sizeof(QOL_FileStat));
+        bool *cacheable = (bool*)malloc(miss_count * sizeof(bool));
+        if (!results || !cacheable) abort();
+
+        size_t threads = miss_count / QOL_STAT_BATCH_MIN;
+        if (threads > QOL_STAT_BATCH_THREADS) threads = QOL_STAT_BATCH_THREADS;
+        if (threads < 1) threads = 1;
+        QOL_StatBatchSlice slices[QOL_STAT_BATCH_THREADS > 0 ? QOL_STAT_BATCH_THREADS : 1];
+        for (size_t t = 0; t < threads; t++) {
+            slices[t] = (QOL_StatBatchSlice){ paths, misses, miss_count, t, threads, results, cacheable };
+        }
+
+        // The calling thread takes the first slice; a thread that cannot be started leaves its
+        // slice to the calling thread as well
+#if defined(WINDOWS)
+        HANDLE handles[QOL_STAT_BATCH_THREADS > 0 ? QOL_STAT_BATCH_THREADS : 1];
+        for (size_t t = 1; t < threads; t++) handles[t] = CreateThread(NULL, 0, qol_stat_batch_thread, &slices[t], 0, NULL);
+        qol_stat_batch_run(&slices[0]);
+        for (size_t t = 1; t < threads; t++) {
+            if (handles[t]) {
+                WaitForSingleObject(handles[t], INFINITE);
+                CloseHandle(handles[t]);
+            } else {
+                qol_stat_batch_run(&slices[t]);
+            }
+        }
+#else
+        pthread_t handles[QOL_STAT_BATCH_THREADS > 0 ? QOL_STAT_BATCH_THREADS : 1];
+        bool started[QOL_STAT_BATCH_THREADS > 0 ? QOL_STAT_BATCH_THREADS : 1] = {0};
+        for (size_t t = 1; t < threads; t++) started[t] = pthread_create(&handles[t], NULL, qol_stat_batch_thread, &slices[t]) == 0;
+        qol_stat_batch_run(&slices[0]);
+        for (size_t t = 1; t < threads; t++) {
+            if (started[t]) pthread_join(handles[t], NULL);
+            else qol_stat_batch_run(&slices[t]);
+        }
+#endif
+
+        QOL_MUTEX_LOCK(qol_stat_mutex);
+        for (size_t i = 0; i < miss_count; i++) {
+            if (cacheable[i] && scoped) qol_stat_store(paths[misses[i]], &results[i]);
+            if (stats) stats[misses[i]] = results[i];
+        }
+        QOL_MUTEX_UNLOCK(qol_stat_mutex);
+        free(results);
+        free(cacheable);
+        free(misses);
+#endif
+    }
+
+    QOLDEF void qol_stat_invalidate(const char *path) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_stat_mutex);
+        if (qol_stat_entries && qol_hm_size(qol_stat_entries) > 0) {
+            if (path) {
+                QOL_FileStat *entry = (QOL_FileStat*)qol_hm_get(qol_stat_entries, (void*)path);
+                if (entry) {
+                    qol_hm_remove(qol_stat_entries, (void*)path);
+                    free(entry);
+                    qol_stat_counters.invalidations++;
+                }
+            } else {
+                for (size_t i = 0; i < qol_stat_entries->capacity; i++) {
+                    QOL_HashMapEntry *bucket = &qol_stat_entries->buckets[i];
+                    if (bucket->state == QOL_HM_USED) free(*(void**)bucket->value);
+                }
+                qol_hm_clear(qol_stat_entries);
+                qol_stat_counters.invalidations++;
+            }
+        }
+        QOL_MUTEX_UNLOCK(qol_stat_mutex);
+    }
+
+    QOLDEF QOL_StatCacheStats qol_stat_cache_stats(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_stat_mutex);
+        QOL_StatCacheStats stats = qol_stat_counters;
+        QOL_MUTEX_UNLOCK(qol_stat_mutex);
+        return stats;
+    }
+
+    QOLDEF void qol_stat_cache_begin(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_stat_mutex);
+        bool outermost = qol_stat_scope++ == 0;
+        QOL_MUTEX_UNLOCK(qol_stat_mutex);
+        // Anything may have changed since the last build
+        if (outermost) qol_stat_invalidate(NULL);
+    }
+
+    QOLDEF void qol_stat_cache_end(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_stat_mutex);
+        if (qol_stat_scope > 0) qol_stat_scope--;
+        QOL_MUTEX_UNLOCK(qol_stat_mutex);
+    }
+
+    // The stats the last build recorded for paths (left in the cache when its scope ended), the
+    // filesystem's answer for paths it did not look at
+    static void qol_stat_last_build(const char **paths, size_t count, QOL_FileStat *stats) {
+        const char **missing = (const char**)malloc(count * sizeof(*missing));
+        size_t *where = (size_t*)malloc(count * sizeof(*where));
+        QOL_FileStat *found = (QOL_FileStat*)malloc(count * sizeof(*found));
+        if (!missing || !where || !found) abort();
+        size_t missing_count = 0;
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_stat_mutex);
+        for (size_t i = 0; i < count; i++) {
+            QOL_FileStat *entry = qol_stat_entries ? (QOL_FileStat*)qol_hm_get(qol_stat_entries, (void*)paths[i]) : NULL;
+            if (entry) {
+                stats[i] = *entry;
+            } else {
+                where[missing_count] = i;
+                missing[missing_count++] = paths[i];
+            }
+        }
+        QOL_MUTEX_UNLOCK(qol_stat_mutex);
+        qol_stat_batch(missing, missing_count, found);
+        for (size_t i = 0; i < missing_count; i++) stats[where[i]] = found[i];
+        free(missing);
+        free(where);
+        free(found);
+    }
+
+    // Get the modification time of path in nanoseconds since the Unix epoch (through the stat cache).
+    // Returns false if the file does not exist (or cannot be queried).
+    static bool qol_file_mtime_ns(const char *path, int64_t *mtime) {
+        QOL_FileStat st;
+        if (!qol_stat_cached(path, &st)) return false;
+        *mtime = st.mtime_ns;
+        return true;
+    }
+
+    // Modification time of path as an input of rebuild checks (see qol_restat_output()): an output
+    // a restat command rewrote with identical content counts as modified when its content last
+    // changed. Returns false if path does not exist.
+    static bool qol_input_mtime_ns(const char *path, int64_t *mtime);
 
-        // Get file stats (modification time)
-        if (stat(path1, &stat1) != 0) return false; // path1 doesn't exist or error
-        if (stat(path2, &stat2) != 0) return true;  // path2 doesn't exist, path1 is "newer"
+    // The same for a path whose stat was already taken (e.g. by qol_stat_batch())
+    static bool qol_input_mtime_from(const char *path, const QOL_FileStat *st, int64_t *mtime);
 
-        // Compare modification times: difftime returns positive if stat1 is newer
-        return difftime(stat1.st_mtime, stat2.st_mtime) > 0;
+    // Hash the content of path. Returns false if it cannot be read.
+    static bool qol_hash_file(const char *path, uint64_t *hash) {
+        FILE *fp = fopen(path, "rb");
+        if (!fp) return false;
+        char buffer[64 * 1024];
+        size_t n;
+        *hash = QOL_FNV1A_INIT;
+        while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) *hash = qol_hash_fnv1a(buffer, n, *hash);
+        bool ok = !ferror(fp);
+        fclose(fp);
+        return ok;
     }
 
     QOLDEF char *qol_get_filename_no_ext(const char *path) {
@@ -1878,75 +2899,230 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
         return copy; // Caller must free this string
     }
 
-    QOLDEF void qol_auto_rebuild(const char *src) {
-        if (!src) return;
+    static const char *qol_cache_dir(void);
+
+    // Compile the build script against a cached object of this header's implementation, so an edit
+    // of the script only recompiles the script. The object is built from the preprocessor directives
+    // of the script's preamble (up to the #include of this header, so configuration macros match;
+    // code there stays with the script, or its definitions would be linked twice) and keyed on the
+    // preprocessed preamble (this header and whatever else it includes, e.g. a config header) and
+    // the compiler command.
+    // Returns 1 on success, -1 if the cache is not usable or linking against it failed.
+    static int qol_rebuild_cached_impl(const char *src, const char *out, const char *depfile) {
+        const char *header = __FILE__; // As the script included it, relative to where it was compiled
+        const char *header_name = header;
+        for (const char *c = header; *c; c++) if (*c == '/' || *c == '\\') header_name = c + 1;
+
+        QOL_String lines = {0};
+        FILE *fp = fopen(header, "rb");
+        if (!fp || !qol_read_file(src, &lines)) {
+            if (fp) fclose(fp);
+            return -1;
+        }
+        size_t end = lines.len;
+        for (size_t i = 0; i < lines.len && end == lines.len; i++) {
+            const char *line = lines.data[i];
+            while (*line == ' ' || *line == '\t') line++;
+            if (*line++ != '#') continue;
+            while (*line == ' ' || *line == '\t') line++;
+            if (strncmp(line, "include", 7) == 0 && strstr(line, header_name)) end = i;
+        }
+        if (end == lines.len) {
+            fclose(fp);
+            qol_release_string(&lines);
+            return -1;
+        }
 
-        struct stat src_attr, out_attr;
+        // The preamble's source is named after its text and the header's content
+        QOL_Cmd compiler = {0};
+        qol_default_c_compiler(&compiler);
+        uint64_t hash = qol_cmd_hash(&compiler);
+        size_t size = 64 + strlen(src);
+        for (size_t i = 0; i <= end; i++) {
+            hash = qol_hash_fnv1a(lines.data[i], strlen(lines.data[i]) + 1, hash);
+            size += strlen(lines.data[i]) + 1;
+        }
+        char buffer[64 * 1024];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) hash = qol_hash_fnv1a(buffer, n, hash);
+        fclose(fp);
 
+        char source[QOL_PATH_BUFFER_SIZE], preprocessed[QOL_PATH_BUFFER_SIZE + 32];
+        snprintf(source, sizeof(source), "%s/impl/%016llx.c", qol_cache_dir(), (unsigned long long)hash);
 #if defined(WINDOWS)
-        char *out = "build_new.exe";
+        snprintf(preprocessed, sizeof(preprocessed), "%s.%lu.i", source, (unsigned long)GetCurrentProcessId());
 #else
-        char *out = qol_get_filename_no_ext(src);
-        if (!out) return;
+        snprintf(preprocessed, sizeof(preprocessed), "%s.%ld.i", source, (long)getpid());
 #endif
+        char *content = (char*)malloc(size);
+        if (!content) abort();
+        size_t len = (size_t)snprintf(content, size, "#line 1 \"%s\"\n", src); // Errors point at the script
+        bool directive = false; // Inside a directive continued with a backslash
+        for (size_t i = 0; i <= end; i++) {
+            const char *line = lines.data[i];
+            while (*line == ' ' || *line == '\t') line++;
+            if (*line == '#') directive = true;
+            // Other lines are left empty, so line numbers still match the script
+            len += (size_t)sprintf(content + len, "%s\n", directive ? lines.data[i] : "");
+            size_t line_len = strlen(lines.data[i]);
+            while (line_len > 0 && lines.data[i][line_len - 1] == '\r') line_len--;
+            directive = directive && line_len > 0 && lines.data[i][line_len - 1] == '\\';
+        }
+        qol_ensure_dir_for_file(source);
+        fp = fopen(source, "wb"); // Quietly, like the other cache entries
+        bool written = fp && fwrite(content, 1, len, fp) == len;
+        if (fp && fclose(fp) != 0) written = false;
+        free(content);
+
+        // The preamble includes the header relative to the script
+        char src_dir[QOL_PATH_BUFFER_SIZE];
+        snprintf(src_dir, sizeof(src_dir), "%s", src);
+        char *slash = strrchr(src_dir, '/');
+        if (slash) *slash = '\0';
+        else snprintf(src_dir, sizeof(src_dir), ".");
+
+        // Key: the preprocessed preamble (without line markers, which name the cache directory),
+        // so an edit of any header it includes picks another object
+        QOL_Cmd pp = {0};
+        for (size_t i = 0; i < compiler.len; i++) qol_push(&pp, compiler.data[i]);
+        qol_push(&pp, "-I", src_dir, "-E", "-P", source, "-o", preprocessed);
+        uint64_t key;
+        bool keyed = written && qol_run_always(&pp) && qol_hash_file(preprocessed, &key);
+        remove(preprocessed);
+        if (!keyed) {
+            qol_release(&compiler);
+            qol_release_string(&lines);
+            qol_log(QOL_LOG_WARN, "Could not cache the implementation of %s, compiling it with %s\n", header_name, src);
+            return -1;
+        }
+        key = qol_hash_fnv1a(&key, sizeof(key), qol_cmd_hash(&compiler));
 
-        if (stat(src, &src_attr) != 0) {
-            qol_log(QOL_LOG_ERRO, "No such file or directory (%s).\n", src);
-#if !defined(_WIN32) && !defined(_WIN64)
-            free(out);
+        char object[QOL_PATH_BUFFER_SIZE];
+        snprintf(object, sizeof(object), "%s/impl/%016llx.o", qol_cache_dir(), (unsigned long long)key);
+        if (!qol_file_exists(object)) {
+            char tmp[QOL_PATH_BUFFER_SIZE + 32]; // Per process: drivers may share the cache directory
+#if defined(WINDOWS)
+            snprintf(tmp, sizeof(tmp), "%s.%lu.tmp", object, (unsigned long)GetCurrentProcessId());
+#else
+            snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", object, (long)getpid());
 #endif
-            return;
+            QOL_Cmd cmd = {0};
+            for (size_t i = 0; i < compiler.len; i++) qol_push(&cmd, compiler.data[i]);
+            qol_push(&cmd, "-I", src_dir, "-c", source, "-o", tmp);
+            if (!qol_run_always(&cmd) || rename(tmp, object) != 0) {
+                remove(tmp);
+                qol_release(&compiler);
+                qol_release_string(&lines);
+                qol_log(QOL_LOG_WARN, "Could not cache the implementation of %s, compiling it with %s\n", header_name, src);
+                return -1;
+            }
+            qol_log(QOL_LOG_INFO, "Cached the implementation of %s in %s\n", header_name, object);
         }
 
-        bool need_rebuild = false;
-        if (stat(out, &out_attr) != 0) {
-            need_rebuild = true;
-        } else if (difftime(src_attr.st_mtime, out_attr.st_mtime) > 0) {
-            need_rebuild = true;
-        }
+        QOL_Cmd cmd = {0};
+        for (size_t i = 0; i < compiler.len; i++) qol_push(&cmd, compiler.data[i]);
+        qol_push(&cmd, "-DQOL_NO_IMPLEMENTATION", "-MMD", "-MF", depfile, src, object, "-o", out);
+        bool ok = qol_run_always(&cmd);
+        qol_release(&compiler);
+        qol_release_string(&lines);
+        if (!ok) qol_log(QOL_LOG_WARN, "Could not build %s against the cached implementation of %s, compiling it as a whole\n", src, header_name);
+        return ok ? 1 : -1;
+    }
 
-        if (need_rebuild) {
-            qol_log(QOL_LOG_DIAG, "Rebuilding: %s -> %s\n", src, out);
-#if defined(MACOS) || defined(LINUX)
+    // Rebuild the build executable from src and run it in place of the current process with the
+    // arguments this process got. Every header the script includes is recorded in the deps log
+    // under out, so the next startup notices edits to headers nobody listed. Does not return.
+    static void qol_rebuild_self(const char *src, const char *out) {
+        char depfile[QOL_PATH_BUFFER_SIZE + 2];
+        snprintf(depfile, sizeof(depfile), "%s.d", out);
+        int cached = qol_rebuild_cached_impl(src, out, depfile);
+        if (cached < 0) {
             QOL_Cmd own_build = qol_default_c_build(src, out);
-            if (!qol_run_always(&own_build)) {
-                qol_release(&own_build);
-                qol_log(QOL_LOG_ERRO, "Rebuild failed.\n");
-#if !defined(_WIN32) && !defined(_WIN64)
-                free(out);
-#endif
-                exit(1);
-            }
-            qol_release(&own_build);
-
-            qol_log(QOL_LOG_DIAG, "Restarting with updated build executable...\n");
-            char *restart_argv[] = {out, NULL};
-            execv(out, restart_argv);
-            qol_log(QOL_LOG_ERRO, "Failed to restart build process.\n");
-#if !defined(_WIN32) && !defined(_WIN64)
-            free(out);
-#endif
+            qol_push(&own_build, "-MMD", "-MF", depfile);
+            cached = qol_run_always(&own_build) ? 1 : 0;
+        }
+        if (cached == 0) {
+            remove(depfile);
+            qol_log(QOL_LOG_ERRO, "Rebuild failed.\n");
             exit(1);
-#elif defined(WINDOWS)
-            QOL_Cmd own_build = qol_default_c_build(src, out);
-            if (!qol_run_always(&own_build)) {
-                qol_release(&own_build);
-                qol_log(QOL_LOG_ERRO, "Rebuild failed.\n");
-                exit(1);
-            }
-            qol_release(&own_build);
+        }
+        qol_deps_ingest(out, depfile);
 
-            qol_log(QOL_LOG_DIAG, "Restarting with updated build executable...\n");
-            STARTUPINFO si = { sizeof(si) };
-            PROCESS_INFORMATION pi;
-            if (!CreateProcess(out, NULL, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi)) {
-                qol_log(QOL_LOG_ERRO, "Failed to restart build process.\n");
-                exit(1);
+        qol_log(QOL_LOG_DIAG, "Restarting with updated build executable...\n");
+#if defined(WINDOWS)
+        // The new executable gets our command line (argv[0] still names the old one) and exit code
+        STARTUPINFO si = { sizeof(si) };
+        PROCESS_INFORMATION pi;
+        if (!CreateProcess(out, GetCommandLineA(), NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi)) {
+            qol_log(QOL_LOG_ERRO, "Failed to restart build process.\n");
+            exit(1);
+        }
+        CloseHandle(pi.hThread);
+        WaitForSingleObject(pi.hProcess, INFINITE);
+        DWORD exit_code = 1;
+        GetExitCodeProcess(pi.hProcess, &exit_code);
+        ExitProcess(exit_code);
+#else
+        // Original arguments: /proc/self/cmdline on Linux, the saved argv on macOS
+        char **argv = NULL;
+    #if defined(MACOS)
+        argv = *_NSGetArgv();
+    #else
+        static char cmdline[64 * 1024];
+        FILE *fp = fopen("/proc/self/cmdline", "rb");
+        size_t len = fp ? fread(cmdline, 1, sizeof(cmdline) - 1, fp) : 0;
+        if (fp) fclose(fp);
+        if (len > 0 && len < sizeof(cmdline) - 1) {
+            size_t argc = 0;
+            for (size_t i = 0; i < len; i++) argc += cmdline[i] == '\0';
+            argv = (char**)calloc(argc + 1, sizeof(char*));
+            if (!argv) abort();
+            for (size_t i = 0, start = 0, k = 0; i < len; i++) {
+                if (cmdline[i] != '\0') continue;
+                argv[k++] = &cmdline[start];
+                start = i + 1;
             }
-            ExitProcess(0);
+        }
+    #endif
+        char *fallback[] = {(char*)out, NULL};
+        execv(out, argv && argv[0] ? argv : fallback);
+        qol_log(QOL_LOG_ERRO, "Failed to restart build process.\n");
+        exit(1);
+#endif
+    }
+
+    QOLDEF void qol_auto_rebuild(const char *src) {
+        if (!src) return;
+
+        struct stat src_attr, out_attr;
+
+#if defined(WINDOWS)
+        char *out = "build_new.exe";
 #else
-            #error Unsupported platform
+        char *out = qol_get_filename_no_ext(src);
+        if (!out) return;
+#endif
+
+        if (stat(src, &src_attr) != 0) {
+            qol_log(QOL_LOG_ERRO, "No such file or directory (%s).\n", src);
+#if !defined(_WIN32) && !defined(_WIN64)
+            free(out);
 #endif
+            return;
+        }
+
+        bool need_rebuild = false;
+        if (stat(out, &out_attr) != 0) {
+            need_rebuild = true;
+        } else if (difftime(src_attr.st_mtime, out_attr.st_mtime) > 0) {
+            need_rebuild = true;
+        }
+        // Headers discovered by the compiler on the last rebuild (-1: none recorded yet)
+        if (!need_rebuild && qol_deps_check(out) == 1) need_rebuild = true;
+
+        if (need_rebuild) {
+            qol_log(QOL_LOG_DIAG, "Rebuilding: %s -> %s\n", src, out);
+            qol_rebuild_self(src, out); // Does not return
         } else {
             qol_log(QOL_LOG_DIAG, "Up to date: %s\n", out);
 #if !defined(_WIN32) && !defined(_WIN64)
@@ -1977,6 +3153,8 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
         } else if (difftime(src_attr.st_mtime, out_attr.st_mtime) > 0) {
             need_rebuild = true;
         }
+        // Headers discovered by the compiler on the last rebuild (-1: none recorded yet)
+        if (!need_rebuild && qol_deps_check(out) == 1) need_rebuild = true;
 
         // Check additional dependencies from variadic arguments (only if source check didn't trigger rebuild)
         // This allows us to skip dependency checking if source already requires rebuild
@@ -2000,49 +3178,7 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 
         if (need_rebuild) {
             qol_log(QOL_LOG_DIAG, "Rebuilding: %s -> %s\n", src, out);
-
-#if defined(MACOS) || defined(LINUX)
-            QOL_Cmd own_build = qol_default_c_build(src, out);
-            if (!qol_run_always(&own_build)) {
-                qol_release(&own_build);
-                qol_log(QOL_LOG_ERRO, "Rebuild failed.\n");
-#if !defined(_WIN32) && !defined(_WIN64)
-                free(out);
-#endif
-                exit(1);
-            }
-            qol_release(&own_build);
-
-            qol_log(QOL_LOG_DIAG, "Restarting with updated build executable...\n");
-            char *restart_argv[] = {out, NULL};
-            execv(out, restart_argv);
-            qol_log(QOL_LOG_ERRO, "Failed to restart build process.\n");
-#if !defined(_WIN32) && !defined(_WIN64)
-            free(out);
-#endif
-            exit(1);
-#elif defined(WINDOWS)
-            QOL_Cmd own_build = qol_default_c_build(src, out);
-            if (!qol_run_always(&own_build)) {
-                qol_release(&own_build);
-                qol_log(QOL_LOG_ERRO, "Rebuild failed.\n");
-                exit(1);
-            }
-            qol_release(&own_build);
-
-            qol_log(QOL_LOG_DIAG, "Restarting with updated build executable...\n");
-            STARTUPINFO si = { sizeof(si) };
-            PROCESS_INFORMATION pi;
-            char cmdline[1024];
-            snprintf(cmdline, sizeof(cmdline), "\"%s\"", out);
-            if (!CreateProcess(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi)) {
-                qol_log(QOL_LOG_ERRO, "Failed to restart build process.\n");
-                exit(1);
-            }
-            ExitProcess(0);
-#else
-            #error Unsupported platform
-#endif
+            qol_rebuild_self(src, out); // Does not return
         } else {
             qol_log(QOL_LOG_DIAG, "Up to date: %s\n", out);
 #if !defined(_WIN32) && !defined(_WIN64)
@@ -2158,7 +3294,229 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
         qol_log(QOL_LOG_EXEC, "%s\n", command);
     }
 
-    QOLDEF QOL_Proc qol_cmd_execute_async(QOL_Cmd* cmd) {
+    //////////////////////////////////////////////////
+    /// TRACE ////////////////////////////////////////
+    //////////////////////////////////////////////////
+
+    // Short human readable label of a command: its output file, or program and source (caller frees)
+    static char *qol_cmd_label(QOL_Cmd *cmd) {
+        const char *output = qol_cmd_get_output(cmd);
+        if (output) {
+            char *label = strdup(output);
+            if (!label) abort();
+            return label;
+        }
+        const char *source = qol_cmd_get_source(cmd);
+        char *label = (char*)malloc(strlen(cmd->data[0]) + (source ? strlen(source) : 0) + 2);
+        if (!label) abort();
+        if (source) sprintf(label, "%s %s", cmd->data[0], source);
+        else strcpy(label, cmd->data[0]);
+        return label;
+    }
+
+    typedef struct {
+        char *name;          // Short label: output file, or program and source
+        char *cmdline;       // Full command line (JSON args)
+        QOL_Proc proc;       // Process while running
+        uint64_t start_us;   // Spawn time relative to qol_trace_begin()
+        uint64_t end_us;     // Exit time (0 while running)
+        size_t slot;         // Lane in the viewer
+        bool running;        // Not reaped yet
+        bool ok;             // Exit status
+    } QOL_TraceEvent;
+
+    static struct {
+        bool active;
+        char *path;
+        QOL_Timer clock;
+        qol_list(QOL_TraceEvent) events;
+        qol_list(bool) slots;  // Slot busy flags
+    } qol_trace = {0};
+
+    QOLDEF bool qol_trace_begin(const char *path) {
+        if (!path) return false;
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_trace_mutex);
+        if (qol_trace.active) {
+            QOL_MUTEX_UNLOCK(qol_trace_mutex);
+            qol_log(QOL_LOG_ERRO, "Tracing is already active\n");
+            return false;
+        }
+        qol_trace.active = true;
+        qol_trace.path = strdup(path);
+        if (!qol_trace.path) abort();
+        qol_trace.events.len = 0;
+        qol_trace.slots.len = 0;
+        qol_timer_start(&qol_trace.clock);
+        QOL_MUTEX_UNLOCK(qol_trace_mutex);
+        return true;
+    }
+
+    static void qol_trace_spawned(QOL_Cmd *cmd, QOL_Proc proc) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_trace_mutex);
+        if (!qol_trace.active) {
+            QOL_MUTEX_UNLOCK(qol_trace_mutex);
+            return;
+        }
+        QOL_TraceEvent event = { .proc = proc, .running = true };
+        event.start_us = qol_timer_elapsed_ns(&qol_trace.clock) / 1000;
+
+        size_t size = 0;
+        for (size_t i = 0; i < cmd->len; i++) size += strlen(cmd->data[i]) + 1;
+        event.cmdline = (char*)malloc(size + 1);
+        if (!event.cmdline) abort();
+        event.cmdline[0] = '\0';
+        for (size_t i = 0, pos = 0; i < cmd->len; i++) {
+            pos += (size_t)sprintf(event.cmdline + pos, i ? " %s" : "%s", cmd->data[i]);
+        }
+        event.name = qol_cmd_label(cmd);
+
+        // Lowest free slot, so lanes are reused like job slots
+        for (event.slot = 0; event.slot < qol_trace.slots.len && qol_trace.slots.data[event.slot]; event.slot++) {}
+        if (event.slot == qol_trace.slots.len) qol_push(&qol_trace.slots, true);
+        else qol_trace.slots.data[event.slot] = true;
+
+        qol_push(&qol_trace.events, event);
+        QOL_MUTEX_UNLOCK(qol_trace_mutex);
+    }
+
+    static void qol_trace_reaped(QOL_Proc proc, bool ok) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_trace_mutex);
+        for (size_t i = qol_trace.events.len; qol_trace.active && i-- > 0;) {
+            QOL_TraceEvent *event = &qol_trace.events.data[i];
+            if (!event->running || event->proc != proc) continue;
+            event->running = false;
+            event->ok = ok;
+            event->end_us = qol_timer_elapsed_ns(&qol_trace.clock) / 1000;
+            qol_trace.slots.data[event->slot] = false;
+            break;
+        }
+        QOL_MUTEX_UNLOCK(qol_trace_mutex);
+    }
+
+    static void qol_trace_json_string(FILE *fp, const char *str) {
+        fputc('"', fp);
+        for (; *str; str++) {
+            unsigned char c = (unsigned char)*str;
+            if (c == '"' || c == '\\') fprintf(fp, "\\%c", c);
+            else if (c < 0x20) fprintf(fp, "\\u%04x", c);
+            else fputc(c, fp);
+        }
+        fputc('"', fp);
+    }
+
+    static int qol_trace_compare_duration(const void *a, const void *b) {
+        const QOL_TraceEvent *x = *(const QOL_TraceEvent* const*)a, *y = *(const QOL_TraceEvent* const*)b;
+        uint64_t dx = x->end_us - x->start_us, dy = y->end_us - y->start_us;
+        return dx < dy ? 1 : dx > dy ? -1 : 0;
+    }
+
+    static void qol_trace_summary(uint64_t wall_us) {
+        size_t count = qol_trace.events.len;
+        QOL_TraceEvent *events = qol_trace.events.data;
+        uint64_t busy_us = 0;
+        for (size_t i = 0; i < count; i++) busy_us += events[i].end_us - events[i].start_us;
+        double wall_ms = (double)wall_us / 1000.0;
+        qol_log(QOL_LOG_INFO, "Trace: %zu commands in %.1f ms, %zu slots, average parallelism %.2f\n", count, wall_ms,
+                qol_trace.slots.len, wall_us ? (double)busy_us / (double)wall_us : 0.0);
+        if (count == 0) return;
+
+        // Critical path: walk back from the last exit through the command whose exit released each step
+        size_t *path = (size_t*)malloc(count * sizeof(size_t));
+        if (!path) return;
+        size_t len = 0;
+        size_t current = 0;
+        for (size_t i = 1; i < count; i++) {
+            if (events[i].end_us > events[current].end_us) current = i;
+        }
+        for (;;) {
+            path[len++] = current;
+            size_t previous = count;
+            for (size_t i = 0; i < count; i++) {
+                if (i == current || events[i].end_us > events[current].start_us) continue;
+                if (previous == count || events[i].end_us > events[previous].end_us) previous = i;
+            }
+            if (previous == count || len == count) break;
+            current = previous;
+        }
+        uint64_t path_us = 0;
+        for (size_t i = 0; i < len; i++) path_us += events[path[i]].end_us - events[path[i]].start_us;
+        qol_log(QOL_LOG_INFO, "Critical path: %zu commands, %.1f ms of %.1f ms wall time\n", len, (double)path_us / 1000.0, wall_ms);
+        for (size_t i = len; i-- > 0;) {
+            QOL_TraceEvent *e = &events[path[i]];
+            qol_log(QOL_LOG_INFO, "  %10.1f ms  %s\n", (double)(e->end_us - e->start_us) / 1000.0, e->name);
+        }
+        free(path);
+
+        // Slowest commands
+        QOL_TraceEvent **sorted = (QOL_TraceEvent**)malloc(count * sizeof(QOL_TraceEvent*));
+        if (!sorted) return;
+        for (size_t i = 0; i < count; i++) sorted[i] = &events[i];
+        qsort(sorted, count, sizeof(QOL_TraceEvent*), qol_trace_compare_duration);
+        size_t top = count < 20 ? count : 20;
+        qol_log(QOL_LOG_INFO, "Slowest %zu commands:\n", top);
+        for (size_t i = 0; i < top; i++) {
+            qol_log(QOL_LOG_INFO, "  %10.1f ms  %s\n", (double)(sorted[i]->end_us - sorted[i]->start_us) / 1000.0, sorted[i]->name);
+        }
+        free(sorted);
+    }
+
+    QOLDEF bool qol_trace_end(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_trace_mutex);
+        if (!qol_trace.active) {
+            QOL_MUTEX_UNLOCK(qol_trace_mutex);
+            return false;
+        }
+        qol_trace.active = false;
+        uint64_t now_us = qol_timer_elapsed_ns(&qol_trace.clock) / 1000;
+        for (size_t i = 0; i < qol_trace.events.len; i++) {
+            if (qol_trace.events.data[i].running) qol_trace.events.data[i].end_us = now_us;
+        }
+
+        bool ok = false;
+        FILE *fp = fopen(qol_trace.path, "wb");
+        if (fp) {
+            fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", fp);
+            for (size_t i = 0; i < qol_trace.slots.len; i++) {
+                fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%zu,\"args\":{\"name\":\"slot %zu\"}},\n", i, i);
+            }
+            for (size_t i = 0; i < qol_trace.events.len; i++) {
+                QOL_TraceEvent *e = &qol_trace.events.data[i];
+                fputs("{\"name\":", fp);
+                qol_trace_json_string(fp, e->name);
+                fprintf(fp, ",\"cat\":\"command\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":1,\"tid\":%zu,\"args\":{\"cmd\":",
+                        (unsigned long long)e->start_us, (unsigned long long)(e->end_us - e->start_us), e->slot);
+                qol_trace_json_string(fp, e->cmdline);
+                fprintf(fp, ",\"status\":\"%s\"}}%s\n", e->running ? "running" : e->ok ? "ok" : "failed",
+                        i + 1 < qol_trace.events.len ? "," : "");
+            }
+            fputs("]}\n", fp);
+            ok = fclose(fp) == 0;
+        }
+        if (ok) qol_log(QOL_LOG_INFO, "Wrote build trace to %s\n", qol_trace.path);
+        else qol_log(QOL_LOG_ERRO, "Could not write build trace to %s\n", qol_trace.path);
+        qol_trace_summary(now_us);
+
+        for (size_t i = 0; i < qol_trace.events.len; i++) {
+            free(qol_trace.events.data[i].name);
+            free(qol_trace.events.data[i].cmdline);
+        }
+        qol_release(&qol_trace.events);
+        qol_release(&qol_trace.slots);
+        free(qol_trace.path);
+        qol_trace.path = NULL;
+        QOL_MUTEX_UNLOCK(qol_trace_mutex);
+        return ok;
+    }
+
+    // Launch cmd. If output_fd (error_fd) >= 0 it becomes the child's stdout (stderr), -1 keeps
+    // ours. With group (POSIX only) the child leads a new process group, so it can be killed with
+    // everything it started; the terminal no longer delivers Ctrl-C to it (the interrupt handler
+    // forwards it).
+    static QOL_Proc qol_cmd_spawn(QOL_Cmd* cmd, int output_fd, int error_fd, bool group) {
         if (!cmd || !cmd->data || cmd->len == 0) {
             qol_log(QOL_LOG_ERRO, "Invalid command: empty or null\n");
             return QOL_INVALID_PROC;
@@ -2169,6 +3527,7 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 #ifdef WINDOWS
         // Windows: CreateProcess requires a single command-line string, not an array
         // Arguments with spaces must be quoted. Example: "cc -Wall main.c -o main"
+        (void)group; // Console children share our Ctrl-C, a job is ended with TerminateProcess
         char cmdline[QOL_EXEC_BUFFER_SIZE] = {0};
         size_t pos = 0;
         bool truncated = false;
@@ -2203,183 +3562,4634 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
                 }
             }
         }
-        cmdline[sizeof(cmdline) - 1] = '\0'; // Ensure null termination
-        if (truncated) {
-            qol_log(QOL_LOG_ERRO, "Command line truncated (exceeds %zu bytes), command execution may fail\n", QOL_EXEC_BUFFER_SIZE - 1);
-            return QOL_INVALID_PROC;
+        cmdline[sizeof(cmdline) - 1] = '\0'; // Ensure null termination
+        if (truncated) {
+            qol_log(QOL_LOG_ERRO, "Command line truncated (exceeds %zu bytes), command execution may fail\n", QOL_EXEC_BUFFER_SIZE - 1);
+            return QOL_INVALID_PROC;
+        }
+
+        // Create process using Windows API
+        STARTUPINFO si = { sizeof(si) }; // Startup info (zero-initialized)
+        PROCESS_INFORMATION pi; // Process info (filled by CreateProcess)
+        ZeroMemory(&pi, sizeof(pi)); // Zero-initialize process info
+        BOOL inherit = FALSE;
+        if (output_fd >= 0 || error_fd >= 0) {
+            // Hand the files behind output_fd and error_fd to the child as its stdout and stderr
+            HANDLE output = output_fd >= 0 ? (HANDLE)_get_osfhandle(output_fd) : GetStdHandle(STD_OUTPUT_HANDLE);
+            HANDLE error = error_fd >= 0 ? (HANDLE)_get_osfhandle(error_fd) : GetStdHandle(STD_ERROR_HANDLE);
+            if (output_fd >= 0) SetHandleInformation(output, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+            if (error_fd >= 0) SetHandleInformation(error, HANDLE_FLAG_INHERIT, HANDLE_FLAG_INHERIT);
+            si.dwFlags |= STARTF_USESTDHANDLES;
+            si.hStdInput = GetStdHandle(STD_INPUT_HANDLE);
+            si.hStdOutput = output;
+            si.hStdError = error;
+            inherit = TRUE;
+        }
+
+        // CreateProcess: NULL for application name (use cmdline), cmdline contains full command
+        // Returns process handle and thread handle in PROCESS_INFORMATION
+        BOOL success = CreateProcessA(NULL, cmdline, NULL, NULL, inherit, 0, NULL, NULL, &si, &pi);
+        if (!success) {
+            qol_log(QOL_LOG_ERRO, "Could not create process: %s\n", qol_win32_error_message(GetLastError()));
+            return QOL_INVALID_PROC;
+        }
+
+        // Close thread handle (we only need process handle for waiting)
+        CloseHandle(pi.hThread);
+        qol_trace_spawned(cmd, pi.hProcess);
+        return pi.hProcess; // Return process handle for later waiting
+#else
+        // Unix: Build the NULL-terminated argv in the parent, the child must not allocate or lock
+        // (another thread may hold the malloc or logger lock at the moment of the fork)
+        char *argv_small[64];
+        char **argv = cmd->len < 64 ? argv_small : (char**)malloc((cmd->len + 1) * sizeof(char*));
+        if (!argv) {
+            qol_log(QOL_LOG_ERRO, "Could not allocate argv for %s\n", cmd->data[0]);
+            return QOL_INVALID_PROC;
+        }
+        for (size_t i = 0; i < cmd->len; i++) argv[i] = (char*)cmd->data[i];
+        argv[cmd->len] = NULL;
+
+        pid_t pid;
+    #ifdef QOL_USE_FORK
+        // Legacy launcher: fork + execvp. Copies the page tables of the parent, so its cost grows
+        // with the RSS of the build driver. Only async-signal-safe calls happen in the child.
+        pid = fork();
+        if (pid < 0) {
+            qol_log(QOL_LOG_ERRO, "Could not fork process: %s\n", strerror(errno));
+            if (argv != argv_small) free(argv);
+            return QOL_INVALID_PROC;
+        }
+        if (pid == 0) {
+            if (group) setpgid(0, 0);
+            if (output_fd >= 0) dup2(output_fd, STDOUT_FILENO);
+            if (error_fd >= 0) dup2(error_fd, STDERR_FILENO);
+            execvp(argv[0], argv);
+            _exit(127); // Same status a shell reports for a command that could not be run
+        }
+    #else
+        // posix_spawnp: vfork-style launch (glibc uses clone(CLONE_VM|CLONE_VFORK)), so the cost
+        // does not depend on the size of the parent. Exec failures (e.g. ENOENT) are reported here.
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_t *actions_ptr = NULL;
+        if (output_fd >= 0 || error_fd >= 0) {
+            posix_spawn_file_actions_init(&actions);
+            if (output_fd >= 0) posix_spawn_file_actions_adddup2(&actions, output_fd, STDOUT_FILENO);
+            if (error_fd >= 0) posix_spawn_file_actions_adddup2(&actions, error_fd, STDERR_FILENO);
+            actions_ptr = &actions;
+        }
+        posix_spawnattr_t attr;
+        posix_spawnattr_t *attr_ptr = NULL;
+        if (group) {
+            posix_spawnattr_init(&attr);
+            posix_spawnattr_setflags(&attr, POSIX_SPAWN_SETPGROUP);
+            posix_spawnattr_setpgroup(&attr, 0);
+            attr_ptr = &attr;
+        }
+        int err = posix_spawnp(&pid, argv[0], actions_ptr, attr_ptr, argv, environ);
+        if (actions_ptr) posix_spawn_file_actions_destroy(actions_ptr);
+        if (attr_ptr) posix_spawnattr_destroy(attr_ptr);
+        if (err != 0) {
+            qol_log(QOL_LOG_ERRO, "Could not spawn process %s: %s\n", argv[0], strerror(err));
+            if (argv != argv_small) free(argv);
+            return QOL_INVALID_PROC;
+        }
+    #endif
+        if (argv != argv_small) free(argv);
+
+        // Parent process: Return child PID for later waiting
+        qol_trace_spawned(cmd, pid);
+        return pid;
+#endif
+    }
+
+    QOLDEF QOL_Proc qol_cmd_execute_async(QOL_Cmd* cmd) {
+        return qol_cmd_spawn(cmd, -1, -1, false);
+    }
+
+
+#ifndef WINDOWS
+    // Children that qol_procs_poll() reaped from the shared pidfd epoll set but that are not tracked
+    // by the Procs array it was polling (e.g. another Procs array or a plain qol_proc_wait() caller).
+    // Their raw wait status is parked here so that the rightful waiter can still collect it.
+    typedef struct {
+        pid_t pid;             // Process ID of the reaped child
+        int wstatus;           // Raw status as returned by wait4()
+        struct rusage usage;   // Resource usage as returned by wait4()
+    } QOL_ReapedProc;
+
+    static qol_list(QOL_ReapedProc) qol_reaped_procs = {0};
+
+    static void qol_reaped_procs_put(pid_t pid, int wstatus, const struct rusage *usage) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        QOL_ReapedProc reaped = { .pid = pid, .wstatus = wstatus, .usage = *usage };
+        qol_push(&qol_reaped_procs, reaped);
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+    }
+
+    static bool qol_reaped_procs_take(pid_t pid, int *wstatus, struct rusage *usage) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        for (size_t i = 0; i < qol_reaped_procs.len; i++) {
+            if (qol_reaped_procs.data[i].pid == pid) {
+                *wstatus = qol_reaped_procs.data[i].wstatus;
+                *usage = qol_reaped_procs.data[i].usage;
+                qol_swap(&qol_reaped_procs, i);
+                qol_reaped_procs.len--;
+                QOL_MUTEX_UNLOCK(qol_exec_mutex);
+                return true;
+            }
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        return false;
+    }
+
+    // Translate a raw waitpid() status into success/failure (qol_job_finish() logs the reason)
+    static bool qol_proc_check_status(int wstatus) {
+        if (WIFEXITED(wstatus)) return WEXITSTATUS(wstatus) == 0;
+        return !WIFSIGNALED(wstatus);
+    }
+
+    // Convert what wait4() reported into a process result (name and wall time are filled in by the job)
+    static QOL_ProcResult qol_proc_result_from(int wstatus, const struct rusage *usage) {
+        QOL_ProcResult result = {0};
+        result.exit_code = WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : -1;
+        result.signal = WIFSIGNALED(wstatus) ? WTERMSIG(wstatus) : 0;
+        result.user_ms = (double)usage->ru_utime.tv_sec * 1000.0 + (double)usage->ru_utime.tv_usec / 1000.0;
+        result.sys_ms = (double)usage->ru_stime.tv_sec * 1000.0 + (double)usage->ru_stime.tv_usec / 1000.0;
+    #if defined(MACOS)
+        result.max_rss_kb = (size_t)usage->ru_maxrss / 1024; // Bytes on macOS
+    #else
+        result.max_rss_kb = (size_t)usage->ru_maxrss;        // KiB on Linux
+    #endif
+        return result;
+    }
+#endif
+
+    // Captured output of one stream of a job
+    typedef struct {
+        int fd;              // Read end of the pipe (-1 once it reached EOF)
+        struct { char *data; size_t len, cap; } buffer;  // Output received so far (from the buffer pool)
+    } QOL_CaptureStream;
+
+    // Job table: Bookkeeping for spawned commands whose completion has side effects (build log,
+    // depfile ingestion). Every wait function reports reaped children via qol_job_finish(), so
+    // async builds are recorded no matter which waiter ends up collecting them.
+    typedef struct {
+        QOL_Proc proc;       // Running process
+        QOL_String outputs;  // Outputs to record in the build log on success (owned copies)
+        char *depfile;       // Depfile to ingest on success (owned), NULL if none
+        uint64_t hash;       // qol_cmd_hash() of the command as the caller wrote it
+        char *cache_entry;   // Compile cache entry to fill from the first output on success (owned), NULL if none
+        QOL_Cmd cache_compile;     // Compile to run once the preprocessor (first stage) finished, empty if none
+        char *cache_preprocessed;  // Output of the first stage, hashed into the cache key (owned), NULL if none
+        uint64_t cache_key;        // Cache key so far: compiler identity and flags
+        bool cache_capture;        // Capture the output of the compile stage
+        QOL_Timer timer;     // Started right before the process was spawned
+        bool capturing;      // stdout and stderr go through pipes into capture
+        QOL_CaptureStream capture[2]; // stdout, stderr
+        size_t capture_max;  // Output cap for this job (both streams together)
+        size_t dropped;      // Bytes dropped because of the cap
+        QOL_ProcResults *results;  // Where to append the resource usage when reaped, NULL if not wanted
+        char *name;                // Label for the result (owned), NULL if none
+        const void *owner;         // Procs array or graph that started the job (memory accounting)
+        size_t pool;               // Index + 1 of the pool the job occupies, 0 if none
+        size_t weight;             // Pool slots occupied
+        bool charged;              // Its weight was added to the pool (qol_job_start), so it is given back
+        size_t mem_kb;             // Estimated peak RSS
+        bool group;                // Runs in its own process group (POSIX)
+        size_t timeout_ms;         // Terminate after this many milliseconds, 0 = no limit
+        int kill_stage;            // 0 = running, 1 = terminated, 2 = killed (outputs are partial)
+        uint64_t killed_ms;        // Time of the termination relative to the job's timer
+        bool restat;               // Keep the old timestamp of outputs whose content did not change (build log)
+        bool slot;                 // Holds a jobserver slot (returned when the job is done)
+        QOL_ProcCallback on_exit;  // Completion callback, NULL if none
+        void *user;                // Passed to on_exit
+    } QOL_Job;
+
+    // Pool: Limits the combined weight of running jobs tagged with its name
+    typedef struct {
+        char *name;
+        size_t depth;   // Maximum combined weight
+        size_t used;    // Weight of the running jobs (guarded by qol_exec_mutex)
+    } QOL_Pool;
+
+    static qol_list(QOL_Pool) qol_pools = {0};
+
+    static qol_list(QOL_Job) qol_jobs = {0};
+    static size_t qol_capture_open = 0; // Capture pipes still open (guarded by qol_exec_mutex)
+
+    // Interrupts: Ctrl-C while jobs run is forwarded to their process groups, then the next wait
+    // function reaps them, deletes their partial outputs and dies from the signal. The handler only
+    // reads the fixed slot table below and sets a flag (both are async-signal-safe).
+    #define QOL_SIGNAL_SLOTS 1024
+    static volatile sig_atomic_t qol_interrupted = 0;
+    static volatile sig_atomic_t qol_live_jobs = 0; // Jobs in the job table (guarded by qol_exec_mutex for writes)
+#ifndef WINDOWS
+    static volatile pid_t qol_signal_slots[QOL_SIGNAL_SLOTS]; // -pgid of grouped jobs, pid of the others, 0 = free
+
+    static void qol_interrupt_handler(int sig) {
+        if (qol_interrupted) _exit(128 + sig); // Second Ctrl-C: skip the cleanup
+        if (qol_live_jobs == 0) { // Nothing to clean up: die as if no handler was installed
+            signal(sig, SIG_DFL);
+            raise(sig);
+            return;
+        }
+        for (size_t i = 0; i < QOL_SIGNAL_SLOTS; i++) {
+            pid_t target = qol_signal_slots[i];
+            if (target < 0) kill(target, sig); // The terminal only signals our own process group
+        }
+        qol_interrupted = sig;
+    }
+#else
+    static void qol_interrupt_handler(int sig) {
+        // Console children receive Ctrl-C themselves, the waits return once they exited
+        if (qol_live_jobs == 0 || qol_interrupted) {
+            signal(sig, SIG_DFL);
+            raise(sig);
+            return;
+        }
+        qol_interrupted = sig;
+        signal(sig, qol_interrupt_handler);
+    }
+#endif
+
+    // Signals whose handler is installed while jobs run (see qol_interrupt_install)
+#ifdef WINDOWS
+    static const int qol_interrupt_signals[] = { SIGINT };
+#else
+    static const int qol_interrupt_signals[] = { SIGINT, SIGTERM, SIGHUP };
+#endif
+    #define QOL_INTERRUPT_SIGNALS (sizeof(qol_interrupt_signals) / sizeof(qol_interrupt_signals[0]))
+    static bool qol_interrupt_installed[QOL_INTERRUPT_SIGNALS] = {0};
+
+    // Install the interrupt handler for the time jobs run, unless the program has its own (or
+    // ignores the signal, e.g. under nohup). Must be called with qol_exec_mutex held.
+    static void qol_interrupt_install(void) {
+        for (size_t i = 0; i < QOL_INTERRUPT_SIGNALS; i++) {
+            if (qol_interrupt_installed[i]) continue;
+#ifdef WINDOWS
+            void (*previous)(int) = signal(qol_interrupt_signals[i], qol_interrupt_handler);
+            if (previous != SIG_DFL) {
+                signal(qol_interrupt_signals[i], previous);
+                continue;
+            }
+#else
+            struct sigaction old;
+            if (sigaction(qol_interrupt_signals[i], NULL, &old) != 0 || old.sa_handler != SIG_DFL) continue;
+            struct sigaction sa;
+            memset(&sa, 0, sizeof(sa));
+            sa.sa_handler = qol_interrupt_handler;
+            sigemptyset(&sa.sa_mask);
+            sa.sa_flags = 0; // No SA_RESTART: a blocking wait4() returns EINTR and notices the interrupt
+            sigaction(qol_interrupt_signals[i], &sa, NULL);
+#endif
+            qol_interrupt_installed[i] = true;
+        }
+    }
+
+    // Give the signals back to their default handling once the last job is gone, so that the
+    // program's own signal setup afterwards is not shadowed. Must be called with qol_exec_mutex held.
+    static void qol_interrupt_restore(void) {
+        if (qol_live_jobs > 0 || qol_interrupted) return;
+        for (size_t i = 0; i < QOL_INTERRUPT_SIGNALS; i++) {
+            if (!qol_interrupt_installed[i]) continue;
+            signal(qol_interrupt_signals[i], SIG_DFL); // Installed only over SIG_DFL
+            qol_interrupt_installed[i] = false;
+        }
+    }
+
+    // Terminate a job (with its process group), hard = SIGKILL. Must be called with qol_exec_mutex held.
+    static void qol_job_kill(QOL_Job *job, bool hard) {
+#ifdef WINDOWS
+        (void)hard;
+        TerminateProcess(job->proc, 1);
+        job->kill_stage = 2;
+#else
+        kill(job->group ? -job->proc : job->proc, hard ? SIGKILL : SIGTERM);
+        job->kill_stage = hard ? 2 : 1;
+#endif
+        job->killed_ms = qol_timer_elapsed_ns(&job->timer) / 1000000;
+    }
+
+    // Do the wait functions have to wake up regularly (a timeout runs or a SIGKILL is due)?
+    // Must be called with qol_exec_mutex held.
+    static bool qol_jobs_watched(void) {
+        for (size_t i = 0; i < qol_jobs.len; i++) {
+            const QOL_Job *job = &qol_jobs.data[i];
+            if ((job->timeout_ms && job->kill_stage == 0) || job->kill_stage == 1) return true;
+        }
+        return false;
+    }
+
+    // Terminate jobs past their timeout and kill the ones that ignored the termination
+    static void qol_jobs_check_deadlines(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        for (size_t i = 0; i < qol_jobs.len; i++) {
+            QOL_Job *job = &qol_jobs.data[i];
+            uint64_t elapsed = qol_timer_elapsed_ns(&job->timer) / 1000000;
+            if (job->kill_stage == 0 && job->timeout_ms && elapsed >= job->timeout_ms) {
+                qol_log(QOL_LOG_ERRO, "Command timed out after %zu ms: %s\n", job->timeout_ms, job->name ? job->name : "?");
+                qol_job_kill(job, false);
+            } else if (job->kill_stage == 1 && elapsed - job->killed_ms >= QOL_KILL_GRACE_MS) {
+                qol_job_kill(job, true);
+            }
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+    }
+
+#ifdef WINDOWS
+    // Timeout for the Windows wait calls: short while timeouts have to be enforced
+    static DWORD qol_wait_slice_ms(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        bool watched = qol_jobs_watched();
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        return watched ? 5 : INFINITE;
+    }
+
+    // WaitForMultipleObjects() for any number of handles. One call watches at most
+    // MAXIMUM_WAIT_OBJECTS (64), so larger sets are checked chunk by chunk and slept on in 5 ms
+    // slices. Returns WAIT_OBJECT_0 with the position of a signaled handle in *index, WAIT_TIMEOUT
+    // or WAIT_FAILED.
+    static DWORD qol_wait_handles(const HANDLE *handles, size_t count, DWORD timeout_ms, size_t *index) {
+        DWORD waited = 0;
+        for (;;) {
+            DWORD slice = count <= MAXIMUM_WAIT_OBJECTS ? timeout_ms : 0;
+            for (size_t base = 0; base < count; base += MAXIMUM_WAIT_OBJECTS) {
+                DWORD chunk = count - base < MAXIMUM_WAIT_OBJECTS ? (DWORD)(count - base) : MAXIMUM_WAIT_OBJECTS;
+                DWORD result = WaitForMultipleObjects(chunk, handles + base, FALSE, slice);
+                if (result == WAIT_TIMEOUT) continue;
+                if (result >= WAIT_OBJECT_0 + chunk) return WAIT_FAILED;
+                *index = base + (result - WAIT_OBJECT_0);
+                return WAIT_OBJECT_0;
+            }
+            if (count <= MAXIMUM_WAIT_OBJECTS || (timeout_ms != INFINITE && waited >= timeout_ms)) return WAIT_TIMEOUT;
+            Sleep(5);
+            waited += 5;
+        }
+    }
+#endif
+
+    // Delete the outputs (and depfile) a killed job may have left half written. Returns the number removed.
+    static size_t qol_job_remove_outputs(const QOL_Job *job) {
+        size_t removed = 0;
+        for (size_t i = 0; i < job->outputs.len; i++) {
+            if (remove(job->outputs.data[i]) == 0) removed++;
+        }
+        if (job->depfile) remove(job->depfile);
+        return removed;
+    }
+
+#ifndef WINDOWS
+    static size_t qol_workers_interrupt(void);
+#endif
+
+#ifndef WINDOWS
+    static void qol_alarm_handler(int sig) { (void)sig; } // Only interrupts a blocking waitpid
+#endif
+
+    // Reap the jobs of an interrupted build, delete their partial outputs and die from the signal
+    static void qol_interrupt_cleanup(void) {
+        int sig = (int)qol_interrupted;
+        size_t removed = 0;
+#ifndef WINDOWS
+        removed += qol_workers_interrupt();
+#endif
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+#ifndef WINDOWS
+        bool expired = false;
+        struct sigaction alarm_action, old_alarm;
+        memset(&alarm_action, 0, sizeof(alarm_action));
+        alarm_action.sa_handler = qol_alarm_handler;
+        sigemptyset(&alarm_action.sa_mask);
+        sigaction(SIGALRM, &alarm_action, &old_alarm);
+        struct itimerval grace = {0};
+        grace.it_value.tv_sec = QOL_KILL_GRACE_MS / 1000;
+        grace.it_value.tv_usec = (QOL_KILL_GRACE_MS % 1000) * 1000;
+        setitimer(ITIMER_REAL, &grace, NULL);
+#endif
+        for (size_t i = 0; i < qol_jobs.len; i++) {
+            QOL_Job *job = &qol_jobs.data[i];
+#ifdef WINDOWS
+            if (WaitForSingleObject(job->proc, QOL_KILL_GRACE_MS) != WAIT_OBJECT_0) TerminateProcess(job->proc, 1);
+#else
+            bool finished = false; // Reaped on behalf of another waiter: it completed before the interrupt
+            for (size_t k = 0; k < qol_reaped_procs.len && !finished; k++) finished = qol_reaped_procs.data[k].pid == job->proc;
+            if (finished) continue;
+            // Block in waitpid until the grace period shared by all jobs expires (SIGALRM interrupts it)
+            if (!expired && waitpid(job->proc, NULL, 0) < 0 && errno == EINTR) expired = true;
+            if (expired) {
+                kill(job->group ? -job->proc : job->proc, SIGKILL);
+                waitpid(job->proc, NULL, 0);
+            }
+#endif
+            removed += qol_job_remove_outputs(job);
+        }
+#ifndef WINDOWS
+        memset(&grace, 0, sizeof(grace));
+        setitimer(ITIMER_REAL, &grace, NULL);
+        sigaction(SIGALRM, &old_alarm, NULL);
+#endif
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        qol_log(QOL_LOG_ERRO, "Interrupted, removed %zu partial output%s\n", removed, removed == 1 ? "" : "s");
+        signal(sig, SIG_DFL);
+        raise(sig);
+        exit(128 + sig);
+    }
+
+#ifndef WINDOWS
+    // Buffer pool: Capture buffers are recycled instead of freed, a handful is kept around so that
+    // memory stays bounded by (parallel jobs + pool size) * buffer capacity
+    #define QOL_CAPTURE_POOL_SIZE 16
+    static qol_list(char*) qol_capture_pool = {0};
+    static qol_list(size_t) qol_capture_pool_caps = {0};
+
+    // Append data to a stream of a job's capture. Must be called with qol_exec_mutex held.
+    static void qol_capture_append(QOL_Job *job, QOL_CaptureStream *stream, const char *data, size_t size) {
+        size_t used = job->capture[0].buffer.len + job->capture[1].buffer.len;
+        size_t room = job->capture_max > used ? job->capture_max - used : 0;
+        if (size > room) {
+            job->dropped += size - room;
+            size = room;
+        }
+        if (size == 0) return;
+        if (!stream->buffer.data && qol_capture_pool.len > 0) {
+            stream->buffer.data = qol_capture_pool.data[--qol_capture_pool.len];
+            stream->buffer.cap = qol_capture_pool_caps.data[--qol_capture_pool_caps.len];
+        }
+        if (stream->buffer.len + size > stream->buffer.cap) {
+            size_t cap = stream->buffer.cap ? stream->buffer.cap : 4096;
+            while (cap < stream->buffer.len + size) cap *= 2;
+            char *grown = (char*)realloc(stream->buffer.data, cap);
+            if (!grown) abort();
+            stream->buffer.data = grown;
+            stream->buffer.cap = cap;
+        }
+        memcpy(stream->buffer.data + stream->buffer.len, data, size);
+        stream->buffer.len += size;
+    }
+
+    // Read whatever is available on one of a job's pipes; closes it on EOF. Must be called with
+    // qol_exec_mutex held.
+    static void qol_capture_read(QOL_Job *job, QOL_CaptureStream *stream) {
+        char buffer[16 * 1024];
+        while (stream->fd >= 0) {
+            ssize_t n = read(stream->fd, buffer, sizeof(buffer));
+            if (n > 0) {
+                qol_capture_append(job, stream, buffer, (size_t)n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return;
+            close(stream->fd); // EOF (or error): nothing more will come
+            stream->fd = -1;
+            qol_capture_open--;
+            return;
+        }
+    }
+
+    // Wait up to timeout_ms for output of any captured job (or for wake_fd to become readable,
+    // -1 = none) and buffer it. Returns true if wake_fd is readable.
+    static bool qol_capture_wait(int timeout_ms, int wake_fd) {
+        struct pollfd fds_small[64];
+        struct pollfd *fds = fds_small;
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        if (2 * qol_jobs.len + 1 > 64) fds = (struct pollfd*)malloc((2 * qol_jobs.len + 1) * sizeof(struct pollfd));
+        nfds_t count = 0;
+        for (size_t i = 0; fds && i < qol_jobs.len; i++) {
+            for (size_t k = 0; k < 2 && qol_jobs.data[i].capturing; k++) {
+                if (qol_jobs.data[i].capture[k].fd < 0) continue;
+                fds[count].fd = qol_jobs.data[i].capture[k].fd;
+                fds[count].events = POLLIN;
+                fds[count].revents = 0;
+                count++;
+            }
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        if (!fds) abort();
+        nfds_t captures = count;
+        if (wake_fd >= 0) fds[count++] = (struct pollfd){ .fd = wake_fd, .events = POLLIN };
+
+        bool woken = false;
+        if (poll(fds, count, timeout_ms) > 0) {
+            woken = wake_fd >= 0 && fds[captures].revents != 0;
+            QOL_MUTEX_LOCK(qol_exec_mutex);
+            for (nfds_t k = 0; k < captures; k++) {
+                if (fds[k].revents == 0) continue;
+                for (size_t i = 0; i < qol_jobs.len; i++) {
+                    QOL_Job *job = &qol_jobs.data[i];
+                    size_t stream = !job->capturing ? 2 : job->capture[0].fd == fds[k].fd ? 0 : job->capture[1].fd == fds[k].fd ? 1 : 2;
+                    if (stream == 2) continue;
+                    qol_capture_read(job, &job->capture[stream]);
+                    break;
+                }
+            }
+            QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        }
+        if (fds != fds_small) free(fds);
+        return woken;
+    }
+
+    // Wait up to timeout_ms for output of any captured job and buffer it
+    static void qol_capture_pump(int timeout_ms) {
+        qol_capture_wait(timeout_ms, -1);
+    }
+
+    // waitpid() that keeps capture pipes drained while it blocks. Children writing more than a
+    // pipe buffer would otherwise never exit. On Linux a pidfd of pid joins the poll on the pipes,
+    // so the wait sleeps until output arrives or pid exits; elsewhere (and for pid -1) the exit is
+    // noticed within 5 ms. Timeouts are enforced on the way and an interrupt (Ctrl-C) ends the
+    // program here.
+    static pid_t qol_waitpid_pumping(pid_t pid, int *wstatus, struct rusage *usage) {
+        int exit_fd = -1; // Readable once pid exited
+#if defined(LINUX) && defined(SYS_pidfd_open)
+        bool opened = false;
+#endif
+        for (;;) {
+            if (qol_interrupted) qol_interrupt_cleanup();
+            qol_init_mutexes();
+            QOL_MUTEX_LOCK(qol_exec_mutex);
+            bool capturing = qol_capture_open > 0;
+            bool watched = qol_jobs_watched();
+            QOL_MUTEX_UNLOCK(qol_exec_mutex);
+            if (!capturing && !watched) {
+                pid_t result = wait4(pid, wstatus, 0, usage);
+                if (result < 0 && errno == EINTR && qol_interrupted) continue;
+                if (exit_fd >= 0) close(exit_fd);
+                return result;
+            }
+
+            pid_t result = wait4(pid, wstatus, WNOHANG, usage);
+            if (result != 0) {
+                if (exit_fd >= 0) close(exit_fd);
+                return result;
+            }
+            qol_jobs_check_deadlines();
+#if defined(LINUX) && defined(SYS_pidfd_open)
+            if (!opened && pid > 0) {
+                opened = true;
+                exit_fd = (int)syscall(SYS_pidfd_open, pid, 0);
+            }
+#endif
+            qol_capture_wait(watched || exit_fd < 0 ? 5 : -1, exit_fd);
+        }
+    }
+
+    // Print a finished job's output in one piece (each stream to where the command would have
+    // written it) and recycle its buffers
+    static void qol_capture_flush(QOL_Job *job) {
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        for (size_t k = 0; k < 2; k++) {
+            QOL_CaptureStream *stream = &job->capture[k];
+            if (stream->fd < 0) continue;
+            qol_capture_read(job, stream); // Rest of the output still sitting in the pipe
+            if (stream->fd >= 0) { // Held open by a grandchild: don't wait for it
+                close(stream->fd);
+                stream->fd = -1;
+                qol_capture_open--;
+            }
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+
+        QOL_MUTEX_LOCK(qol_logger_mutex);
+        for (size_t k = 0; k < 2; k++) {
+            QOL_CaptureStream *stream = &job->capture[k];
+            FILE *out = k == 0 ? stdout : stderr;
+            if (stream->buffer.len == 0) continue;
+            fwrite(stream->buffer.data, 1, stream->buffer.len, out);
+            if (stream->buffer.data[stream->buffer.len - 1] != '\n') fputc('\n', out);
+            fflush(out);
+        }
+        if (job->dropped > 0) {
+            fprintf(stderr, "[... %zu more bytes of output dropped]\n", job->dropped);
+            fflush(stderr);
+        }
+        QOL_MUTEX_UNLOCK(qol_logger_mutex);
+
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        for (size_t k = 0; k < 2; k++) {
+            QOL_CaptureStream *stream = &job->capture[k];
+            if (stream->buffer.data && qol_capture_pool.len < QOL_CAPTURE_POOL_SIZE) {
+                qol_push(&qol_capture_pool, stream->buffer.data);
+                qol_push(&qol_capture_pool_caps, stream->buffer.cap);
+            } else {
+                free(stream->buffer.data);
+            }
+            stream->buffer.data = NULL;
+            stream->buffer.len = stream->buffer.cap = 0;
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        job->capturing = false;
+    }
+#endif
+
+    //////////////////////////////////////////////////
+    /// JOBSERVER ////////////////////////////////////
+    //////////////////////////////////////////////////
+
+    typedef enum {
+        QOL_JOBSERVER_NONE = 0,
+        QOL_JOBSERVER_CLIENT, // Tokens come from a parent make
+        QOL_JOBSERVER_SERVER, // We created the jobserver for our children
+    } QOL_JobserverMode;
+
+    // Jobserver state (guarded by qol_exec_mutex). The first running job of the process uses the
+    // implicit slot every make job owns, every further one holds a token taken from the jobserver.
+    static struct {
+        QOL_JobserverMode mode;
+        bool probed;                               // MAKEFLAGS was looked at
+        size_t size;                               // Slots served (QOL_JOBSERVER_SERVER)
+        char *makeflags;                           // MAKEFLAGS before serving (NULL if unset)
+        char auth[64];                             // --jobserver-auth value served
+        size_t slots;                              // Running jobs holding a slot
+        struct { char *data; size_t len, cap; } tokens; // Token bytes taken (given back unchanged)
+#ifdef WINDOWS
+        HANDLE semaphore;
+#else
+        int read_fd;   // Non-blocking where possible (own open file description)
+        int write_fd;
+#endif
+    } qol_jobserver = {0};
+
+#ifndef WINDOWS
+    // Open a private non-blocking read end of the jobserver pipe: flags set on the inherited
+    // descriptor would be shared with make and every other client. Falls back to fd on systems
+    // without /proc, where a token taken by someone else between poll and read blocks until the next one.
+    static int qol_jobserver_reader(int fd) {
+        char path[64];
+        snprintf(path, sizeof(path), "/proc/self/fd/%d", fd);
+        int reader = open(path, O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+        return reader >= 0 ? reader : fd;
+    }
+#endif
+
+    // Join the jobserver named by the --jobserver-auth (or older --jobserver-fds) argument in makeflags
+    static void qol_jobserver_connect(const char *makeflags) {
+        const char *auth = NULL;
+        for (const char *p = makeflags; p && *p; p++) {
+            if (strncmp(p, "--jobserver-auth=", 17) == 0) auth = p + 17; // The last one wins
+            else if (strncmp(p, "--jobserver-fds=", 16) == 0) auth = p + 16;
+        }
+        if (!auth) return;
+        char value[512];
+        size_t len = strcspn(auth, " ");
+        if (len == 0 || len >= sizeof(value)) return;
+        memcpy(value, auth, len);
+        value[len] = '\0';
+
+#ifdef WINDOWS
+        qol_jobserver.semaphore = OpenSemaphoreA(SEMAPHORE_MODIFY_STATE | SYNCHRONIZE, FALSE, value);
+        if (!qol_jobserver.semaphore) {
+            qol_log(QOL_LOG_DIAG, "Jobserver %s from MAKEFLAGS is not available\n", value);
+            return;
+        }
+#else
+        if (strncmp(value, "fifo:", 5) == 0) {
+            int fd = open(value + 5, O_RDWR | O_NONBLOCK | O_CLOEXEC);
+            if (fd < 0) {
+                qol_log(QOL_LOG_DIAG, "Jobserver fifo %s is not available: %s\n", value + 5, strerror(errno));
+                return;
+            }
+            qol_jobserver.read_fd = fd;
+            qol_jobserver.write_fd = fd;
+        } else {
+            int read_fd, write_fd;
+            if (sscanf(value, "%d,%d", &read_fd, &write_fd) != 2 || read_fd < 0 || write_fd < 0 ||
+                fcntl(read_fd, F_GETFD) < 0 || fcntl(write_fd, F_GETFD) < 0) {
+                // make closes them for recipes it does not consider recursive
+                qol_log(QOL_LOG_DIAG, "Jobserver from MAKEFLAGS is not available (mark the recipe with '+')\n");
+                return;
+            }
+            qol_jobserver.read_fd = qol_jobserver_reader(read_fd);
+            qol_jobserver.write_fd = write_fd;
+        }
+#endif
+        qol_jobserver.mode = QOL_JOBSERVER_CLIENT;
+        qol_log(QOL_LOG_DIAG, "Jobserver: using %s\n", value);
+    }
+
+    // Export MAKEFLAGS naming the served jobserver, after the flags it had before serving
+    static void qol_jobserver_export(void) {
+        const char *makeflags = qol_jobserver.makeflags;
+        size_t size = (makeflags ? strlen(makeflags) : 0) + strlen(qol_jobserver.auth) + 64;
+        char *flags = (char*)malloc(size);
+        if (!flags) abort();
+        snprintf(flags, size, "%s -j%zu --jobserver-auth=%s", makeflags ? makeflags : "", qol_jobserver.size, qol_jobserver.auth);
+#ifdef WINDOWS
+        SetEnvironmentVariableA("MAKEFLAGS", flags);
+        _putenv_s("MAKEFLAGS", flags);
+#else
+        setenv("MAKEFLAGS", flags, 1);
+#endif
+        free(flags);
+    }
+
+    // Create a jobserver with jobs slots (jobs - 1 tokens plus our implicit one) and export it
+    static void qol_jobserver_serve(size_t jobs) {
+#ifdef WINDOWS
+        snprintf(qol_jobserver.auth, sizeof(qol_jobserver.auth), "qol_jobserver_%lu", (unsigned long)GetCurrentProcessId());
+        // Room to grow: the maximum only bounds ReleaseSemaphore
+        qol_jobserver.semaphore = CreateSemaphoreA(NULL, (LONG)(jobs - 1), LONG_MAX, qol_jobserver.auth);
+        if (!qol_jobserver.semaphore) {
+            qol_log(QOL_LOG_DIAG, "Could not create jobserver semaphore: %s\n", qol_win32_error_message(GetLastError()));
+            return;
+        }
+#else
+        int fds[2];
+        if (pipe(fds) != 0) {
+            qol_log(QOL_LOG_DIAG, "Could not create jobserver pipe: %s\n", strerror(errno));
+            return;
+        }
+        for (size_t i = 1; i < jobs; i++) {
+            if (write(fds[1], "+", 1) != 1) break;
+        }
+        qol_jobserver.read_fd = qol_jobserver_reader(fds[0]);
+        qol_jobserver.write_fd = fds[1];
+        snprintf(qol_jobserver.auth, sizeof(qol_jobserver.auth), "%d,%d", fds[0], fds[1]);
+#endif
+        const char *makeflags = getenv("MAKEFLAGS");
+        qol_jobserver.makeflags = makeflags ? strdup(makeflags) : NULL;
+        qol_jobserver.size = jobs;
+        qol_jobserver.mode = QOL_JOBSERVER_SERVER;
+        qol_jobserver_export();
+        qol_log(QOL_LOG_DIAG, "Jobserver: serving %zu slots (%s)\n", jobs, qol_jobserver.auth);
+    }
+
+    // Add tokens to the served jobserver until it has jobs slots
+    static void qol_jobserver_grow(size_t jobs) {
+#ifdef WINDOWS
+        if (!ReleaseSemaphore(qol_jobserver.semaphore, (LONG)(jobs - qol_jobserver.size), NULL)) return;
+#else
+        for (size_t i = qol_jobserver.size; i < jobs; i++) {
+            if (write(qol_jobserver.write_fd, "+", 1) != 1) return;
+        }
+#endif
+        qol_jobserver.size = jobs;
+        qol_jobserver_export();
+        qol_log(QOL_LOG_DIAG, "Jobserver: serving %zu slots\n", jobs);
+    }
+
+    // Join the jobserver of a parent make, if any (pools and graphs never serve one on their own)
+    static bool qol_jobserver_join(void) {
+#ifdef QOL_NO_JOBSERVER
+        return false;
+#else
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        if (!qol_jobserver.probed) {
+            qol_jobserver.probed = true;
+            qol_jobserver_connect(getenv("MAKEFLAGS"));
+        }
+        bool active = qol_jobserver.mode != QOL_JOBSERVER_NONE;
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        return active;
+#endif
+    }
+
+    QOLDEF bool qol_jobserver_init(size_t jobs) {
+#ifdef QOL_NO_JOBSERVER
+        (void)jobs;
+        return false;
+#else
+        qol_jobserver_join();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        if (qol_jobserver.mode == QOL_JOBSERVER_NONE && jobs > 1) qol_jobserver_serve(jobs);
+        else if (qol_jobserver.mode == QOL_JOBSERVER_SERVER && jobs > qol_jobserver.size) qol_jobserver_grow(jobs);
+        bool active = qol_jobserver.mode != QOL_JOBSERVER_NONE;
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        return active;
+#endif
+    }
+
+    QOLDEF bool qol_jobserver_stop(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        bool stopped = qol_jobserver.slots == 0;
+        if (stopped && qol_jobserver.mode == QOL_JOBSERVER_SERVER) {
+#ifdef WINDOWS
+            CloseHandle(qol_jobserver.semaphore);
+            SetEnvironmentVariableA("MAKEFLAGS", qol_jobserver.makeflags);
+            _putenv_s("MAKEFLAGS", qol_jobserver.makeflags ? qol_jobserver.makeflags : "");
+#else
+            int read_fd = 0, write_fd = 0;
+            if (sscanf(qol_jobserver.auth, "%d,%d", &read_fd, &write_fd) == 2 && read_fd != qol_jobserver.read_fd) close(read_fd);
+            close(qol_jobserver.read_fd);
+            close(qol_jobserver.write_fd);
+            if (qol_jobserver.makeflags) setenv("MAKEFLAGS", qol_jobserver.makeflags, 1);
+            else unsetenv("MAKEFLAGS");
+#endif
+            free(qol_jobserver.makeflags);
+            qol_release(&qol_jobserver.tokens);
+            memset(&qol_jobserver, 0, sizeof(qol_jobserver));
+            qol_log(QOL_LOG_DIAG, "Jobserver: stopped serving\n");
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        return stopped;
+    }
+
+    // Take the implicit slot or a token without waiting
+    static bool qol_jobserver_try_take(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        char token = '+';
+        bool taken = qol_jobserver.slots == 0;
+#ifdef WINDOWS
+        if (!taken) taken = WaitForSingleObject(qol_jobserver.semaphore, 0) == WAIT_OBJECT_0;
+#else
+        if (!taken) {
+            struct pollfd fd = { .fd = qol_jobserver.read_fd, .events = POLLIN };
+            taken = poll(&fd, 1, 0) > 0 && read(qol_jobserver.read_fd, &token, 1) == 1;
+        }
+#endif
+        if (taken) {
+            if (qol_jobserver.slots > 0) qol_push(&qol_jobserver.tokens, token);
+            qol_jobserver.slots++;
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        return taken;
+    }
+
+    // Take a jobserver slot for a command about to be started into running. Waits while no token is
+    // free; returns false if one of running's commands exited meanwhile (not reaped), so that the
+    // caller reaps it first. *slot tells whether a slot was taken: an array with nothing running may
+    // always start one command, just like every make may run one job without a token.
+    static bool qol_jobserver_take(const QOL_Procs *running, bool *slot) {
+        *slot = false;
+        if (qol_jobserver.mode == QOL_JOBSERVER_NONE) return true;
+        for (;;) {
+            if (qol_jobserver_try_take()) {
+                *slot = true;
+                return true;
+            }
+            if (!running || running->len == 0) return true;
+#ifdef WINDOWS
+            HANDLE *handles = (HANDLE*)malloc((running->len + 1) * sizeof(HANDLE));
+            if (!handles) abort();
+            handles[0] = qol_jobserver.semaphore;
+            memcpy(handles + 1, running->data, running->len * sizeof(HANDLE));
+            size_t index = 0;
+            DWORD result = qol_wait_handles(handles, running->len + 1, qol_wait_slice_ms(), &index);
+            free(handles);
+            if (result == WAIT_OBJECT_0 && index == 0) {
+                QOL_MUTEX_LOCK(qol_exec_mutex);
+                qol_push(&qol_jobserver.tokens, '+');
+                qol_jobserver.slots++;
+                QOL_MUTEX_UNLOCK(qol_exec_mutex);
+                *slot = true;
+                return true;
+            }
+            if (result != WAIT_TIMEOUT) return false;
+            qol_jobs_check_deadlines();
+#else
+            for (size_t i = 0; i < running->len; i++) {
+                siginfo_t info;
+                memset(&info, 0, sizeof(info));
+                // WNOWAIT leaves the child to the wait function; an error means it was reaped elsewhere
+                if (waitid(P_PID, (id_t)running->data[i], &info, WEXITED | WNOHANG | WNOWAIT) != 0 || info.si_pid != 0) return false;
+            }
+            struct pollfd fd = { .fd = qol_jobserver.read_fd, .events = POLLIN };
+            poll(&fd, 1, 5);
+            qol_jobs_check_deadlines();
+            qol_capture_pump(0);
+#endif
+            if (qol_interrupted) return false;
+        }
+    }
+
+    // Give back the slot of a finished command
+    static void qol_jobserver_give(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        if (qol_jobserver.slots > 0) qol_jobserver.slots--;
+        if (qol_jobserver.tokens.len > 0) {
+            char token = qol_jobserver.tokens.data[--qol_jobserver.tokens.len];
+#ifdef WINDOWS
+            (void)token;
+            ReleaseSemaphore(qol_jobserver.semaphore, 1, NULL);
+#else
+            while (write(qol_jobserver.write_fd, &token, 1) < 0 && errno == EINTR) {}
+#endif
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+    }
+
+    static void qol_cache_store(const char *output, const char *entry);
+
+#if defined(LINUX) && defined(SYS_pidfd_open)
+    // Process polling: One pidfd per child in a single epoll set (level-triggered, so a child
+    // whose exit was not handled yet is reported again). Registered lazily by qol_procs_poll(),
+    // forgotten when the child is reaped, no matter by whom.
+    typedef struct { pid_t pid; int fd; } QOL_PollFd;
+    static qol_list(QOL_PollFd) qol_poll_fds = {0}; // Guarded by qol_exec_mutex
+    static int qol_poll_epoll = -1;
+    static bool qol_poll_fallback = false;           // pidfds are not available (old kernel, seccomp)
+
+    static void qol_poll_forget(pid_t pid) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        for (size_t i = 0; i < qol_poll_fds.len; i++) {
+            if (qol_poll_fds.data[i].pid != pid) continue;
+            close(qol_poll_fds.data[i].fd); // Also removes it from the epoll set
+            qol_swap(&qol_poll_fds, i);
+            qol_poll_fds.len--;
+            break;
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+    }
+#endif
+
+    static void qol_job_release(QOL_Job *job) {
+        qol_release_string(&job->outputs);
+        qol_release(&job->cache_compile);
+        if (job->cache_preprocessed) remove(job->cache_preprocessed);
+        free(job->depfile);
+        free(job->cache_entry);
+        free(job->cache_preprocessed);
+        free(job->name);
+        job->depfile = NULL;
+        job->cache_entry = NULL;
+        job->cache_preprocessed = NULL;
+        job->name = NULL;
+    }
+
+    // Side effects of a finished job (output, results, build log, deps log, compile cache). usage is
+    // what the wait function learned about the process, NULL if it did not run. Releases the job.
+    static void qol_restat_output(const char *output, QOL_BuildLogEntry *entry);
+
+    // Log why a command failed (usage as reported by the wait function, NULL if it did not run)
+    static void qol_proc_log_failure(const QOL_ProcResult *usage) {
+        if (!usage) return;
+        if (usage->signal) qol_log(QOL_LOG_ERRO, "Command terminated by signal %d\n", usage->signal);
+        else if (usage->exit_code != 0) qol_log(QOL_LOG_ERRO, "Command failed with exit code %d\n", usage->exit_code);
+    }
+
+    static void qol_job_done(QOL_Job *job, bool success, const QOL_ProcResult *usage) {
+#ifndef WINDOWS
+        if (job->capturing) qol_capture_flush(job);
+#endif
+        if (!success) qol_proc_log_failure(usage); // After the output, so that the error stays with it
+        if (job->kill_stage) {
+            success = false;
+            if (qol_job_remove_outputs(job) > 0) qol_log(QOL_LOG_DIAG, "Removed partial outputs of %s\n", job->outputs.data[0]);
+        }
+        // The command may have written its outputs (or anything, if they are unknown)
+        if (job->outputs.len == 0) qol_stat_invalidate(NULL);
+        for (size_t i = 0; i < job->outputs.len; i++) qol_stat_invalidate(job->outputs.data[i]);
+        if (job->pool && job->charged) {
+            qol_init_mutexes();
+            QOL_MUTEX_LOCK(qol_exec_mutex);
+            qol_pools.data[job->pool - 1].used -= job->weight;
+            QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        }
+        if (job->slot) {
+            qol_jobserver_give();
+            job->slot = false;
+        }
+        if (job->results && usage) {
+            QOL_ProcResult result = *usage;
+            result.name = job->name;
+            result.wall_ms = (double)qol_timer_elapsed_ns(&job->timer) / 1e6;
+            job->name = NULL; // Owned by the result now
+            qol_init_mutexes();
+            QOL_MUTEX_LOCK(qol_exec_mutex);
+            qol_push(job->results, result);
+            QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        }
+        if (success) {
+            QOL_BuildLogEntry entry = { .hash = job->hash, .duration_ms = qol_timer_elapsed_ns(&job->timer) / 1000000 };
+            QOL_BuildLogEntry previous;
+            if (usage) entry.max_rss_kb = usage->max_rss_kb;
+            else if (job->outputs.len > 0 && qol_build_log_get(job->outputs.data[0], &previous)) {
+                entry.max_rss_kb = previous.max_rss_kb; // Restored from the cache: keep what the compiler needed
+            }
+            QOL_BuildLogEntry *entries = (QOL_BuildLogEntry*)malloc((job->outputs.len + 1) * sizeof(QOL_BuildLogEntry));
+            if (!entries) abort();
+            for (size_t i = 0; i < job->outputs.len; i++) {
+                entries[i] = entry;
+                if (job->restat) qol_restat_output(job->outputs.data[i], &entries[i]);
+            }
+            if (job->cache_entry && job->outputs.len > 0) qol_cache_store(job->outputs.data[0], job->cache_entry);
+            if (job->depfile) qol_deps_ingest(job->outputs.data[0], job->depfile);
+            for (size_t i = 0; i < job->outputs.len; i++) {
+                qol_build_log_record(job->outputs.data[i], &entries[i]);
+            }
+            free(entries);
+        }
+        qol_job_release(job);
+        if (job->on_exit) job->on_exit(job->proc, success, job->user);
+    }
+
+    static void qol_job_start(QOL_Job *job) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        if (job->capturing) qol_capture_open += 2;
+        if (job->pool && !job->charged) { // Later stages of a job keep what its first one charged
+            qol_pools.data[job->pool - 1].used += job->weight;
+            job->charged = true;
+        }
+        qol_push(&qol_jobs, *job);
+        qol_live_jobs++;
+        qol_interrupt_install();
+#ifndef WINDOWS
+        for (size_t i = 0; i < QOL_SIGNAL_SLOTS; i++) {
+            if (qol_signal_slots[i] == 0) {
+                qol_signal_slots[i] = job->group ? -job->proc : job->proc;
+                break;
+            }
+        }
+#endif
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+    }
+
+    static bool qol_cache_continue(QOL_Job *job, bool preprocessed, QOL_Proc *next);
+
+    // Report a reaped process to the job table. Returns success, or false if the job was killed
+    // (timeout, cancellation) even though it managed to exit cleanly. If the process was the first
+    // stage of a job and next is given, the job goes on with the process stored in next (caller
+    // waits for it instead); a NULL next ends the job here.
+    static bool qol_job_finish(QOL_Proc proc, bool success, const QOL_ProcResult *usage, QOL_Proc *next) {
+        if (next) *next = QOL_INVALID_PROC;
+        qol_trace_reaped(proc, success);
+#if defined(LINUX) && defined(SYS_pidfd_open)
+        qol_poll_forget(proc);
+#endif
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        QOL_Job job = {0};
+        bool found = false;
+        for (size_t i = 0; i < qol_jobs.len; i++) {
+            if (qol_jobs.data[i].proc == proc) {
+                job = qol_jobs.data[i];
+                qol_swap(&qol_jobs, i);
+                qol_jobs.len--;
+                qol_live_jobs--;
+                qol_interrupt_restore();
+                found = true;
+                break;
+            }
+        }
+#ifndef WINDOWS
+        for (size_t i = 0; found && i < QOL_SIGNAL_SLOTS; i++) {
+            if (qol_signal_slots[i] == proc || qol_signal_slots[i] == -proc) {
+                qol_signal_slots[i] = 0;
+                break;
+            }
+        }
+#endif
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        if (!found) {
+            if (!success) qol_proc_log_failure(usage);
+            qol_stat_invalidate(NULL); // A plain process without bookkeeping: it may have written anything
+            return success;
+        }
+        if (job.kill_stage) success = false;
+        if (next && job.cache_compile.len > 0 && !job.kill_stage) {
+            // Preprocessor of a cached compile: restore the object or start the compiler
+            success = qol_cache_continue(&job, success, next);
+            if (*next != QOL_INVALID_PROC) {
+                job.proc = *next;
+                qol_job_start(&job);
+                return true;
+            }
+            usage = NULL;
+        }
+        qol_job_done(&job, success, usage);
+        return success;
+    }
+
+#ifndef WINDOWS
+    // Pipe whose ends are close-on-exec from the start: other children must not inherit a write
+    // end, or its reader never sees EOF. Only pipe2() closes the window in which a spawn from another
+    // thread could; elsewhere the flags are set right after pipe().
+    static int qol_pipe_cloexec(int fds[2]) {
+#if defined(LINUX) && defined(SYS_pipe2)
+        return (int)syscall(SYS_pipe2, fds, O_CLOEXEC);
+#else
+        if (pipe(fds) != 0) return -1;
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+        return 0;
+#endif
+    }
+#endif
+
+    // Launch cmd for job. With capture its stdout and stderr go through pipes that the wait
+    // functions drain into the job's buffers; without it (and on Windows) the child inherits the terminal.
+    static QOL_Proc qol_job_spawn(QOL_Cmd* cmd, QOL_Job *job, bool capture, size_t capture_max) {
+#ifdef WINDOWS
+        (void)capture; (void)capture_max;
+        return qol_cmd_spawn(cmd, -1, -1, job->group);
+#else
+        int out[2], err[2];
+        if (!capture || qol_pipe_cloexec(out) != 0) return qol_cmd_spawn(cmd, -1, -1, job->group);
+        if (qol_pipe_cloexec(err) != 0) {
+            close(out[0]);
+            close(out[1]);
+            return qol_cmd_spawn(cmd, -1, -1, job->group);
+        }
+        // Only the read ends: the child gets the write ends as its (blocking) stdout and stderr
+        fcntl(out[0], F_SETFL, fcntl(out[0], F_GETFL) | O_NONBLOCK);
+        fcntl(err[0], F_SETFL, fcntl(err[0], F_GETFL) | O_NONBLOCK);
+
+        QOL_Proc proc = qol_cmd_spawn(cmd, out[1], err[1], job->group);
+        close(out[1]);
+        close(err[1]);
+        if (proc == QOL_INVALID_PROC) {
+            close(out[0]);
+            close(err[0]);
+            return proc;
+        }
+        job->capturing = true;
+        job->capture[0].fd = out[0];
+        job->capture[1].fd = err[0];
+        job->capture_max = capture_max ? capture_max : QOL_CAPTURE_MAX;
+        return proc;
+#endif
+    }
+
+    // Wait for proc and report it to the job table. next receives the process its job goes on with,
+    // if any (see qol_job_finish()).
+    static bool qol_proc_reap(QOL_Proc proc, QOL_Proc *next) {
+        *next = QOL_INVALID_PROC;
+        if (proc == QOL_INVALID_PROC) return false;
+
+#ifdef WINDOWS
+        DWORD result;
+        while ((result = WaitForSingleObject(proc, qol_wait_slice_ms())) == WAIT_TIMEOUT) qol_jobs_check_deadlines();
+        if (qol_interrupted) qol_interrupt_cleanup();
+        if (result == WAIT_FAILED) {
+            qol_log(QOL_LOG_ERRO, "Could not wait on child process: %s\n", qol_win32_error_message(GetLastError()));
+            CloseHandle(proc);
+            qol_job_finish(proc, false, NULL, NULL);
+            return false;
+        }
+
+        DWORD exit_code;
+        if (!GetExitCodeProcess(proc, &exit_code)) {
+            qol_log(QOL_LOG_ERRO, "Could not get process exit code: %s\n", qol_win32_error_message(GetLastError()));
+            CloseHandle(proc);
+            qol_job_finish(proc, false, NULL, NULL);
+            return false;
+        }
+
+        // CPU times come in 100ns units; peak memory is not reported without psapi
+        QOL_ProcResult usage = { .exit_code = (int)exit_code };
+        FILETIME created, exited, kernel, user;
+        if (GetProcessTimes(proc, &created, &exited, &kernel, &user)) {
+            usage.user_ms = (double)(((uint64_t)user.dwHighDateTime << 32) | user.dwLowDateTime) / 1e4;
+            usage.sys_ms = (double)(((uint64_t)kernel.dwHighDateTime << 32) | kernel.dwLowDateTime) / 1e4;
+        }
+        CloseHandle(proc);
+
+        return qol_job_finish(proc, exit_code == 0, &usage, next);
+#else
+        int wstatus;
+        struct rusage rusage;
+        // The child may already have been reaped by qol_procs_wait_any() on behalf of someone else
+        if (!qol_reaped_procs_take(proc, &wstatus, &rusage)) {
+            pid_t result;
+            while ((result = qol_waitpid_pumping(proc, &wstatus, &rusage)) < 0 && errno == EINTR) {}
+            if (result < 0) {
+                qol_log(QOL_LOG_ERRO, "Could not wait for process: %s\n", strerror(errno));
+                qol_job_finish(proc, false, NULL, NULL);
+                return false;
+            }
+        }
+
+        bool ok = qol_proc_check_status(wstatus);
+        QOL_ProcResult usage = qol_proc_result_from(wstatus, &rusage);
+        return qol_job_finish(proc, ok, &usage, next);
+#endif
+    }
+
+    QOLDEF bool qol_proc_wait(QOL_Proc proc) {
+        QOL_Proc next;
+        bool ok = qol_proc_reap(proc, &next);
+        while (next != QOL_INVALID_PROC) ok = qol_proc_reap(next, &next);
+        return ok;
+    }
+
+#ifndef WINDOWS
+    static size_t qol_workers_pending(const QOL_Procs *owner);
+    static size_t qol_workers_collect(const QOL_Procs *owner, int timeout_ms);
+#endif
+
+    QOLDEF bool qol_procs_wait(QOL_Procs *procs) {
+        if (!procs) return false;
+#ifndef WINDOWS
+        while (qol_workers_pending(procs)) qol_workers_collect(procs, -1);
+#endif
+
+        bool all_success = procs->failed == 0 && !procs->cancelled;
+        // Fail fast needs to see failures in completion order, not after waiting for earlier pushes
+        while (procs->fail_fast && procs->len > 0) {
+            bool ok = false;
+            if (qol_procs_wait_any(procs, &ok) == QOL_INVALID_PROC) break;
+            if (!ok) all_success = false;
+        }
+        for (size_t i = 0; i < procs->len; i++) {
+            if (procs->data[i] != QOL_INVALID_PROC) {
+                if (!qol_proc_wait(procs->data[i])) {
+                    all_success = false;
+                }
+            }
+        }
+        procs->len = 0;
+        procs->failed = 0;
+        procs->cancelled = false;
+        return all_success;
+    }
+
+    QOLDEF void qol_procs_cancel(QOL_Procs *procs) {
+        if (!procs) return;
+        procs->cancelled = true;
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        for (size_t i = 0; i < qol_jobs.len; i++) {
+            QOL_Job *job = &qol_jobs.data[i];
+            if (job->kill_stage) continue;
+            for (size_t k = 0; k < procs->len; k++) {
+                if (procs->data[k] != job->proc) continue;
+#ifndef WINDOWS
+                // Already exited but not reaped yet: it finished on its own, keep its outputs
+                siginfo_t info;
+                memset(&info, 0, sizeof(info));
+                if (waitid(P_PID, (id_t)job->proc, &info, WEXITED | WNOHANG | WNOWAIT) == 0 && info.si_pid != 0) break;
+#endif
+                qol_job_kill(job, false);
+                break;
+            }
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+    }
+
+    // fail_fast: the first failure reaped from procs cancels the rest
+    static void qol_procs_reaped(QOL_Procs *procs, bool ok) {
+        if (ok || !procs->fail_fast || procs->cancelled) return;
+        if (procs->len > 0) qol_log(QOL_LOG_ERRO, "Cancelling %zu running command%s\n", procs->len, procs->len == 1 ? "" : "s");
+        qol_procs_cancel(procs);
+    }
+
+    // The job of a reaped process went on with next: wait for that one instead
+    static void qol_procs_continue(QOL_Procs *procs, QOL_Proc next) {
+        qol_push(procs, next);
+        if (procs->cancelled) qol_procs_cancel(procs); // Cancelled while the first stage ran
+    }
+
+#ifndef WINDOWS
+    static void qol_procs_poll_sleep(QOL_Procs *procs, int timeout_ms);
+    static void qol_procs_reap_foreign(const QOL_Procs *procs);
+#endif
+
+    QOLDEF QOL_Proc qol_procs_wait_any(QOL_Procs *procs, bool *success) {
+        if (success) *success = false;
+        if (!procs || procs->len == 0) return QOL_INVALID_PROC;
+
+#ifdef WINDOWS
+        for (;;) {
+            size_t index = 0;
+            DWORD result;
+            while ((result = qol_wait_handles(procs->data, procs->len, qol_wait_slice_ms(), &index)) == WAIT_TIMEOUT) qol_jobs_check_deadlines();
+            if (qol_interrupted) qol_interrupt_cleanup();
+            if (result != WAIT_OBJECT_0) {
+                qol_log(QOL_LOG_ERRO, "Could not wait on child processes: %s\n", qol_win32_error_message(GetLastError()));
+                return QOL_INVALID_PROC;
+            }
+
+            QOL_Proc proc = procs->data[index];
+            qol_dropn(procs, index);
+            QOL_Proc next;
+            bool ok = qol_proc_reap(proc, &next); // Already signaled: collects the exit code and closes the handle
+            if (next != QOL_INVALID_PROC) {
+                qol_procs_continue(procs, next);
+                continue;
+            }
+            qol_procs_reaped(procs, ok);
+            if (success) *success = ok;
+            return proc;
+        }
+#else
+        for (;;) {
+            if (qol_interrupted) qol_interrupt_cleanup();
+            // Exited children of other arrays keep the shared epoll set readable: stash them, or
+            // every sleep below would return right away
+            qol_procs_reap_foreign(procs);
+            // Only our own children: another Procs array or a plain qol_proc_wait() caller keeps
+            // the rest (one of ours may also have been reaped by a poll on someone else's behalf)
+            bool continued = false; // A job went on with another process: scan again right away
+            for (size_t i = 0; i < procs->len && !continued; i++) {
+                QOL_Proc proc = procs->data[i];
+                int wstatus;
+                struct rusage rusage;
+                bool done = qol_reaped_procs_take(proc, &wstatus, &rusage);
+                if (!done) {
+                    pid_t pid = procs->len == 1 ? qol_waitpid_pumping(proc, &wstatus, &rusage) : wait4(proc, &wstatus, WNOHANG, &rusage);
+                    if (pid < 0 && errno != EINTR) {
+                        qol_log(QOL_LOG_ERRO, "Could not wait for process %d: %s\n", (int)proc, strerror(errno));
+                        qol_dropn(procs, i);
+                        qol_job_finish(proc, false, NULL, NULL);
+                        qol_procs_reaped(procs, false);
+                        return QOL_INVALID_PROC;
+                    }
+                    done = pid == proc;
+                }
+                if (!done) continue;
+                qol_dropn(procs, i);
+                bool ok = qol_proc_check_status(wstatus);
+                QOL_ProcResult usage = qol_proc_result_from(wstatus, &rusage);
+                QOL_Proc next;
+                ok = qol_job_finish(proc, ok, &usage, &next);
+                if (next != QOL_INVALID_PROC) {
+                    qol_procs_continue(procs, next);
+                    continued = true;
+                    continue;
+                }
+                qol_procs_reaped(procs, ok);
+                if (success) *success = ok;
+                return proc;
+            }
+            if (!continued && procs->len > 1) qol_procs_poll_sleep(procs, -1);
+        }
+#endif
+    }
+
+#ifndef WINDOWS
+    // Hand the reaped proc (its wait status) over to the job table and drop it from procs. Returns
+    // false if its job went on with another process (added to procs) instead of finishing.
+    static bool qol_procs_poll_reaped(QOL_Procs *procs, size_t index, int wstatus, const struct rusage *rusage) {
+        QOL_Proc proc = procs->data[index];
+        qol_dropn(procs, index);
+        bool ok = qol_proc_check_status(wstatus);
+        QOL_ProcResult usage = qol_proc_result_from(wstatus, rusage);
+        QOL_Proc next;
+        ok = qol_job_finish(proc, ok, &usage, &next);
+        if (next != QOL_INVALID_PROC) {
+            qol_procs_continue(procs, next);
+            return false;
+        }
+        if (!ok) procs->failed++;
+        qol_procs_reaped(procs, ok);
+        return true;
+    }
+
+    // Reap the children the shared epoll set reports as exited that procs does not track, parking
+    // their status for whoever waits on them. The processes of procs are left to the caller.
+    static void qol_procs_reap_foreign(const QOL_Procs *procs) {
+#if defined(LINUX) && defined(SYS_pidfd_open)
+        if (qol_poll_fallback || qol_poll_epoll < 0) return;
+        struct epoll_event events[64];
+        int count = epoll_wait(qol_poll_epoll, events, 64, 0);
+        for (int e = 0; e < count; e++) {
+            pid_t pid = (pid_t)events[e].data.u64;
+            size_t i = 0;
+            while (i < procs->len && procs->data[i] != pid) i++;
+            if (i < procs->len) continue;
+            int wstatus;
+            struct rusage rusage;
+            pid_t result = wait4(pid, &wstatus, WNOHANG, &rusage);
+            if (result == 0) continue;
+            if (result == pid) qol_reaped_procs_put(pid, wstatus, &rusage);
+            qol_poll_forget(pid); // Reaped elsewhere (ECHILD) or stashed
+        }
+#else
+        (void)procs;
+#endif
+    }
+
+    // Reap the processes of procs that can be collected right now (including those another waiter
+    // already reaped). Callbacks may add processes to procs meanwhile, so nothing is cached here.
+    static size_t qol_procs_poll_once(QOL_Procs *procs) {
+        size_t reaped = 0;
+        bool scan = true;
+#if defined(LINUX) && defined(SYS_pidfd_open)
+        if (!qol_poll_fallback) {
+            scan = false;
+            struct epoll_event events[64];
+            int count = qol_poll_epoll >= 0 ? epoll_wait(qol_poll_epoll, events, 64, 0) : 0;
+            for (int e = 0; e < count; e++) {
+                pid_t pid = (pid_t)events[e].data.u64;
+                int wstatus;
+                struct rusage rusage;
+                pid_t result = wait4(pid, &wstatus, WNOHANG, &rusage);
+                if (result == 0) continue;
+                if (result == pid) {
+                    size_t i = 0;
+                    while (i < procs->len && procs->data[i] != pid) i++;
+                    if (i < procs->len) {
+                        if (qol_procs_poll_reaped(procs, i, wstatus, &rusage)) reaped++;
+                        continue;
+                    }
+                    // Not tracked by this array: keep the status for whoever waits on it later
+                    qol_reaped_procs_put(pid, wstatus, &rusage);
+                }
+                qol_poll_forget(pid); // Reaped elsewhere (ECHILD) or stashed
+            }
+        }
+#endif
+        for (size_t i = 0; i < procs->len;) {
+            int wstatus;
+            struct rusage rusage;
+            bool done = qol_reaped_procs_take(procs->data[i], &wstatus, &rusage);
+            if (!done && scan) done = wait4(procs->data[i], &wstatus, WNOHANG, &rusage) == procs->data[i];
+            if (!done) {
+                i++;
+                continue;
+            }
+            if (qol_procs_poll_reaped(procs, i, wstatus, &rusage)) reaped++;
+        }
+        return reaped;
+    }
+
+    // Sleep until one of procs' processes may have exited or timeout_ms passed (-1 = no limit)
+    static void qol_procs_poll_sleep(QOL_Procs *procs, int timeout_ms) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        bool capturing = qol_capture_open > 0;
+        bool watched = qol_jobs_watched();
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        int slice = watched ? 5 : timeout_ms;
+        if (timeout_ms >= 0 && slice > timeout_ms) slice = timeout_ms;
+
+#if defined(LINUX) && defined(SYS_pidfd_open)
+        if (!qol_poll_fallback && qol_poll_epoll < 0) {
+            qol_poll_epoll = epoll_create1(EPOLL_CLOEXEC);
+            if (qol_poll_epoll < 0) qol_poll_fallback = true;
+        }
+        for (size_t i = 0; i < procs->len && !qol_poll_fallback; i++) {
+            QOL_MUTEX_LOCK(qol_exec_mutex);
+            bool known = false;
+            for (size_t j = 0; j < qol_poll_fds.len && !known; j++) known = qol_poll_fds.data[j].pid == procs->data[i];
+            if (!known) {
+                int fd = (int)syscall(SYS_pidfd_open, procs->data[i], 0);
+                struct epoll_event event = { .events = EPOLLIN, .data.u64 = (uint64_t)procs->data[i] };
+                if (fd >= 0 && fcntl(fd, F_SETFD, FD_CLOEXEC) == 0 && epoll_ctl(qol_poll_epoll, EPOLL_CTL_ADD, fd, &event) == 0) {
+                    QOL_PollFd entry = { .pid = procs->data[i], .fd = fd };
+                    qol_push(&qol_poll_fds, entry);
+                } else if (fd >= 0 || errno == ENOSYS || errno == EPERM) {
+                    if (fd >= 0) close(fd);
+                    qol_log(QOL_LOG_DIAG, "pidfd polling not available, scanning processes instead\n");
+                    qol_poll_fallback = true;
+                }
+                // ESRCH: the process is gone already, the scan collects it
+            }
+            QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        }
+        if (!qol_poll_fallback) {
+            // The epoll set is readable once a child exited: wait for it together with the
+            // capture pipes, so output is buffered as it comes without waking up in between
+            struct epoll_event event;
+            bool exited = capturing ? qol_capture_wait(slice, qol_poll_epoll) : epoll_wait(qol_poll_epoll, &event, 1, slice) > 0;
+            if (!exited) qol_jobs_check_deadlines();
+            return;
+        }
+#else
+        (void)procs;
+#endif
+        if (slice < 0 || slice > 5) slice = 5; // The scan has no way to be woken up
+        if (capturing) qol_capture_pump(slice);
+        else poll(NULL, 0, slice);
+        qol_jobs_check_deadlines();
+    }
+#endif
+
+    QOLDEF size_t qol_procs_poll(QOL_Procs *procs, int timeout_ms) {
+        if (!procs) return 0;
+        QOL_Timer timer = {0};
+        qol_timer_start(&timer);
+        for (;;) {
+            if (qol_interrupted) qol_interrupt_cleanup();
+            size_t reaped = 0;
+            bool requests = false; // Worker requests in flight (POSIX only)
+#ifdef WINDOWS
+            for (size_t i = 0; i < procs->len;) {
+                if (WaitForSingleObject(procs->data[i], 0) != WAIT_OBJECT_0) {
+                    i++;
+                    continue;
+                }
+                QOL_Proc proc = procs->data[i];
+                qol_dropn(procs, i);
+                bool ok = qol_proc_wait(proc); // Already signaled: collects the exit code and closes the handle
+                if (!ok) procs->failed++;
+                qol_procs_reaped(procs, ok);
+                reaped++;
+            }
+#else
+            reaped = qol_workers_collect(procs, 0) + qol_procs_poll_once(procs);
+            requests = qol_workers_pending(procs) > 0;
+#endif
+            if (reaped > 0 || timeout_ms == 0 || (procs->len == 0 && !requests)) return reaped;
+            int remaining = -1;
+            if (timeout_ms > 0) {
+                uint64_t elapsed = qol_timer_elapsed_ns(&timer) / 1000000;
+                if (elapsed >= (uint64_t)timeout_ms) return 0;
+                remaining = timeout_ms - (int)elapsed;
+            }
+#ifdef WINDOWS
+            DWORD slice = qol_wait_slice_ms();
+            if (remaining >= 0 && (DWORD)remaining < slice) slice = (DWORD)remaining;
+            size_t index;
+            if (qol_wait_handles(procs->data, procs->len, slice, &index) == WAIT_TIMEOUT) qol_jobs_check_deadlines();
+#else
+            if (requests && procs->len == 0) {
+                reaped = qol_workers_collect(procs, remaining); // Only worker requests left: sleep on their sockets
+                if (reaped > 0) return reaped;
+                continue;
+            }
+            qol_procs_poll_sleep(procs, requests && (remaining < 0 || remaining > 5) ? 5 : remaining);
+#endif
+        }
+    }
+
+    static int qol_proc_result_compare_rss(const void *a, const void *b) {
+        const QOL_ProcResult *x = *(const QOL_ProcResult* const*)a, *y = *(const QOL_ProcResult* const*)b;
+        return x->max_rss_kb < y->max_rss_kb ? 1 : x->max_rss_kb > y->max_rss_kb ? -1 : 0;
+    }
+
+    QOLDEF void qol_proc_results_report(const QOL_ProcResults *results, size_t top) {
+        if (!results || results->len == 0) return;
+        const QOL_ProcResult **sorted = (const QOL_ProcResult**)malloc(results->len * sizeof(QOL_ProcResult*));
+        if (!sorted) return;
+        for (size_t i = 0; i < results->len; i++) sorted[i] = &results->data[i];
+        qsort(sorted, results->len, sizeof(QOL_ProcResult*), qol_proc_result_compare_rss);
+
+        size_t rows = top == 0 || top > results->len ? results->len : top;
+        double wall = 0, user = 0, sys = 0;
+        size_t peak = 0, failed = 0;
+        for (size_t i = 0; i < results->len; i++) {
+            wall += results->data[i].wall_ms;
+            user += results->data[i].user_ms;
+            sys += results->data[i].sys_ms;
+            if (results->data[i].max_rss_kb > peak) peak = results->data[i].max_rss_kb;
+            if (results->data[i].exit_code != 0) failed++;
+        }
+
+        qol_log(QOL_LOG_INFO, "%10s %10s %10s %10s %6s  %s\n", "wall ms", "user ms", "sys ms", "max rss", "exit", "command");
+        for (size_t i = 0; i < rows; i++) {
+            const QOL_ProcResult *r = sorted[i];
+            qol_log(QOL_LOG_INFO, "%10.1f %10.1f %10.1f %7zu MiB %6d  %s\n", r->wall_ms, r->user_ms, r->sys_ms,
+                    r->max_rss_kb / 1024, r->signal ? -r->signal : r->exit_code, r->name ? r->name : "?");
+        }
+        qol_log(QOL_LOG_INFO, "%zu commands (%zu failed): %.1f ms wall, %.1f ms user, %.1f ms sys, peak rss %zu MiB\n",
+                results->len, failed, wall, user, sys, peak / 1024);
+        free(sorted);
+    }
+
+    QOLDEF void qol_proc_results_release(QOL_ProcResults *results) {
+        if (!results) return;
+        for (size_t i = 0; i < results->len; i++) free(results->data[i].name);
+        qol_release(results);
+    }
+
+    QOLDEF size_t qol_nprocs(void) {
+#ifdef WINDOWS
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return info.dwNumberOfProcessors > 0 ? (size_t)info.dwNumberOfProcessors : 1;
+#else
+        long n = sysconf(_SC_NPROCESSORS_ONLN);
+        return n > 0 ? (size_t)n : 1;
+#endif
+    }
+
+    //////////////////////////////////////////////////
+    /// DEPS_LOG /////////////////////////////////////
+    //////////////////////////////////////////////////
+
+    // On-disk layout of the deps log (native byte order):
+    //   header:      "QOLDEPS\0" + u32 version
+    //   path record: u32 size (high bit clear) + path bytes           -> path id = order of appearance
+    //   deps record: u32 size | 0x80000000 + u32 output id + i64 output mtime + u32 dependency ids...
+    // Later deps records for the same output supersede earlier ones.
+    #define QOL_DEPS_LOG_MAGIC "QOLDEPS"
+    #define QOL_DEPS_LOG_VERSION 1
+    #define QOL_DEPS_RECORD_DEPS 0x80000000u
+
+    typedef struct {
+        int64_t mtime;      // Modification time of the output when the dependencies were recorded
+        uint32_t *ids;      // Path ids of the dependencies
+        uint32_t count;     // Number of dependencies (valid only if ids or recorded)
+        bool recorded;      // True if this path is an output with a deps record
+    } QOL_DepsEntry;
+
+    static struct {
+        bool loaded;                         // Log was read from disk (or found missing)
+        QOL_HashMap *ids;                    // Path -> id + 1
+        qol_list(char*) paths;               // Id -> path
+        qol_list(QOL_DepsEntry) entries;     // Id -> deps record (only outputs are recorded)
+        size_t records;                      // Number of deps records in the file (for compaction)
+        size_t live;                         // Number of outputs with a record
+    } qol_deps_log = {0};
+
+    static char qol_deps_log_path[QOL_PATH_BUFFER_SIZE] = {0}; // Set by qol_deps_log_open(), empty = QOL_DEPS_LOG_PATH
+
+    static const char *qol_deps_log_file(void) {
+        return qol_deps_log_path[0] ? qol_deps_log_path : QOL_DEPS_LOG_PATH;
+    }
+
+    static uint32_t qol_deps_path_id(const char *path, bool *is_new) {
+        uintptr_t id = (uintptr_t)qol_hm_get(qol_deps_log.ids, (void*)path);
+        if (is_new) *is_new = id == 0;
+        if (id != 0) return (uint32_t)(id - 1);
+
+        char *copy = strdup(path);
+        if (!copy) abort();
+        qol_push(&qol_deps_log.paths, copy);
+        QOL_DepsEntry entry = {0};
+        qol_push(&qol_deps_log.entries, entry);
+        qol_hm_put(qol_deps_log.ids, copy, (void*)(uintptr_t)qol_deps_log.paths.len);
+        return (uint32_t)(qol_deps_log.paths.len - 1);
+    }
+
+    static void qol_deps_set(uint32_t out_id, int64_t mtime, uint32_t *ids, uint32_t count) {
+        QOL_DepsEntry *entry = &qol_deps_log.entries.data[out_id];
+        if (!entry->recorded) qol_deps_log.live++;
+        free(entry->ids);
+        entry->ids = ids;
+        entry->count = count;
+        entry->mtime = mtime;
+        entry->recorded = true;
+        qol_deps_log.records++;
+    }
+
+    static bool qol_deps_write_path(FILE *fp, const char *path) {
+        uint32_t size = (uint32_t)strlen(path);
+        return fwrite(&size, sizeof(size), 1, fp) == 1 && fwrite(path, 1, size, fp) == size;
+    }
+
+    static bool qol_deps_write_deps(FILE *fp, uint32_t out_id, const QOL_DepsEntry *entry) {
+        uint32_t size = (uint32_t)(sizeof(uint32_t) + sizeof(int64_t) + entry->count * sizeof(uint32_t));
+        uint32_t header = size | QOL_DEPS_RECORD_DEPS;
+        return fwrite(&header, sizeof(header), 1, fp) == 1 &&
+               fwrite(&out_id, sizeof(out_id), 1, fp) == 1 &&
+               fwrite(&entry->mtime, sizeof(entry->mtime), 1, fp) == 1 &&
+               fwrite(entry->ids, sizeof(uint32_t), entry->count, fp) == entry->count;
+    }
+
+    static bool qol_deps_write_header(FILE *fp) {
+        uint32_t version = QOL_DEPS_LOG_VERSION;
+        return fwrite(QOL_DEPS_LOG_MAGIC, 1, sizeof(QOL_DEPS_LOG_MAGIC), fp) == sizeof(QOL_DEPS_LOG_MAGIC) &&
+               fwrite(&version, sizeof(version), 1, fp) == 1;
+    }
+
+    // Rewrite the log with one record per output, dropping superseded records and a corrupt tail
+    static bool qol_deps_compact(void) {
+        char tmp_path[QOL_PATH_BUFFER_SIZE + 4];
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", qol_deps_log_file());
+        FILE *fp = fopen(tmp_path, "wb");
+        if (!fp) return false;
+        bool ok = qol_deps_write_header(fp);
+        for (size_t i = 0; ok && i < qol_deps_log.paths.len; i++) {
+            ok = qol_deps_write_path(fp, qol_deps_log.paths.data[i]);
+        }
+        for (size_t i = 0; ok && i < qol_deps_log.entries.len; i++) {
+            if (qol_deps_log.entries.data[i].recorded) ok = qol_deps_write_deps(fp, (uint32_t)i, &qol_deps_log.entries.data[i]);
+        }
+        ok = fclose(fp) == 0 && ok;
+        if (!ok || rename(tmp_path, qol_deps_log_file()) != 0) {
+            remove(tmp_path);
+            qol_log(QOL_LOG_WARN, "Could not compact deps log `%s`\n", qol_deps_log_file());
+            return false;
+        }
+        qol_deps_log.records = qol_deps_log.live;
+        return true;
+    }
+
+    // Load the deps log from disk once per process. Must be called with qol_deps_mutex held.
+    static void qol_deps_load(void) {
+        if (qol_deps_log.loaded) return;
+        qol_deps_log.loaded = true;
+        qol_deps_log.ids = qol_hm_create();
+        if (!qol_deps_log.ids) abort();
+
+        FILE *fp = fopen(qol_deps_log_file(), "rb");
+        if (!fp) return; // No log yet
+
+        char magic[sizeof(QOL_DEPS_LOG_MAGIC)];
+        uint32_t version = 0;
+        if (fread(magic, 1, sizeof(magic), fp) != sizeof(magic) || memcmp(magic, QOL_DEPS_LOG_MAGIC, sizeof(magic)) != 0 ||
+            fread(&version, sizeof(version), 1, fp) != 1 || version != QOL_DEPS_LOG_VERSION) {
+            fclose(fp);
+            qol_log(QOL_LOG_WARN, "Deps log `%s` has an unknown format, starting over\n", qol_deps_log_file());
+            remove(qol_deps_log_file());
+            return;
+        }
+
+        bool corrupt = false;
+        char path[QOL_PATH_BUFFER_SIZE];
+        uint32_t header;
+        while (fread(&header, sizeof(header), 1, fp) == 1) {
+            uint32_t size = header & ~QOL_DEPS_RECORD_DEPS;
+            if (header & QOL_DEPS_RECORD_DEPS) {
+                uint32_t out_id;
+                int64_t mtime;
+                if (size < sizeof(out_id) + sizeof(mtime) || fread(&out_id, sizeof(out_id), 1, fp) != 1 ||
+                    fread(&mtime, sizeof(mtime), 1, fp) != 1 || out_id >= qol_deps_log.paths.len) {
+                    corrupt = true;
+                    break;
+                }
+                uint32_t count = (uint32_t)((size - sizeof(out_id) - sizeof(mtime)) / sizeof(uint32_t));
+                uint32_t *ids = count ? (uint32_t*)malloc(count * sizeof(uint32_t)) : NULL;
+                if (count && (!ids || fread(ids, sizeof(uint32_t), count, fp) != count)) {
+                    free(ids);
+                    corrupt = true;
+                    break;
+                }
+                for (uint32_t i = 0; i < count; i++) {
+                    if (ids[i] >= qol_deps_log.paths.len) corrupt = true;
+                }
+                if (corrupt) {
+                    free(ids);
+                    break;
+                }
+                qol_deps_set(out_id, mtime, ids, count);
+            } else {
+                if (size == 0 || size >= sizeof(path) || fread(path, 1, size, fp) != size) {
+                    corrupt = true;
+                    break;
+                }
+                path[size] = '\0';
+                qol_deps_path_id(path, NULL);
+            }
+        }
+        fclose(fp);
+
+        // Drop a truncated tail (e.g. interrupted write) and squeeze out superseded records
+        if (corrupt || (qol_deps_log.records > 1000 && qol_deps_log.records > 3 * qol_deps_log.live)) {
+            if (corrupt) qol_log(QOL_LOG_WARN, "Deps log `%s` is corrupt, dropping the damaged tail\n", qol_deps_log_file());
+            qol_deps_compact();
+        }
+    }
+
+    QOLDEF bool qol_depfile_parse(const char *path, QOL_String *deps) {
+        if (!path || !deps) return false;
+
+        FILE *fp = fopen(path, "rb");
+        if (!fp) return false;
+        size_t cap = 4096, n = 0;
+        char *buf = (char*)malloc(cap);
+        size_t got;
+        while (buf && (got = fread(buf + n, 1, cap - n, fp)) > 0) {
+            n += got;
+            if (n == cap) {
+                cap *= 2;
+                char *tmp = (char*)realloc(buf, cap);
+                if (!tmp) { free(buf); buf = NULL; }
+                else buf = tmp;
+            }
+        }
+        fclose(fp);
+        if (!buf) return false;
+
+        char token[QOL_PATH_BUFFER_SIZE];
+        size_t len = 0;
+        bool in_deps = false; // Past the `target:` part of the rule
+        bool ok = true;
+        for (size_t i = 0; i <= n && ok; i++) {
+            char c = i < n ? buf[i] : '\n';
+            bool flush = false, end_of_rule = false;
+
+            if (c == '\\' && i + 1 < n && buf[i + 1] == '\n') {
+                i++;                                  // Line continuation
+                flush = true;
+            } else if (c == '\\' && i + 2 < n && buf[i + 1] == '\r' && buf[i + 2] == '\n') {
+                i += 2;                               // Line continuation (CRLF)
+                flush = true;
+            } else if (c == '\\' && i + 1 < n && (buf[i + 1] == ' ' || buf[i + 1] == '#')) {
+                c = buf[++i];                         // Escaped space or hash belongs to the path
+            } else if (c == '$' && i + 1 < n && buf[i + 1] == '$') {
+                i++;                                  // `$$` is a literal dollar sign
+            } else if (c == ':' && !in_deps && (i + 1 >= n || isspace((unsigned char)buf[i + 1]))) {
+                flush = true;                         // End of the targets (`C:\` drive letters are not followed by a space)
+            } else if (c == '\n') {
+                flush = true;
+                end_of_rule = in_deps;
+            } else if (isspace((unsigned char)c)) {
+                flush = true;
+            }
+
+            if (!flush) {
+                if (len + 1 >= sizeof(token)) {
+                    qol_log(QOL_LOG_WARN, "Path too long in depfile %s\n", path);
+                    ok = false;
+                    break;
+                }
+                token[len++] = c;
+                continue;
+            }
+
+            if (len > 0 && in_deps) {
+                token[len] = '\0';
+                char *dep = strdup(token);
+                if (!dep) { ok = false; break; }
+                qol_push(deps, dep);
+            }
+            len = 0;
+            if (c == ':' && !in_deps) in_deps = true;
+            if (end_of_rule) break; // Only the first rule carries the real dependencies
+        }
+
+        free(buf);
+        if (!ok) qol_release_string(deps);
+        return ok;
+    }
+
+    // Forget everything read from the deps log, so the next access reloads it from disk.
+    // Must be called with qol_deps_mutex held.
+    static void qol_deps_unload(void) {
+        for (size_t i = 0; i < qol_deps_log.entries.len; i++) free(qol_deps_log.entries.data[i].ids);
+        for (size_t i = 0; i < qol_deps_log.paths.len; i++) free(qol_deps_log.paths.data[i]);
+        qol_release(&qol_deps_log.entries);
+        qol_release(&qol_deps_log.paths);
+        qol_hm_release(qol_deps_log.ids);
+        memset(&qol_deps_log, 0, sizeof(qol_deps_log));
+    }
+
+    // Id of path, appending a path record for a path the log has not seen yet. The id is only
+    // handed out once the record is written, so ids in memory and on disk stay in step.
+    // Returns UINT32_MAX if the record could not be written.
+    static uint32_t qol_deps_intern(FILE *fp, const char *path) {
+        uintptr_t id = (uintptr_t)qol_hm_get(qol_deps_log.ids, (void*)path);
+        if (id != 0) return (uint32_t)(id - 1);
+        if (!qol_deps_write_path(fp, path)) return UINT32_MAX;
+        return qol_deps_path_id(path, NULL);
+    }
+
+    QOLDEF bool qol_deps_record(const char *output, const char **deps, size_t count) {
+        if (!output || (!deps && count > 0)) return false;
+
+        QOL_FileStat st; // Not through the stat cache: the output was just written
+        int64_t mtime = qol_stat_query(output, &st) ? st.mtime_ns : 0;
+
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_deps_mutex);
+        qol_deps_load();
+
+        FILE *fp = fopen(qol_deps_log_file(), "ab");
+        if (!fp) {
+            QOL_MUTEX_UNLOCK(qol_deps_mutex);
+            qol_log(QOL_LOG_ERRO, "Could not open deps log `%s`: %s\n", qol_deps_log_file(), strerror(errno));
+            return false;
+        }
+        bool ok = ftell(fp) > 0 || qol_deps_write_header(fp);
+
+        // Unknown paths get a path record first so the deps record can refer to their ids
+        uint32_t out_id = ok ? qol_deps_intern(fp, output) : UINT32_MAX;
+        ok = out_id != UINT32_MAX;
+        uint32_t *ids = count ? (uint32_t*)malloc(count * sizeof(uint32_t)) : NULL;
+        if (count && !ids) abort();
+        for (size_t i = 0; ok && i < count; i++) {
+            ids[i] = qol_deps_intern(fp, deps[i]);
+            ok = ids[i] != UINT32_MAX;
+        }
+
+        QOL_DepsEntry entry = { .mtime = mtime, .ids = ids, .count = (uint32_t)count };
+        if (ok) ok = qol_deps_write_deps(fp, out_id, &entry);
+        ok = fclose(fp) == 0 && ok;
+        if (ok) {
+            qol_deps_set(out_id, mtime, ids, (uint32_t)count);
+        } else {
+            free(ids);
+            qol_deps_unload(); // Buffered records may or may not have reached the file
+        }
+        QOL_MUTEX_UNLOCK(qol_deps_mutex);
+
+        if (!ok) qol_log(QOL_LOG_ERRO, "Could not write deps log `%s`\n", qol_deps_log_file());
+        return ok;
+    }
+
+    QOLDEF bool qol_deps_ingest(const char *output, const char *depfile) {
+        if (!output || !depfile) return false;
+        QOL_FileStat st; // Not through the stat cache: the compiler writes depfiles behind our back
+        if (!qol_stat_query(depfile, &st)) return false; // Nothing to ingest
+
+        QOL_String deps = {0};
+        if (!qol_depfile_parse(depfile, &deps)) {
+            qol_log(QOL_LOG_WARN, "Could not parse depfile %s\n", depfile);
+            return false;
+        }
+        bool ok = qol_deps_record(output, (const char**)deps.data, deps.len);
+        qol_release_string(&deps);
+        if (ok) {
+            remove(depfile); // The deps log is the source of truth from now on
+            qol_log(QOL_LOG_DIAG, "Ingested depfile %s\n", depfile);
+        } else {
+            qol_log(QOL_LOG_WARN, "Could not record the dependencies of %s, keeping depfile %s\n", output, depfile);
+        }
+        return ok;
+    }
+
+    // qol_deps_get() that also reports the mtime the output had when its dependencies were recorded
+    static bool qol_deps_lookup(const char *output, QOL_String *deps, int64_t *mtime) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_deps_mutex);
+        qol_deps_load();
+        uintptr_t id = (uintptr_t)qol_hm_get(qol_deps_log.ids, (void*)output);
+        bool found = id != 0 && qol_deps_log.entries.data[id - 1].recorded;
+        if (found) {
+            QOL_DepsEntry *entry = &qol_deps_log.entries.data[id - 1];
+            for (uint32_t i = 0; i < entry->count; i++) {
+                char *dep = strdup(qol_deps_log.paths.data[entry->ids[i]]);
+                if (!dep) abort();
+                qol_push(deps, dep);
+            }
+            if (mtime) *mtime = entry->mtime;
+        }
+        QOL_MUTEX_UNLOCK(qol_deps_mutex);
+        return found;
+    }
+
+    QOLDEF bool qol_deps_get(const char *output, QOL_String *deps) {
+        if (!output || !deps) return false;
+        return qol_deps_lookup(output, deps, NULL);
+    }
+
+    QOLDEF bool qol_deps_log_open(const char *path) {
+        if (path && strlen(path) >= sizeof(qol_deps_log_path)) {
+            qol_log(QOL_LOG_ERRO, "Deps log path too long: %s\n", path);
+            return false;
+        }
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_deps_mutex);
+        qol_deps_unload();
+        snprintf(qol_deps_log_path, sizeof(qol_deps_log_path), "%s", path ? path : "");
+        QOL_MUTEX_UNLOCK(qol_deps_mutex);
+        return true;
+    }
+
+    QOLDEF int qol_deps_check(const char *output) {
+        if (!output) return -1;
+        QOL_String deps = {0};
+        int64_t recorded_mtime;
+        if (!qol_deps_lookup(output, &deps, &recorded_mtime)) return -1;
+
+        int result = 0;
+        int64_t out_mtime, dep_mtime;
+        if (!qol_file_mtime_ns(output, &out_mtime)) {
+            result = 1;
+        } else if (recorded_mtime != 0 && out_mtime != recorded_mtime) {
+            // Rewritten since the record, by something that did not record its dependencies
+            qol_log(QOL_LOG_DIAG, "Dependencies of %s were recorded for an older build\n", output);
+            result = -1;
+        } else {
+            // Large sets are stat'ed in one batch; the results are used directly, as the stat
+            // cache only keeps them within a build
+            QOL_FileStat *stats = NULL;
+            if (deps.len >= QOL_STAT_BATCH_MIN) {
+                stats = (QOL_FileStat*)malloc(deps.len * sizeof(*stats));
+                if (!stats) abort();
+                qol_stat_batch((const char**)deps.data, deps.len, stats);
+            }
+            for (size_t i = 0; i < deps.len; i++) {
+                bool exists = stats ? qol_input_mtime_from(deps.data[i], &stats[i], &dep_mtime) : qol_input_mtime_ns(deps.data[i], &dep_mtime);
+                if (!exists) {
+                    qol_log(QOL_LOG_DIAG, "Dependency %s of %s is gone, rebuild needed\n", deps.data[i], output);
+                    result = 1;
+                    break;
+                }
+                if (dep_mtime > out_mtime) {
+                    qol_log(QOL_LOG_DIAG, "Dependency %s is newer than %s, rebuild needed\n", deps.data[i], output);
+                    result = 1;
+                    break;
+                }
+            }
+            free(stats);
+        }
+        qol_release_string(&deps);
+        return result;
+    }
+
+    //////////////////////////////////////////////////
+    /// BUILD_LOG ////////////////////////////////////
+    //////////////////////////////////////////////////
+
+    // Text format, one build per line preceded by a version line:
+    //   "<mtime ns>\t<duration ms>\t<max rss KiB>\t<restat mtime ns>\t<content hash>\t<argv hash>\t<output>\n"
+    // Lines are only ever appended; the newest line of an output wins. Older logs are read and
+    // rewritten in the current version: v1 lacks the max rss column, v2 the two restat columns.
+    #define QOL_BUILD_LOG_HEADER "# qol log v3\n"
+    #define QOL_BUILD_LOG_HEADER_V2 "# qol log v2\n"
+    #define QOL_BUILD_LOG_HEADER_V1 "# qol log v1\n"
+
+    static struct {
+        bool loaded;                              // Log was read from disk (or found missing)
+        QOL_HashMap *index;                       // Output -> index + 1 into entries/outputs
+        qol_list(QOL_BuildLogEntry) entries;      // Newest entry per output
+        qol_list(char*) outputs;                  // Output path of each entry
+        size_t records;                           // Lines in the file (for compaction)
+        size_t restats;                           // Entries with a restat mtime (none: inputs need no lookup)
+        FILE *fp;                                 // Append handle, opened on the first record
+        char path[QOL_PATH_BUFFER_SIZE];          // Set by qol_build_log_open(), empty = QOL_BUILD_LOG_PATH
+    } qol_build_log = {0};
+
+    static const char *qol_build_log_file(void) {
+        return qol_build_log.path[0] ? qol_build_log.path : QOL_BUILD_LOG_PATH;
+    }
+
+    QOLDEF uint64_t qol_hash_fnv1a(const void *data, size_t size, uint64_t hash) {
+        const unsigned char *bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++) {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ULL; // FNV-1a 64-bit prime
+        }
+        return hash;
+    }
+
+    QOLDEF uint64_t qol_cmd_hash(const QOL_Cmd *cmd) {
+        uint64_t hash = QOL_FNV1A_INIT;
+        if (!cmd) return hash;
+        for (size_t i = 0; i < cmd->len; i++) {
+            hash = qol_hash_fnv1a(cmd->data[i], strlen(cmd->data[i]) + 1, hash); // Include the NUL as separator
+        }
+        return hash;
+    }
+
+    static void qol_build_log_put(const char *output, QOL_BuildLogEntry entry) {
+        uintptr_t index = (uintptr_t)qol_hm_get(qol_build_log.index, (void*)output);
+        if (entry.restat_mtime != 0) qol_build_log.restats++;
+        if (index != 0) {
+            if (qol_build_log.entries.data[index - 1].restat_mtime != 0) qol_build_log.restats--;
+            qol_build_log.entries.data[index - 1] = entry;
+            return;
+        }
+        char *copy = strdup(output);
+        if (!copy) abort();
+        qol_push(&qol_build_log.outputs, copy);
+        qol_push(&qol_build_log.entries, entry);
+        qol_hm_put(qol_build_log.index, copy, (void*)(uintptr_t)qol_build_log.entries.len);
+    }
+
+    static bool qol_build_log_write_entry(FILE *fp, const char *output, const QOL_BuildLogEntry *entry) {
+        return fprintf(fp, "%lld\t%llu\t%llu\t%lld\t%llx\t%016llx\t%s\n", (long long)entry->mtime, (unsigned long long)entry->duration_ms,
+                       (unsigned long long)entry->max_rss_kb, (long long)entry->restat_mtime, (unsigned long long)entry->content_hash,
+                       (unsigned long long)entry->hash, output) > 0;
+    }
+
+    // Parse a hexadecimal field up to the next tab. Returns false on anything else.
+    static bool qol_build_log_parse_hex(const char **p, const char *eol, uint64_t *value) {
+        for (; *p < eol && **p != '\t'; (*p)++) {
+            char c = **p;
+            int digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+            if (digit < 0) return false;
+            *value = (*value << 4) | (uint64_t)digit;
+        }
+        return *p < eol && *(*p)++ == '\t';
+    }
+
+    // Parse the mapped log. Returns false if the header is wrong or the tail is damaged.
+    // Sets *outdated for older versions, which need a rewrite before anything is appended.
+    static bool qol_build_log_parse(const char *data, size_t size, bool *outdated) {
+        size_t header_len = sizeof(QOL_BUILD_LOG_HEADER) - 1; // Same length for all versions
+        if (size < header_len) return false;
+        int version = memcmp(data, QOL_BUILD_LOG_HEADER, header_len) == 0 ? 3 :
+                      memcmp(data, QOL_BUILD_LOG_HEADER_V2, header_len) == 0 ? 2 :
+                      memcmp(data, QOL_BUILD_LOG_HEADER_V1, header_len) == 0 ? 1 : 0;
+        if (version == 0) return false;
+        *outdated = version < 3;
+
+        char output[QOL_PATH_BUFFER_SIZE];
+        const char *p = data + header_len;
+        const char *end = data + size;
+        while (p < end) {
+            const char *eol = (const char*)memchr(p, '\n', (size_t)(end - p));
+            if (!eol) return false; // Interrupted append
+
+            // Fields are plain integers, parsed by hand: this loop runs once per target on every build
+            QOL_BuildLogEntry entry = {0};
+            bool negative = *p == '-';
+            if (negative) p++;
+            while (p < eol && *p >= '0' && *p <= '9') entry.mtime = entry.mtime * 10 + (*p++ - '0');
+            if (negative) entry.mtime = -entry.mtime;
+            if (p >= eol || *p++ != '\t') return false;
+            while (p < eol && *p >= '0' && *p <= '9') entry.duration_ms = entry.duration_ms * 10 + (uint64_t)(*p++ - '0');
+            if (p >= eol || *p++ != '\t') return false;
+            if (version >= 2) {
+                while (p < eol && *p >= '0' && *p <= '9') entry.max_rss_kb = entry.max_rss_kb * 10 + (uint64_t)(*p++ - '0');
+                if (p >= eol || *p++ != '\t') return false;
+            }
+            if (version >= 3) {
+                while (p < eol && *p >= '0' && *p <= '9') entry.restat_mtime = entry.restat_mtime * 10 + (*p++ - '0');
+                if (p >= eol || *p++ != '\t') return false;
+                if (!qol_build_log_parse_hex(&p, eol, &entry.content_hash)) return false;
+            }
+            if (!qol_build_log_parse_hex(&p, eol, &entry.hash)) return false;
+            size_t len = (size_t)(eol - p);
+            if (len == 0 || len >= sizeof(output)) return false;
+            memcpy(output, p, len);
+            output[len] = '\0';
+
+            qol_build_log_put(output, entry);
+            qol_build_log.records++;
+            p = eol + 1;
+        }
+        return true;
+    }
+
+    // Rewrite the log with only the newest line per output
+    static bool qol_build_log_compact(void) {
+        char tmp_path[QOL_PATH_BUFFER_SIZE + 8];
+        snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", qol_build_log_file());
+        FILE *fp = fopen(tmp_path, "wb");
+        if (!fp) return false;
+        bool ok = fputs(QOL_BUILD_LOG_HEADER, fp) >= 0;
+        for (size_t i = 0; ok && i < qol_build_log.entries.len; i++) {
+            ok = qol_build_log_write_entry(fp, qol_build_log.outputs.data[i], &qol_build_log.entries.data[i]);
+        }
+        ok = fclose(fp) == 0 && ok;
+        if (!ok || rename(tmp_path, qol_build_log_file()) != 0) {
+            remove(tmp_path);
+            qol_log(QOL_LOG_WARN, "Could not compact build log `%s`\n", qol_build_log_file());
+            return false;
+        }
+        qol_build_log.records = qol_build_log.entries.len;
+        return true;
+    }
+
+    // Map the build log into memory and index it, once per process. Must be called with qol_build_log_mutex held.
+    static void qol_build_log_load(void) {
+        if (qol_build_log.loaded) return;
+        qol_build_log.loaded = true;
+        qol_build_log.index = qol_hm_create();
+        if (!qol_build_log.index) abort();
+
+        bool valid = true, outdated = false;
+#if defined(WINDOWS)
+        HANDLE file = CreateFileA(qol_build_log_file(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (file == INVALID_HANDLE_VALUE) return; // No log yet
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            const char *data = mapping ? (const char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : NULL;
+            valid = data && qol_build_log_parse(data, (size_t)size.QuadPart, &outdated);
+            if (data) UnmapViewOfFile(data);
+            if (mapping) CloseHandle(mapping);
+        }
+        CloseHandle(file);
+#else
+        int fd = open(qol_build_log_file(), O_RDONLY);
+        if (fd < 0) return; // No log yet
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            void *data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            valid = data != MAP_FAILED && qol_build_log_parse((const char*)data, (size_t)st.st_size, &outdated);
+            if (data != MAP_FAILED) munmap(data, (size_t)st.st_size);
+        }
+        close(fd);
+#endif
+
+        // Drop a damaged tail (entries parsed so far are kept) and squeeze out superseded lines
+        if (!valid || outdated || (qol_build_log.records > 1000 && qol_build_log.records > 3 * qol_build_log.entries.len)) {
+            if (!valid) qol_log(QOL_LOG_WARN, "Build log `%s` is damaged, keeping %zu entries\n", qol_build_log_file(), qol_build_log.entries.len);
+            qol_build_log_compact();
+        }
+    }
+
+    QOLDEF bool qol_build_log_record(const char *output, const QOL_BuildLogEntry *record) {
+        if (!output || !record) return false;
+        QOL_BuildLogEntry entry = *record;
+        entry.mtime = 0;
+        qol_file_mtime_ns(output, &entry.mtime);
+
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_build_log_mutex);
+        qol_build_log_load();
+        if (!qol_build_log.fp) {
+            qol_build_log.fp = fopen(qol_build_log_file(), "ab");
+            if (qol_build_log.fp && ftell(qol_build_log.fp) == 0) fputs(QOL_BUILD_LOG_HEADER, qol_build_log.fp);
+        }
+        bool ok = qol_build_log.fp && qol_build_log_write_entry(qol_build_log.fp, output, &entry) &&
+                  fflush(qol_build_log.fp) == 0; // Keep the log consistent if the build is interrupted
+        qol_build_log_put(output, entry);
+        qol_build_log.records++;
+        if (!ok) qol_log(QOL_LOG_ERRO, "Could not write build log `%s`\n", qol_build_log_file());
+        QOL_MUTEX_UNLOCK(qol_build_log_mutex);
+        return ok;
+    }
+
+    QOLDEF bool qol_build_log_open(const char *path) {
+        if (path && strlen(path) >= sizeof(qol_build_log.path)) {
+            qol_log(QOL_LOG_ERRO, "Build log path too long: %s\n", path);
+            return false;
+        }
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_build_log_mutex);
+        if (qol_build_log.fp) fclose(qol_build_log.fp);
+        for (size_t i = 0; i < qol_build_log.outputs.len; i++) free(qol_build_log.outputs.data[i]);
+        qol_release(&qol_build_log.outputs);
+        qol_release(&qol_build_log.entries);
+        qol_hm_release(qol_build_log.index);
+        memset(&qol_build_log, 0, sizeof(qol_build_log));
+        if (path) snprintf(qol_build_log.path, sizeof(qol_build_log.path), "%s", path);
+        QOL_MUTEX_UNLOCK(qol_build_log_mutex);
+        return true;
+    }
+
+    QOLDEF bool qol_build_log_get(const char *output, QOL_BuildLogEntry *entry) {
+        if (!output || !entry) return false;
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_build_log_mutex);
+        qol_build_log_load();
+        uintptr_t index = (uintptr_t)qol_hm_get(qol_build_log.index, (void*)output);
+        if (index != 0) *entry = qol_build_log.entries.data[index - 1];
+        QOL_MUTEX_UNLOCK(qol_build_log_mutex);
+        return index != 0;
+    }
+
+    static bool qol_input_mtime_ns(const char *path, int64_t *mtime) {
+        QOL_FileStat st;
+        qol_stat_cached(path, &st);
+        return qol_input_mtime_from(path, &st, mtime);
+    }
+
+    static bool qol_input_mtime_from(const char *path, const QOL_FileStat *st, int64_t *mtime) {
+        if (!st->exists) return false;
+        *mtime = st->mtime_ns;
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_build_log_mutex);
+        qol_build_log_load();
+        if (qol_build_log.restats > 0) {
+            // Untouched since a restat run that found its content unchanged
+            uintptr_t index = (uintptr_t)qol_hm_get(qol_build_log.index, (void*)path);
+            const QOL_BuildLogEntry *entry = index != 0 ? &qol_build_log.entries.data[index - 1] : NULL;
+            if (entry && entry->restat_mtime != 0 && entry->restat_mtime < *mtime && entry->mtime == *mtime) *mtime = entry->restat_mtime;
+        }
+        QOL_MUTEX_UNLOCK(qol_build_log_mutex);
+        return true;
+    }
+
+    // Restat: Record the content hash of a freshly built output. If the last build of the same
+    // output produced identical content, the build log keeps the time its content last changed
+    // (entry->restat_mtime), which qol_input_mtime_ns() reports to everything downstream. The file
+    // itself keeps the mtime the command gave it, so it is current for its own rebuild check.
+    static void qol_restat_output(const char *output, QOL_BuildLogEntry *entry) {
+        uint64_t hash;
+        if (!qol_hash_file(output, &hash)) return;
+        entry->content_hash = hash;
+        QOL_BuildLogEntry previous;
+        if (!qol_build_log_get(output, &previous) || previous.content_hash != hash || previous.mtime == 0) return;
+        int64_t mtime;
+        if (!qol_file_mtime_ns(output, &mtime) || mtime == previous.mtime) return; // Not rewritten at all
+        bool earlier = previous.restat_mtime != 0 && previous.restat_mtime < previous.mtime;
+        entry->restat_mtime = earlier ? previous.restat_mtime : previous.mtime;
+        qol_log(QOL_LOG_DIAG, "Restat: %s did not change, keeping its timestamp in the build log\n", output);
+    }
+
+    // True if the build log has no record of output or the command line changed since
+    static bool qol_build_log_cmd_changed(const char *output, uint64_t hash) {
+        QOL_BuildLogEntry entry;
+        if (!qol_build_log_get(output, &entry)) {
+            qol_log(QOL_LOG_DIAG, "No build log entry for %s, rebuild needed\n", output);
+            return true;
+        }
+        if (entry.hash != hash) {
+            qol_log(QOL_LOG_DIAG, "Command line of %s changed, rebuild needed\n", output);
+            return true;
+        }
+        return false;
+    }
+
+    //////////////////////////////////////////////////
+    /// COMPILE_CACHE ////////////////////////////////
+    //////////////////////////////////////////////////
+
+#if defined(LINUX)
+    #define QOL_FICLONE _IOW(0x94, 9, int) // FICLONE from <linux/fs.h>, spelled out to avoid the kernel header
+#endif
+
+    static QOL_CacheStats qol_cache_counters = {0};
+    static bool qol_cache_atexit_registered = false;
+
+    QOLDEF QOL_CacheStats qol_cache_stats(void) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_cache_mutex);
+        QOL_CacheStats stats = qol_cache_counters;
+        QOL_MUTEX_UNLOCK(qol_cache_mutex);
+        return stats;
+    }
+
+    static const char *qol_cache_dir(void) {
+        const char *dir = getenv("QOL_CACHE_DIR");
+        return dir && *dir ? dir : QOL_CACHE_DIR;
+    }
+
+    // Clone src to dst: reflink (shares blocks, copy-on-write) where supported, plain copy otherwise.
+    // Writes through a temporary file so that dst never appears half written.
+    static bool qol_cache_clone(const char *src, const char *dst) {
+        char tmp[QOL_PATH_BUFFER_SIZE];
+#if defined(WINDOWS)
+        snprintf(tmp, sizeof(tmp), "%s.%lu.tmp", dst, (unsigned long)GetCurrentProcessId());
+        if (!CopyFileA(src, tmp, FALSE)) return false;
+#else
+        snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", dst, (long)getpid());
+        int in = open(src, O_RDONLY);
+        if (in < 0) return false;
+        int out = open(tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (out < 0) {
+            close(in);
+            return false;
+        }
+        bool ok = false;
+    #if defined(LINUX)
+        ok = ioctl(out, QOL_FICLONE, in) == 0; // btrfs, xfs, bcachefs, ...
+    #endif
+        if (!ok) {
+            char buffer[64 * 1024];
+            ssize_t n;
+            ok = true;
+            while (ok && (n = read(in, buffer, sizeof(buffer))) != 0) {
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    ok = false;
+                    break;
+                }
+                ok = write(out, buffer, (size_t)n) == n;
+            }
+        }
+        close(in);
+        if (close(out) != 0) ok = false;
+        if (!ok) {
+            remove(tmp);
+            return false;
+        }
+#endif
+#if defined(WINDOWS)
+        remove(dst); // rename() does not replace on Windows
+#endif
+        if (rename(tmp, dst) != 0) {
+            remove(tmp);
+            return false;
+        }
+        return true;
+    }
+
+    // Program identity: resolved binary path, size and mtime (a compiler upgrade changes the key)
+    static uint64_t qol_cache_hash_compiler(const char *compiler, uint64_t hash) {
+        char path[QOL_PATH_BUFFER_SIZE];
+        snprintf(path, sizeof(path), "%s", compiler);
+#if defined(WINDOWS)
+        SearchPathA(NULL, compiler, ".exe", sizeof(path), path, NULL);
+#else
+        const char *env = getenv("PATH");
+        if (!strchr(compiler, '/') && env) {
+            while (*env) {
+                const char *sep = strchr(env, ':');
+                size_t len = sep ? (size_t)(sep - env) : strlen(env);
+                snprintf(path, sizeof(path), "%.*s/%s", (int)len, len ? env : ".", compiler);
+                if (access(path, X_OK) == 0) break;
+                snprintf(path, sizeof(path), "%s", compiler);
+                env += len + (sep ? 1 : 0);
+            }
+        }
+#endif
+        QOL_FileStat st;
+        qol_stat_cached(path, &st); // Zeroed if the compiler was not found
+        hash = qol_hash_fnv1a(path, strlen(path) + 1, hash);
+        hash = qol_hash_fnv1a(&st.size, sizeof(st.size), hash);
+        return qol_hash_fnv1a(&st.mtime_ns, sizeof(st.mtime_ns), hash);
+    }
+
+    static size_t qol_cache_evict_lru(const char *dir, const char *suffix, uint64_t max_size);
+
+    // Read a memoized output: the whole file plus a terminating '\0'. NULL if there is none.
+    static char *qol_memo_load(const char *path, size_t *size) {
+        FILE *fp = fopen(path, "rb");
+        if (!fp) return NULL;
+        char *data = NULL;
+        size_t len = 0, cap = 0, n;
+        char buffer[4096];
+        while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+            if (len + n + 1 > cap) {
+                cap = (len + n + 1) * 2;
+                data = (char*)realloc(data, cap);
+                if (!data) abort();
+            }
+            memcpy(data + len, buffer, n);
+            len += n;
+        }
+        fclose(fp);
+        if (!data) data = (char*)calloc(1, 1); // Empty output is a valid answer
+        if (!data) abort();
+        data[len] = '\0';
+        if (size) *size = len;
+        return data;
+    }
+
+    QOLDEF char *qol_cmd_memo_impl(QOL_Cmd *cmd, QOL_MemoOptions opts) {
+        if (!cmd || !cmd->data || cmd->len == 0) {
+            qol_log(QOL_LOG_ERRO, "Invalid command: empty or null\n");
+            if (cmd) qol_release(cmd);
+            return NULL;
+        }
+
+        // Key: argv, program identity, environment, input mtimes (names are hashed with the values,
+        // an unset variable differs from an empty one)
+        static const char *default_env[] = { QOL_MEMO_ENV, NULL };
+        const char **env = opts.env ? opts.env : default_env;
+        uint64_t hash = qol_cache_hash_compiler(cmd->data[0], qol_cmd_hash(cmd));
+        for (size_t i = 0; env[i]; i++) {
+            const char *value = getenv(env[i]);
+            hash = qol_hash_fnv1a(env[i], strlen(env[i]) + 1, hash);
+            hash = qol_hash_fnv1a(value ? "=" : "!", 1, hash);
+            if (value) hash = qol_hash_fnv1a(value, strlen(value) + 1, hash);
+        }
+        for (size_t i = 0; opts.inputs && opts.inputs[i]; i++) {
+            QOL_FileStat st; // Not through the stat cache: the build script may have just written it
+            qol_stat_query(opts.inputs[i], &st); // Zeroed if missing, so appearing files change the key too
+            hash = qol_hash_fnv1a(opts.inputs[i], strlen(opts.inputs[i]) + 1, hash);
+            hash = qol_hash_fnv1a(&st.mtime_ns, sizeof(st.mtime_ns), hash);
+        }
+
+        char dir[QOL_PATH_BUFFER_SIZE], entry[QOL_PATH_BUFFER_SIZE], tmp[QOL_PATH_BUFFER_SIZE + 32];
+        snprintf(dir, sizeof(dir), "%s/memo", qol_cache_dir());
+        snprintf(entry, sizeof(entry), "%s/memo/%016llx.out", qol_cache_dir(), (unsigned long long)hash);
+        char *data = opts.refresh ? NULL : qol_memo_load(entry, opts.size);
+        if (data) {
+#if !defined(WINDOWS)
+            utime(entry, NULL); // Recently used: keeps the entry away from eviction
+#endif
+            qol_log(QOL_LOG_DIAG, "Memoized output of %s\n", cmd->data[0]);
+            qol_release(cmd);
+            return data;
+        }
+
+        // Miss: the child writes straight into a temporary file that becomes the entry on success
+        qol_mkdir_if_not_exists(qol_cache_dir());
+        qol_mkdir_if_not_exists(dir);
+#if defined(WINDOWS)
+        snprintf(tmp, sizeof(tmp), "%s.%lu.tmp", entry, (unsigned long)GetCurrentProcessId());
+        int fd = _open(tmp, _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY | _O_NOINHERIT, _S_IREAD | _S_IWRITE);
+#else
+        snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", entry, (long)getpid());
+        int fd = open(tmp, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+        if (fd < 0) {
+            qol_log(QOL_LOG_ERRO, "Could not create %s: %s\n", tmp, strerror(errno));
+            qol_release(cmd);
+            return NULL;
+        }
+        QOL_Proc proc = qol_cmd_spawn(cmd, fd, -1, false);
+#if defined(WINDOWS)
+        _close(fd);
+#else
+        close(fd);
+#endif
+        bool ok = proc != QOL_INVALID_PROC && qol_proc_wait(proc);
+#if defined(WINDOWS)
+        if (ok) ok = MoveFileExA(tmp, entry, MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        if (ok) ok = rename(tmp, entry) == 0;
+#endif
+        if (ok) {
+            data = qol_memo_load(entry, opts.size);
+            size_t evicted = qol_cache_evict_lru(dir, ".out", QOL_MEMO_MAX_SIZE);
+            if (evicted > 0) qol_log(QOL_LOG_DIAG, "Memo: evicted %zu entries\n", evicted);
+        } else {
+            remove(tmp);
+            if (opts.size) *opts.size = 0;
+        }
+        qol_release(cmd);
+        return data;
+    }
+
+    // Build the preprocessor run of a compile command (same flags, -E into preprocessed, which pp
+    // refers to) and the cache key of everything but its output; a -MMD depfile requested by the
+    // command is written by that run as well. Returns false if the command is not a cacheable
+    // single-source compile.
+    static bool qol_cache_preprocess_cmd(const QOL_Cmd *cmd, QOL_Cmd *pp, uint64_t *key, const char *preprocessed) {
+        bool compile = false;
+        for (size_t i = 1; i < cmd->len; i++) {
+            if (strcmp(cmd->data[i], "-c") == 0) compile = true;
+            if (strcmp(cmd->data[i], "-E") == 0 || strcmp(cmd->data[i], "-M") == 0 || strcmp(cmd->data[i], "-MM") == 0) return false;
+        }
+        if (!compile) return false;
+
+        // Hash argv without the paths that differ per checkout
+        uint64_t hash = qol_cache_hash_compiler(cmd->data[0], QOL_FNV1A_INIT);
+        for (size_t i = 0; i < cmd->len; i++) {
+            const char *arg = cmd->data[i];
+            if (strcmp(arg, "-o") == 0 && i + 1 < cmd->len) {
+                i++;
+                continue;
+            }
+            if (strcmp(arg, "-c") == 0) continue;
+            qol_push(pp, arg);
+            if (strcmp(arg, "-MF") == 0 && i + 1 < cmd->len) {
+                qol_push(pp, cmd->data[++i]);
+                continue;
+            }
+            if (strcmp(arg, "-MMD") == 0) continue;
+            hash = qol_hash_fnv1a(arg, strlen(arg) + 1, hash);
+        }
+        qol_push(pp, "-E", "-o", preprocessed);
+        *key = hash;
+        return true;
+    }
+
+    // Compute the cache entry path from the preprocessed text and the key of the command (see
+    // qol_cache_preprocess_cmd()). Returns false if the text cannot be read or the path is too long.
+    static bool qol_cache_entry_for(const char *preprocessed, uint64_t hash, char *entry, size_t size) {
+        FILE *fp = fopen(preprocessed, "rb");
+        if (!fp) return false;
+        char buffer[64 * 1024];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), fp)) > 0) hash = qol_hash_fnv1a(buffer, n, hash);
+        fclose(fp);
+
+        // Two-level layout keeps directories small: <dir>/ab/abcdef0123456789.o
+        const char *dir = qol_cache_dir();
+        char sub[QOL_PATH_BUFFER_SIZE];
+        int n_sub = snprintf(sub, sizeof(sub), "%s/%02x", dir, (unsigned)(hash >> 56));
+        int n_entry = snprintf(entry, size, "%s/%016llx.o", sub, (unsigned long long)hash);
+        if (n_sub < 0 || (size_t)n_sub >= sizeof(sub) || n_entry < 0 || (size_t)n_entry >= size) {
+            qol_log(QOL_LOG_WARN, "Compile cache path under `%s` is too long, not caching\n", dir);
+            return false;
+        }
+        qol_mkdir_if_not_exists(dir);
+        qol_mkdir_if_not_exists(sub);
+        return true;
+    }
+
+    static bool qol_cache_restore(const char *entry, const char *output) {
+#if defined(QOL_CACHE_HARDLINK) && !defined(WINDOWS)
+        remove(output);
+        if (link(entry, output) == 0) {
+            utime(output, NULL); // Fresh mtime for the output; also marks the entry as recently used
+            return true;
+        }
+#endif
+        if (!qol_file_exists(entry) || !qol_cache_clone(entry, output)) return false;
+#if !defined(WINDOWS)
+        utime(entry, NULL); // Recently used: keeps the entry away from eviction
+#endif
+        return true;
+    }
+
+    static void qol_cache_store(const char *output, const char *entry) {
+        if (!qol_cache_clone(output, entry)) {
+            qol_log(QOL_LOG_WARN, "Could not store %s in the compile cache\n", output);
+            return;
+        }
+        QOL_MUTEX_LOCK(qol_cache_mutex);
+        qol_cache_counters.stores++;
+        QOL_MUTEX_UNLOCK(qol_cache_mutex);
+    }
+
+    typedef struct {
+        char *path;
+        int64_t mtime;
+        int64_t size;
+    } QOL_CacheFile;
+
+    static int qol_cache_file_compare(const void *a, const void *b) {
+        int64_t x = ((const QOL_CacheFile*)a)->mtime, y = ((const QOL_CacheFile*)b)->mtime;
+        return x < y ? -1 : x > y ? 1 : 0;
+    }
+
+    // Evict the least recently used files ending in suffix below dir until they take less than 90%
+    // of max_size. Returns the number of files removed.
+    static size_t qol_cache_evict_lru(const char *dir, const char *suffix, uint64_t max_size) {
+        QOL_String paths = {0};
+        if (!qol_read_dir_recursive(dir, &paths)) return 0;
+        qol_list(QOL_CacheFile) files = {0};
+        uint64_t total = 0;
+        for (size_t i = 0; i < paths.len; i++) {
+            QOL_FileStat st; // Not through the stat cache: every entry is looked at once
+            if (!qol_str_ends_with(paths.data[i], suffix) || !qol_stat_query(paths.data[i], &st)) continue;
+            QOL_CacheFile file = { .path = paths.data[i], .size = st.size, .mtime = st.mtime_ns };
+            qol_push(&files, file);
+            total += (uint64_t)file.size;
+        }
+        size_t evicted = 0;
+        if (total > max_size) {
+            qsort(files.data, files.len, sizeof(QOL_CacheFile), qol_cache_file_compare);
+            for (size_t i = 0; i < files.len && total > max_size / 10 * 9; i++) {
+                if (remove(files.data[i].path) == 0) {
+                    total -= (uint64_t)files.data[i].size;
+                    evicted++;
+                }
+            }
+        }
+        qol_release(&files);
+        qol_release_string(&paths);
+        return evicted;
+    }
+
+    static void qol_cache_evict(void) {
+        size_t evicted = qol_cache_evict_lru(qol_cache_dir(), ".o", QOL_CACHE_MAX_SIZE);
+        if (evicted > 0) qol_log(QOL_LOG_INFO, "Compile cache: evicted %zu entries\n", evicted);
+    }
+
+    static void qol_cache_report(void) {
+        QOL_CacheStats stats = qol_cache_stats();
+        size_t total = stats.hits + stats.misses;
+        if (total == 0) return;
+        if (stats.stores > 0) qol_cache_evict();
+        qol_log(QOL_LOG_INFO, "Compile cache: %zu hits, %zu misses (%.0f%% hit rate), %zu stored\n",
+                stats.hits, stats.misses, 100.0 * (double)stats.hits / (double)total, stats.stores);
+    }
+
+    static void qol_cache_count_skipped(void) {
+        QOL_MUTEX_LOCK(qol_cache_mutex);
+        qol_cache_counters.skipped++;
+        QOL_MUTEX_UNLOCK(qol_cache_mutex);
+    }
+
+    // Turn a cacheable compile into a two-stage job: config becomes the preprocessor run, the
+    // compile is kept in the job until qol_cache_continue() decided whether it is needed. The
+    // driver never waits for the preprocessor. Returns false (config untouched) if not cacheable.
+    static bool qol_cache_prepare(QOL_Cmd *config, QOL_Job *job, bool capture) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_cache_mutex);
+        if (!qol_cache_atexit_registered) {
+            qol_cache_atexit_registered = true;
+            atexit(qol_cache_report);
+        }
+        QOL_MUTEX_UNLOCK(qol_cache_mutex);
+
+        // Preprocess into a scratch file next to the output
+        const char *output = job->outputs.len > 0 ? job->outputs.data[0] : NULL;
+        size_t size = output ? strlen(output) + sizeof(".qol.i") : 0;
+        char *preprocessed = output ? (char*)malloc(size) : NULL;
+        if (output && !preprocessed) abort();
+        if (preprocessed) snprintf(preprocessed, size, "%s.qol.i", output);
+        QOL_Cmd pp = {0};
+        if (!preprocessed || !qol_cache_preprocess_cmd(config, &pp, &job->cache_key, preprocessed)) {
+            qol_release(&pp);
+            free(preprocessed);
+            qol_cache_count_skipped();
+            return false;
+        }
+        job->cache_preprocessed = preprocessed; // Owned by the job from now on, pp refers to it
+        job->cache_compile = *config;
+        job->cache_capture = capture;
+        *config = pp;
+        return true;
+    }
+
+    // Second stage of a cached compile, once its preprocessor was reaped: restore the object on a
+    // hit, start the compiler (told where to store the object) on a miss or if preprocessing
+    // failed. next receives the compiler process, QOL_INVALID_PROC if none runs. Returns false if
+    // it could not be started.
+    static bool qol_cache_continue(QOL_Job *job, bool preprocessed, QOL_Proc *next) {
+        *next = QOL_INVALID_PROC;
+        QOL_Cmd compile = job->cache_compile;
+        memset(&job->cache_compile, 0, sizeof(job->cache_compile));
+        char entry[QOL_PATH_BUFFER_SIZE];
+        bool cacheable = preprocessed && qol_cache_entry_for(job->cache_preprocessed, job->cache_key, entry, sizeof(entry));
+        remove(job->cache_preprocessed);
+        free(job->cache_preprocessed);
+        job->cache_preprocessed = NULL;
+
+        const char *output = job->outputs.data[0];
+        if (!cacheable) {
+            qol_cache_count_skipped();
+        } else {
+            bool hit = qol_cache_restore(entry, output);
+            QOL_MUTEX_LOCK(qol_cache_mutex);
+            if (hit) qol_cache_counters.hits++;
+            else qol_cache_counters.misses++;
+            QOL_MUTEX_UNLOCK(qol_cache_mutex);
+            if (hit) {
+                qol_log(QOL_LOG_DIAG, "Compile cache hit: %s\n", output);
+                qol_release(&compile);
+                return true;
+            }
+#if defined(QOL_CACHE_HARDLINK)
+            remove(output); // Might be a hardlink into the cache: never let the compiler write through it
+#endif
+            job->cache_entry = strdup(entry);
+            if (!job->cache_entry) abort();
+        }
+
+        *next = qol_job_spawn(&compile, job, job->cache_capture, job->capture_max);
+        qol_release(&compile);
+        return *next != QOL_INVALID_PROC;
+    }
+
+    //////////////////////////////////////////////////
+    /// SCHEDULER ////////////////////////////////////
+    //////////////////////////////////////////////////
+
+    QOLDEF bool qol_pool_define(const char *name, size_t depth) {
+        if (!name || depth == 0) {
+            qol_log(QOL_LOG_ERRO, "Invalid pool definition\n");
+            return false;
+        }
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        for (size_t i = 0; i < qol_pools.len; i++) {
+            if (strcmp(qol_pools.data[i].name, name) == 0) {
+                qol_pools.data[i].depth = depth;
+                QOL_MUTEX_UNLOCK(qol_exec_mutex);
+                return true;
+            }
+        }
+        QOL_Pool pool = { .name = strdup(name), .depth = depth };
+        if (!pool.name) abort();
+        qol_push(&qol_pools, pool);
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        return true;
+    }
+
+    // Index + 1 of the named pool, 0 (and an error) if it was never defined
+    static size_t qol_pool_index(const char *name) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        size_t index = 0;
+        for (size_t i = 0; i < qol_pools.len && index == 0; i++) {
+            if (strcmp(qol_pools.data[i].name, name) == 0) index = i + 1;
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        if (index == 0) qol_log(QOL_LOG_ERRO, "Unknown pool `%s`, define it with qol_pool_define()\n", name);
+        return index;
+    }
+
+    QOLDEF size_t qol_mem_available_mb(void) {
+#if defined(WINDOWS)
+        MEMORYSTATUSEX status = { .dwLength = sizeof(status) };
+        return GlobalMemoryStatusEx(&status) ? (size_t)(status.ullAvailPhys / (1024 * 1024)) : 0;
+#elif defined(MACOS)
+        // Page cache is reclaimed lazily on macOS, so "free" memory is misleading: take 3/4 of RAM
+        long pages = sysconf(_SC_PHYS_PAGES), page_size = sysconf(_SC_PAGESIZE);
+        return pages > 0 && page_size > 0 ? (size_t)((uint64_t)pages * (uint64_t)page_size / 4 * 3 / (1024 * 1024)) : 0;
+#else
+        FILE *fp = fopen("/proc/meminfo", "r");
+        if (!fp) return 0;
+        char line[256];
+        unsigned long long kb = 0;
+        while (fgets(line, sizeof(line), fp)) {
+            if (sscanf(line, "MemAvailable: %llu kB", &kb) == 1) break;
+        }
+        fclose(fp);
+        return (size_t)(kb / 1024);
+#endif
+    }
+
+    // Expected peak RSS of the command producing output: what it needed last time, or a default
+    static size_t qol_mem_estimate_kb(const char *output) {
+        QOL_BuildLogEntry entry;
+        if (output && qol_build_log_get(output, &entry) && entry.max_rss_kb > 0) return (size_t)entry.max_rss_kb;
+        return (size_t)QOL_MEM_ESTIMATE_MB * 1024;
+    }
+
+    // What QOL_MEM_AVAILABLE stands for right now: the memory that is free plus the estimates of
+    // owner's running commands (which count against the budget themselves), but never more than
+    // was free at the first launch. Memory taken by other programs meanwhile shrinks it, memory
+    // they give back is available again. Returns 0 if the available memory is unknown.
+    static size_t qol_mem_budget_now(size_t running_kb) {
+        static size_t first_mb = 0;
+        static bool first_taken = false;
+        size_t available_mb = qol_mem_available_mb();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        bool first = !first_taken;
+        if (first) {
+            first_taken = true;
+            first_mb = available_mb;
+        }
+        size_t limit_mb = first_mb;
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+        if (first) qol_log(QOL_LOG_DIAG, "Memory budget: at most %zu MiB\n", limit_mb);
+        if (available_mb == 0) return 0;
+        size_t now_mb = available_mb + running_kb / 1024;
+        return now_mb < limit_mb ? now_mb : limit_mb;
+    }
+
+    // Can a job with this pool, weight and memory estimate start next to the jobs already running
+    // for owner? Jobs are never delayed by their own estimate alone (otherwise they'd wait forever).
+    // Delays are logged with name unless it is NULL.
+    static bool qol_sched_admit(const void *owner, size_t pool, size_t weight, size_t mem_kb, size_t budget_mb, const char *name) {
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        size_t running = 0, running_kb = 0;
+        for (size_t i = 0; i < qol_jobs.len; i++) {
+            if (qol_jobs.data[i].owner != owner) continue;
+            running++;
+            running_kb += qol_jobs.data[i].mem_kb;
+        }
+        bool pool_full = pool && qol_pools.data[pool - 1].used > 0 && qol_pools.data[pool - 1].used + weight > qol_pools.data[pool - 1].depth;
+        const char *pool_name = pool ? qol_pools.data[pool - 1].name : NULL;
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+
+        if (pool_full) {
+            if (name) qol_log(QOL_LOG_DIAG, "Delaying %s: pool `%s` is full\n", name, pool_name);
+            return false;
+        }
+        if (budget_mb == QOL_MEM_AVAILABLE && running > 0) budget_mb = qol_mem_budget_now(running_kb);
+        if (budget_mb > 0 && running > 0 && running_kb + mem_kb > (size_t)budget_mb * 1024) {
+            if (name) qol_log(QOL_LOG_DIAG, "Delaying %s: %zu MiB projected, budget is %zu MiB\n", name, (running_kb + mem_kb) / 1024, budget_mb);
+            return false;
+        }
+        return true;
+    }
+
+    static bool qol_run_job(QOL_Cmd* config, QOL_RunOptions opts, QOL_Job *job);
+
+    //////////////////////////////////////////////////
+    /// WORKERS //////////////////////////////////////
+    //////////////////////////////////////////////////
+
+    #define QOL_WORKER_MAX_RESPONSE (64u * 1024 * 1024) // Larger responses are taken for protocol errors
+
+    static void qol_worker_put_u32(unsigned char *p, uint32_t value) {
+        for (int i = 0; i < 4; i++) p[i] = (unsigned char)(value >> (8 * i));
+    }
+
+    static uint32_t qol_worker_get_u32(const unsigned char *p) {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    QOLDEF void qol_worker_printf(QOL_WorkerOutput *out, const char *format, ...) {
+        if (!out || !format) return;
+        va_list args;
+        va_start(args, format);
+        int n = vsnprintf(NULL, 0, format, args);
+        va_end(args);
+        if (n <= 0) return;
+        if (out->len + (size_t)n + 1 > out->cap) {
+            size_t cap = out->cap ? out->cap * 2 : 256;
+            while (cap < out->len + (size_t)n + 1) cap *= 2;
+            out->data = (char*)realloc(out->data, cap);
+            if (!out->data) abort();
+            out->cap = cap;
+        }
+        va_start(args, format);
+        vsnprintf(out->data + out->len, (size_t)n + 1, format, args);
+        va_end(args);
+        out->len += (size_t)n;
+    }
+
+    QOLDEF int qol_worker_main(int argc, char **argv, QOL_WorkerHandler handler) {
+        if (!handler || argc < 1) return 1;
+        QOL_WorkerOutput out = {0};
+        if (argc < 2 || strcmp(argv[1], QOL_WORKER_FLAG) != 0) {
+            int code = handler(argc, argv, &out);
+            if (out.len > 0) fwrite(out.data, 1, out.len, stdout);
+            free(out.data);
+            return code;
+        }
+
+#ifdef WINDOWS
+        _setmode(_fileno(stdin), _O_BINARY);
+        _setmode(_fileno(stdout), _O_BINARY);
+#endif
+        unsigned char header[8];
+        char *payload = NULL;
+        qol_list(char*) args = {0};
+        int status = 0;
+        while (fread(header, 1, 4, stdin) == 4) {
+            uint32_t length = qol_worker_get_u32(header);
+            payload = (char*)realloc(payload, (size_t)length + 1);
+            if (!payload) abort();
+            if (fread(payload, 1, length, stdin) != length) {
+                status = 1; // The driver went away in the middle of a request
+                break;
+            }
+            payload[length] = '\0';
+
+            args.len = 0;
+            qol_push(&args, argv[0]);
+            for (size_t pos = 0; pos < length; pos += strlen(payload + pos) + 1) qol_push(&args, payload + pos);
+            qol_push(&args, NULL);
+            out.len = 0;
+            int code = handler((int)args.len - 1, args.data, &out);
+
+            qol_worker_put_u32(header, (uint32_t)(out.len + 4));
+            qol_worker_put_u32(header + 4, (uint32_t)code);
+            if (fwrite(header, 1, 8, stdout) != 8 || (out.len > 0 && fwrite(out.data, 1, out.len, stdout) != out.len) || fflush(stdout) != 0) {
+                status = 1;
+                break;
+            }
+        }
+        free(payload);
+        free(out.data);
+        qol_release(&args);
+        return status;
+    }
+
+#ifdef WINDOWS
+    QOLDEF void qol_workers_shutdown(void) {}
+#else
+    // A long-lived worker process and the request it is serving
+    typedef struct {
+        char *program;     // argv[0] the worker was started for (owned)
+        pid_t pid;
+        int fd;            // Our end of the socket pair that is the worker's stdin and stdout
+        size_t requests;   // Requests served so far
+        bool busy;         // A request is in flight
+        QOL_Job job;       // Bookkeeping of the request in flight
+        QOL_Procs *procs;  // Array the request was started into, NULL for sync requests
+        QOL_String argv;   // First request only: copy of the command (owned), run as a plain process
+                           // if the program turns out not to speak the protocol
+        QOL_RunOptions opts; // First request only: options to run it with
+    } QOL_Worker;
+
+    // Workers are driven by the thread that runs the build (like the Procs arrays they serve)
+    static qol_list(QOL_Worker*) qol_workers = {0};
+    static QOL_String qol_workers_disabled = {0}; // Programs that did not work as workers
+
+    static bool qol_worker_send(int fd, const void *data, size_t size) {
+        const char *p = (const char*)data;
+        while (size > 0) {
+#ifdef MSG_NOSIGNAL
+            ssize_t n = send(fd, p, size, MSG_NOSIGNAL); // A dead worker must not SIGPIPE the driver
+#else
+            ssize_t n = write(fd, p, size); // SO_NOSIGPIPE is set on the socket
+#endif
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            p += n;
+            size -= (size_t)n;
+        }
+        return true;
+    }
+
+    static bool qol_worker_recv(int fd, void *data, size_t size) {
+        char *p = (char*)data;
+        while (size > 0) {
+            ssize_t n = read(fd, p, size);
+            if (n < 0 && errno == EINTR) {
+                if (qol_interrupted) qol_interrupt_cleanup();
+                continue;
+            }
+            if (n <= 0) return false;
+            p += n;
+            size -= (size_t)n;
+        }
+        return true;
+    }
+
+    static QOL_Worker *qol_worker_spawn(const char *program) {
+        int fds[2];
+#if defined(LINUX)
+        int type = SOCK_STREAM | SOCK_CLOEXEC; // No window for a spawn from another thread (see qol_pipe_cloexec())
+#else
+        int type = SOCK_STREAM;
+#endif
+        if (socketpair(AF_UNIX, type, 0, fds) != 0) {
+            qol_log(QOL_LOG_ERRO, "Could not create worker socket: %s\n", strerror(errno));
+            return NULL;
+        }
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC); // Only its dup2 copies reach the worker
+#ifdef SO_NOSIGPIPE
+        int one = 1;
+        setsockopt(fds[0], SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDIN_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+        char *argv[] = { (char*)program, (char*)QOL_WORKER_FLAG, NULL };
+        pid_t pid;
+        int err = posix_spawnp(&pid, program, &actions, NULL, argv, environ);
+        posix_spawn_file_actions_destroy(&actions);
+        close(fds[1]);
+        if (err != 0) {
+            qol_log(QOL_LOG_ERRO, "Could not start worker %s: %s\n", program, strerror(err));
+            close(fds[0]);
+            return NULL;
+        }
+
+        QOL_Worker *worker = (QOL_Worker*)calloc(1, sizeof(QOL_Worker));
+        if (!worker) abort();
+        worker->program = strdup(program);
+        if (!worker->program) abort();
+        worker->pid = pid;
+        worker->fd = fds[0];
+        qol_push(&qol_workers, worker);
+        qol_log(QOL_LOG_DIAG, "Started worker %s (pid %d)\n", program, (int)pid);
+        return worker;
+    }
+
+    // A request was dispatched to worker (busy = true) or left it. Requests count as live jobs, so
+    // that Ctrl-C is handled (outputs removed) instead of killing the driver on the spot.
+    static void qol_worker_set_busy(QOL_Worker *worker, bool busy) {
+        if (worker->busy == busy) return;
+        worker->busy = busy;
+        qol_init_mutexes();
+        QOL_MUTEX_LOCK(qol_exec_mutex);
+        if (busy) {
+            qol_live_jobs++;
+            qol_interrupt_install();
+        } else {
+            qol_live_jobs--;
+            qol_interrupt_restore();
+        }
+        QOL_MUTEX_UNLOCK(qol_exec_mutex);
+    }
+
+    // Close the worker's stdin, reap it and forget it. A request still in flight is dropped.
+    static void qol_worker_stop(QOL_Worker *worker) {
+        close(worker->fd);
+        kill(worker->pid, SIGTERM);
+        int wstatus;
+        struct rusage rusage;
+        if (waitpid(worker->pid, &wstatus, 0) < 0) qol_reaped_procs_take(worker->pid, &wstatus, &rusage); // Reaped by a poll of another Procs array
+        for (size_t i = 0; i < qol_workers.len; i++) {
+            if (qol_workers.data[i] != worker) continue;
+            qol_dropn(&qol_workers, i);
+            break;
+        }
+        if (worker->busy) {
+            if (worker->job.slot) qol_jobserver_give();
+            qol_job_release(&worker->job);
+            qol_worker_set_busy(worker, false);
+        }
+        qol_release_string(&worker->argv);
+        free(worker->program);
+        free(worker);
+    }
+
+    // Read the response of a busy worker and finish its request. Returns 1 on success, 0 on failure
+    // and -1 if the worker broke off its first request, which then went to the plain path (sync:
+    // the result of that run; async: started into the request's Procs array).
+    static int qol_worker_finish(QOL_Worker *worker) {
+        unsigned char header[8];
+        char *output = NULL;
+        uint32_t length = 0;
+        bool answered = qol_worker_recv(worker->fd, header, 4) && (length = qol_worker_get_u32(header)) >= 4 &&
+                        length <= QOL_WORKER_MAX_RESPONSE && qol_worker_recv(worker->fd, header + 4, 4);
+        if (answered && length > 4) {
+            output = (char*)malloc(length - 4);
+            if (!output) abort();
+            answered = qol_worker_recv(worker->fd, output, length - 4);
+        }
+
+        bool ok = false;
+        if (!answered && worker->requests == 0) {
+            // Not a worker after all: run this command and all later ones as plain processes
+            qol_log(QOL_LOG_DIAG, "%s does not speak the worker protocol, running it as a plain process\n", worker->program);
+            qol_push(&qol_workers_disabled, strdup(worker->program));
+            QOL_Job job = worker->job;
+            QOL_RunOptions opts = worker->opts;
+            QOL_String argv = worker->argv;
+            worker->argv = (QOL_String){0};
+            qol_worker_set_busy(worker, false);
+            qol_worker_stop(worker);
+
+            QOL_Cmd cmd = {0};
+            for (size_t i = 0; i < argv.len; i++) qol_push(&cmd, argv.data[i]);
+            free(job.name); // Set again by qol_run_job()
+            job.name = NULL;
+            opts.worker = false;
+            bool started = qol_run_job(&cmd, opts, &job);
+            qol_release_string(&argv);
+            return opts.procs ? -1 : started;
+        }
+        qol_release_string(&worker->argv); // It spoke the protocol (or broke off a later request)
+        if (!answered) {
+            qol_log(QOL_LOG_ERRO, "Worker %s (pid %d) broke off a request\n", worker->program, (int)worker->pid);
+        } else {
+            int code = (int)qol_worker_get_u32(header + 4);
+            if (length > 4) {
+                qol_init_mutexes();
+                QOL_MUTEX_LOCK(qol_logger_mutex);
+                fwrite(output, 1, length - 4, stdout);
+                if (output[length - 5] != '\n') fputc('\n', stdout);
+                fflush(stdout);
+                QOL_MUTEX_UNLOCK(qol_logger_mutex);
+            }
+            if (code != 0) qol_log(QOL_LOG_ERRO, "Command failed with exit code %d\n", code);
+            ok = code == 0;
+            worker->requests++;
+        }
+        free(output);
+
+        QOL_Job job = worker->job;
+        QOL_Procs *procs = worker->procs;
+        qol_worker_set_busy(worker, false);
+        worker->procs = NULL;
+        if (!ok || worker->requests >= QOL_WORKER_MAX_REQUESTS) qol_worker_stop(worker); // Recycle
+        if (!ok && procs) procs->failed++;
+        qol_job_done(&job, ok, NULL);
+        return ok ? 1 : 0;
+    }
+
+    // Number of requests of owner (NULL = any) in flight
+    static size_t qol_workers_pending(const QOL_Procs *owner) {
+        size_t pending = 0;
+        for (size_t i = 0; i < qol_workers.len; i++) {
+            if (qol_workers.data[i]->busy && (!owner || qol_workers.data[i]->procs == owner)) pending++;
+        }
+        return pending;
+    }
+
+    // poll() on worker sockets that keeps the rest of the build going while it waits up to
+    // timeout_ms (-1 = no limit): enforces timeouts, drains captured output and reacts to Ctrl-C
+    static int qol_workers_poll(struct pollfd *fds, nfds_t count, int timeout_ms) {
+        QOL_Timer timer = {0};
+        qol_timer_start(&timer);
+        for (;;) {
+            if (qol_interrupted) qol_interrupt_cleanup();
+            qol_init_mutexes();
+            QOL_MUTEX_LOCK(qol_exec_mutex);
+            bool capturing = qol_capture_open > 0;
+            bool watched = qol_jobs_watched();
+            QOL_MUTEX_UNLOCK(qol_exec_mutex);
+            int slice = capturing || watched ? 5 : timeout_ms;
+            if (timeout_ms >= 0) {
+                uint64_t elapsed = qol_timer_elapsed_ns(&timer) / 1000000;
+                int remaining = elapsed >= (uint64_t)timeout_ms ? 0 : timeout_ms - (int)elapsed;
+                if (slice < 0 || slice > remaining) slice = remaining;
+            }
+            int ready = poll(fds, count, slice); // Ctrl-C interrupts it (EINTR, no SA_RESTART)
+            if (ready > 0 || (ready < 0 && errno != EINTR)) return ready;
+            qol_jobs_check_deadlines();
+            if (capturing) qol_capture_pump(0);
+            if (timeout_ms >= 0 && qol_timer_elapsed_ns(&timer) / 1000000 >= (uint64_t)timeout_ms) return 0;
+        }
+    }
+
+    // Finish the requests of owner (NULL = any) whose response arrived, waiting up to timeout_ms
+    // (-1 = no limit) for the first one. Returns the number of requests finished.
+    static size_t qol_workers_collect(const QOL_Procs *owner, int timeout_ms) {
+        struct pollfd fds[64];
+        QOL_Worker *polled[64];
+        nfds_t count = 0;
+        for (size_t i = 0; i < qol_workers.len && count < 64; i++) {
+            QOL_Worker *worker = qol_workers.data[i];
+            if (!worker->busy || (owner && worker->procs != owner)) continue;
+            fds[count].fd = worker->fd;
+            fds[count].events = POLLIN;
+            fds[count].revents = 0;
+            polled[count++] = worker;
+        }
+        if (count == 0) return 0;
+        if (qol_workers_poll(fds, count, timeout_ms) <= 0) return 0;
+        size_t finished = 0;
+        for (nfds_t i = 0; i < count; i++) {
+            if (fds[i].revents == 0) continue;
+            if (qol_worker_finish(polled[i]) >= 0) finished++; // May recycle the worker, the others stay valid
+        }
+        return finished;
+    }
+
+    // Serve cmd with a worker. Returns 1 on success, 0 if the request failed (sync) and -1 if no
+    // worker can take it, so that it runs as a plain process (cmd and job untouched).
+    static int qol_worker_run(QOL_Cmd *cmd, QOL_RunOptions opts, QOL_Job *job) {
+        // A request cannot be killed or weighed on its own: commands with a timeout, a pool or a
+        // memory budget run as plain processes, so do those of a cancelled array (reported there)
+        if (opts.timeout_ms || opts.pool || (opts.procs && (opts.procs->cancelled || opts.procs->mem_budget_mb))) return -1;
+        const char *program = cmd->data[0];
+        for (size_t i = 0; i < qol_workers_disabled.len; i++) {
+            if (strcmp(qol_workers_disabled.data[i], program) == 0) return -1;
+        }
+
+        // Same limits as plain commands: max_jobs counts the processes and requests of the array,
+        // and requests beyond the first hold a jobserver slot
+        if (opts.procs) {
+            qol_jobserver_join();
+            for (;;) {
+                size_t running = opts.procs->len + qol_workers_pending(opts.procs);
+                bool full = opts.procs->max_jobs > 0 && running >= opts.procs->max_jobs;
+                if (!full) {
+                    qol_jobserver_take(NULL, &job->slot); // Does not wait without running commands
+                    if (job->slot || running == 0 || qol_jobserver.mode == QOL_JOBSERVER_NONE) break;
+                }
+                qol_procs_poll(opts.procs, full ? -1 : 5); // No token: check again shortly
+            }
+        }
+
+        size_t length = 0;
+        for (size_t i = 1; i < cmd->len; i++) length += strlen(cmd->data[i]) + 1;
+        unsigned char *request = (unsigned char*)malloc(4 + length);
+        if (!request) abort();
+        qol_worker_put_u32(request, (uint32_t)length);
+        size_t pos = 4;
+        for (size_t i = 1; i < cmd->len; i++) {
+            size_t size = strlen(cmd->data[i]) + 1;
+            memcpy(request + pos, cmd->data[i], size);
+            pos += size;
+        }
+
+        size_t limit = opts.procs && opts.procs->max_jobs ? opts.procs->max_jobs : qol_nprocs();
+        QOL_Worker *worker = NULL;
+        for (;;) {
+            bool disabled = false;
+            for (size_t i = 0; i < qol_workers_disabled.len && !disabled; i++) disabled = strcmp(qol_workers_disabled.data[i], program) == 0;
+            size_t running = 0;
+            for (size_t i = 0; i < qol_workers.len && !disabled; i++) {
+                if (strcmp(qol_workers.data[i]->program, program) != 0) continue;
+                running++;
+                if (!qol_workers.data[i]->busy && !worker) worker = qol_workers.data[i];
+            }
+            if (!disabled && !worker && running >= limit) {
+                if (qol_workers_collect(NULL, -1) > 0) continue; // All workers busy: wait for a response
+                disabled = true;
+            }
+            if (!disabled && !worker) {
+                worker = qol_worker_spawn(program);
+                if (!worker) {
+                    qol_push(&qol_workers_disabled, strdup(program));
+                    disabled = true;
+                }
+            }
+            if (disabled) {
+                free(request);
+                if (job->slot) qol_jobserver_give(); // The plain path takes its own
+                job->slot = false;
+                return -1;
+            }
+
+            if (qol_worker_send(worker->fd, request, 4 + length)) break;
+            qol_log(QOL_LOG_DIAG, "Worker %s (pid %d) is gone, replacing it\n", program, (int)worker->pid);
+            if (worker->requests == 0) qol_push(&qol_workers_disabled, strdup(program)); // Never got going
+            qol_worker_stop(worker);
+            worker = NULL;
+        }
+        free(request);
+
+        qol_cmd_log(cmd);
+        worker->job = *job;
+        worker->job.proc = QOL_INVALID_PROC;
+        qol_timer_start(&worker->job.timer);
+        qol_worker_set_busy(worker, true);
+        worker->procs = opts.procs;
+        if (worker->requests == 0) {
+            for (size_t i = 0; i < cmd->len; i++) {
+                char *copy = strdup(cmd->data[i]);
+                if (!copy) abort();
+                qol_push(&worker->argv, copy);
+            }
+            worker->opts = opts;
+        }
+        qol_release(cmd);
+        if (opts.procs) return 1;
+        struct pollfd fd = { .fd = worker->fd, .events = POLLIN };
+        qol_workers_poll(&fd, 1, -1);
+        int result = qol_worker_finish(worker);
+        return result < 0 ? 0 : result;
+    }
+
+    // Stop all workers right away and delete the outputs of their requests (Ctrl-C). Returns the
+    // number of outputs removed.
+    static size_t qol_workers_interrupt(void) {
+        size_t removed = 0;
+        for (size_t i = 0; i < qol_workers.len; i++) {
+            QOL_Worker *worker = qol_workers.data[i];
+            kill(worker->pid, SIGKILL); // A request cannot be cancelled, its output may be half written
+            if (worker->busy) removed += qol_job_remove_outputs(&worker->job);
+        }
+        while (qol_workers.len > 0) qol_worker_stop(qol_workers.data[qol_workers.len - 1]);
+        return removed;
+    }
+
+    QOLDEF void qol_workers_shutdown(void) {
+        while (qol_workers_pending(NULL)) {
+            if (qol_workers_collect(NULL, -1) == 0) break;
+        }
+        while (qol_workers.len > 0) qol_worker_stop(qol_workers.data[qol_workers.len - 1]);
+    }
+#endif
+
+    QOLDEF bool qol_run_impl(QOL_Cmd* config, QOL_RunOptions opts) {
+        if (!config || !config->data || config->len == 0) {
+            qol_log(QOL_LOG_ERRO, "Invalid build configuration\n");
+            if (config) qol_release(config);
+            return false;
+        }
+
+        const char *source = qol_cmd_get_source(config);
+        const char *output = qol_cmd_get_output(config);
+        
+        if (!source || !output) {
+            qol_log(QOL_LOG_DIAG, "Could not extract source or output from command. Run the command anyway.\n");
+            // TODO: should we rather exit with false and do something like this?
+            // if (opts.cmd) return qol_run_always_impl(config, opts);
+            return qol_run_always_impl(config, opts);
+        }
+
+        qol_ensure_dir_for_file(output);
+
+        char depfile[QOL_PATH_BUFFER_SIZE] = {0};
+        if (opts.deps) {
+            snprintf(depfile, sizeof(depfile), "%s.d", output);
+            qol_deps_ingest(output, depfile); // Left behind by an interrupted build, if any
+        }
+
+        uint64_t hash = qol_cmd_hash(config); // Before -MMD is appended: hash what the caller wrote
+        int64_t source_mtime, output_mtime;
+        bool stale = qol_input_mtime_ns(source, &source_mtime) && (!qol_file_mtime_ns(output, &output_mtime) || source_mtime > output_mtime);
+        if (!stale) stale = qol_build_log_cmd_changed(output, hash);
+        if (!stale && opts.deps) stale = qol_deps_check(output) != 0; // Unknown deps: build once to learn them
+        if (!stale) {
+            qol_log(QOL_LOG_DIAG, "Up to date: %s\n", output);
+            qol_release(config);
+            return true;
+        }
+
+        // Recorded in the build log (and the depfile ingested) once the command finished successfully
+        QOL_Job job = { .hash = hash };
+        char *copy = strdup(output);
+        if (!copy) abort();
+        qol_push(&job.outputs, copy);
+        if (opts.deps) {
+            job.depfile = strdup(depfile);
+            if (!job.depfile) abort();
+            qol_push(config, "-MMD", "-MF", depfile);
+        }
+        return qol_run_job(config, opts, &job);
+    }
+
+    QOLDEF bool qol_run_always_impl(QOL_Cmd* config, QOL_RunOptions opts) {
+        const char *output = (opts.cache || opts.restat) && config ? qol_cmd_get_output(config) : NULL;
+        if (!output) return qol_run_job(config, opts, NULL);
+
+        // The compile cache and restat need a job to look at the output once the command finished
+        QOL_Job job = { .hash = qol_cmd_hash(config) };
+        char *copy = strdup(output);
+        if (!copy) abort();
+        qol_push(&job.outputs, copy);
+        return qol_run_job(config, opts, &job);
+    }
+
+    // Spawn config (async into opts.procs or synchronously). If job is given, it is registered in
+    // the job table so that its side effects happen when the process is reaped; ownership of the
+    // job's strings moves to the job table in any case.
+    static bool qol_run_job(QOL_Cmd* config, QOL_RunOptions opts, QOL_Job *job) {
+        if (!config || !config->data || config->len == 0) {
+            qol_log(QOL_LOG_ERRO, "Invalid build configuration\n");
+            if (config) qol_release(config);
+            if (job) qol_job_release(job);
+            return false;
+        }
+
+        if (qol_interrupted) qol_interrupt_cleanup();
+
+        // Async commands and timeouts need a job (cancellation, capture, results, throttling), even
+        // for commands without build bookkeeping
+        bool capture = opts.procs && opts.procs->capture;
+        QOL_ProcResults *results = opts.procs ? opts.procs->results : NULL;
+        size_t pool = opts.procs && opts.pool ? qol_pool_index(opts.pool) : 0;
+        if (opts.procs && opts.pool && pool == 0) {
+            qol_release(config);
+            if (job) qol_job_release(job);
+            return false;
+        }
+        bool throttle = opts.procs && (pool || opts.procs->mem_budget_mb);
+        QOL_Job plain = {0};
+        if (!job && (opts.procs || opts.timeout_ms || opts.on_exit || opts.worker)) job = &plain;
+        if (job && (results || opts.timeout_ms)) job->name = qol_cmd_label(config);
+        if (job) {
+            job->results = results;
+            job->timeout_ms = opts.timeout_ms;
+            job->restat = opts.restat;
+            job->on_exit = opts.on_exit;
+            job->user = opts.user;
+            // Sync commands stay in the terminal's foreground group, unless a timeout has to kill
+            // their whole process tree (`sh -c`, the compiler driver's cc1)
+            job->group = opts.procs != NULL || opts.timeout_ms > 0;
+        }
+
+#ifndef WINDOWS
+        if (opts.worker) {
+            int served = qol_worker_run(config, opts, job);
+            if (served >= 0) return served == 1;
+        }
+#endif
+
+        if (opts.procs) {
+            qol_jobserver_join();
+            if (throttle) {
+                job->owner = opts.procs;
+                job->pool = pool;
+                job->weight = opts.weight ? opts.weight : 1;
+                job->mem_kb = opts.procs->mem_budget_mb ? qol_mem_estimate_kb(qol_cmd_get_output(config)) : 0;
+            }
+
+#ifndef WINDOWS
+            // Worker requests of the array occupy job slots as well
+            while (opts.procs->max_jobs > 0 && qol_workers_pending(opts.procs) > 0 &&
+                   opts.procs->len + qol_workers_pending(opts.procs) >= opts.procs->max_jobs) qol_procs_poll(opts.procs, -1);
+#endif
+
+            // Bounded job pool: reap whichever child finishes first until a slot is free (and the
+            // pool, the memory budget and the jobserver allow the command to start)
+            while (opts.procs->len > 0) {
+                bool full = opts.procs->max_jobs > 0 && opts.procs->len >= opts.procs->max_jobs;
+                if (!full && (!throttle || qol_sched_admit(opts.procs, job->pool, job->weight, job->mem_kb, opts.procs->mem_budget_mb, config->data[0])) &&
+                    qol_jobserver_take(opts.procs, &job->slot)) break;
+                bool ok = false;
+                if (qol_procs_wait_any(opts.procs, &ok) == QOL_INVALID_PROC) break;
+                if (!ok) opts.procs->failed++;
+            }
+            if (!job->slot) qol_jobserver_take(opts.procs, &job->slot);
+
+            if (opts.procs->cancelled) {
+                qol_log(QOL_LOG_DIAG, "Not starting %s: the build was cancelled\n", config->data[0]);
+                qol_release(config);
+                if (job->slot) qol_jobserver_give();
+                qol_job_release(job);
+                return false;
+            }
+        }
+
+        if (job) {
+            qol_timer_start(&job->timer);
+        }
+        // A cached compile starts with its preprocessor, uncaptured (the compile reports any errors)
+        if (job && opts.cache && qol_cache_prepare(config, job, capture)) {
+            job->capture_max = opts.procs ? opts.procs->capture_max : 0;
+            capture = false;
+        }
+
+        QOL_Proc proc = job ? qol_job_spawn(config, job, capture, opts.procs ? opts.procs->capture_max : 0)
+                            : qol_cmd_execute_async(config);
+        qol_release(config);
+        if (proc == QOL_INVALID_PROC) {
+            if (job && job->slot) qol_jobserver_give();
+            if (job) qol_job_release(job);
+            return false;
+        }
+        if (job) {
+            job->proc = proc;
+            qol_job_start(job);
+        }
+
+        if (opts.procs) {
+            qol_push(opts.procs, proc);
+            return true;
+        }
+        return qol_proc_wait(proc);
+    }
+
+    QOLDEF QOL_Target *qol_graph_add(QOL_Graph *graph, QOL_Cmd cmd) {
+        if (!graph) return NULL;
+        QOL_Target *target = (QOL_Target*)calloc(1, sizeof(QOL_Target));
+        if (!target) {
+            qol_log(QOL_LOG_ERRO, "Failed to allocate build target\n");
+            return NULL;
+        }
+        target->cmd = cmd;
+        qol_push(graph, target);
+        return target;
+    }
+
+    QOLDEF void qol_graph_release(QOL_Graph *graph) {
+        if (!graph) return;
+        for (size_t i = 0; i < graph->len; i++) {
+            QOL_Target *target = graph->data[i];
+            qol_release(&target->cmd);
+            qol_release(&target->inputs);
+            qol_release(&target->outputs);
+            qol_release(&target->dependents);
+            free(target->depfile);
+            free(target);
+        }
+        qol_release(graph);
+        graph->built = graph->up_to_date = 0;
+    }
+
+    // Object path for source below obj_dir: `src/a.c` -> `<obj_dir>/src/a.o`. Absolute prefixes are
+    // dropped and `..` components become `%2E%2E` (with `%` itself escaped as `%25`, so the escape cannot
+    // clash with a real directory name); every object stays inside obj_dir. Caller frees.
+    static char *qol_project_object_path(const char *obj_dir, const char *source) {
+        size_t size = strlen(obj_dir) + 3 * strlen(source) + 8;
+        char *path = (char*)malloc(size);
+        if (!path) abort();
+        size_t len = (size_t)snprintf(path, size, "%s/", obj_dir);
+        while (*source == '/' || *source == '\\') source++;
+        for (const char *c = source; *c; c++) {
+            bool component_start = c == source || c[-1] == '/' || c[-1] == '\\';
+            if (component_start && c[0] == '.' && c[1] == '.' && (c[2] == '/' || c[2] == '\\' || c[2] == '\0')) {
+                len += (size_t)snprintf(path + len, size - len, "%%2E%%2E");
+                c++;
+                continue;
+            }
+            if (*c == '%') len += (size_t)snprintf(path + len, size - len, "%%25");
+            else path[len++] = *c == ':' ? '_' : *c;
+        }
+        path[len] = '\0';
+        char *ext = strrchr(path, '.');
+        char *sep = strrchr(path, '/');
+        if (ext && (!sep || ext > sep)) len = (size_t)(ext - path);
+        snprintf(path + len, size - len, ".o");
+        return path;
+    }
+
+    // Unity batch: Generated source that #includes several sources of a project
+    typedef struct {
+        char *source;                                       // Generated batch source (owned)
+        char *object;                                       // Its object (owned)
+        struct { size_t *data; size_t len, cap; } members;  // Indices into the project's sources
+        bool failed;                                        // Did not compile: the members are built on their own
+    } QOL_UnityBatch;
+
+    typedef qol_list(QOL_UnityBatch) QOL_UnityBatches;
+
+    static char *qol_absolute_path(const char *path) {
+#ifdef WINDOWS
+        return _fullpath(NULL, path, 0);
+#else
+        return realpath(path, NULL);
+#endif
+    }
+
+    // Write data unless the file already holds exactly that (keeps the mtime of unchanged batches)
+    static bool qol_write_file_if_changed(const char *path, const char *data, size_t size) {
+        FILE *fp = fopen(path, "rb");
+        if (fp) {
+            bool same = true;
+            char buffer[4096];
+            size_t offset = 0, n;
+            while (same && (n = fread(buffer, 1, sizeof(buffer), fp)) > 0) {
+                same = offset + n <= size && memcmp(buffer, data + offset, n) == 0;
+                offset += n;
+            }
+            fclose(fp);
+            if (same && offset == size) return true;
+        }
+        return qol_write_file(path, data, size);
+    }
+
+    // Path of a file in the unity directory: `<obj_dir>/unity/unity_<k>.<ext>`, or the exclusion
+    // list without ext. Returns false (logged) if it does not fit into path.
+    static bool qol_unity_path(char *path, size_t size, const char *obj_dir, size_t k, const char *ext) {
+        int n = ext ? snprintf(path, size, "%s/unity/unity_%zu.%s", obj_dir, k, ext)
+                    : snprintf(path, size, "%s/unity/excluded", obj_dir);
+        if (n >= 0 && (size_t)n < size) return true;
+        qol_log(QOL_LOG_ERRO, "Unity batch path below %s is too long\n", obj_dir);
+        return false;
+    }
+
+    // Group the project's sources into unity batches of about the target compile time. Sources in
+    // `<unity_dir>/excluded` and single-source batches are left out (compiled on their own).
+    // Returns false if the plan could not be made (batches stays empty).
+    static bool qol_unity_plan(QOL_Project *project, const char *obj_dir, const QOL_String *objects, size_t jobs, QOL_UnityBatches *batches) {
+        char path[QOL_PATH_BUFFER_SIZE];
+        if (!qol_unity_path(path, sizeof(path), obj_dir, 0, NULL)) return false;
+        QOL_HashMap *excluded = qol_hm_create();
+        QOL_HashMap *shares = qol_hm_create(); // Absolute source path -> compile time share of its last batch + 1
+        if (!excluded || !shares) abort();
+
+        QOL_String lines = {0};
+        if (qol_file_exists(path) && qol_read_file(path, &lines)) {
+            for (size_t i = 0; i < lines.len; i++) qol_hm_put(excluded, lines.data[i], (void*)1);
+        }
+        qol_release_string(&lines);
+
+        // Sources only ever built in a batch have no compile time of their own: split the batch's
+        for (size_t k = 0;; k++) {
+            QOL_String batch = {0};
+            if (!qol_unity_path(path, sizeof(path), obj_dir, k, "c") || !qol_file_exists(path) || !qol_read_file(path, &batch)) break;
+            if (!qol_unity_path(path, sizeof(path), obj_dir, k, "o")) {
+                qol_release_string(&batch);
+                break;
+            }
+            QOL_BuildLogEntry entry;
+            size_t members = 0;
+            for (size_t i = 0; i < batch.len; i++) members += strncmp(batch.data[i], "#include \"", 10) == 0;
+            if (members > 0 && qol_build_log_get(path, &entry)) {
+                for (size_t i = 0; i < batch.len; i++) {
+                    if (strncmp(batch.data[i], "#include \"", 10) != 0) continue;
+                    char *member = batch.data[i] + 10;
+                    char *quote = strrchr(member, '"');
+                    if (quote) *quote = '\0';
+                    qol_hm_put(shares, member, (void*)(uintptr_t)(entry.duration_ms / members + 1));
+                }
+            }
+            qol_release_string(&batch);
+        }
+
+        size_t count = project->sources.len;
+        char **absolute = (char**)calloc(count, sizeof(char*));
+        uint64_t *estimate = (uint64_t*)calloc(count, sizeof(uint64_t));
+        if (!absolute || !estimate) abort();
+        uint64_t total = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (qol_hm_contains(excluded, (void*)project->sources.data[i])) continue;
+            absolute[i] = qol_absolute_path(project->sources.data[i]);
+            if (!absolute[i]) continue; // Missing source: its own compile reports it
+            QOL_BuildLogEntry entry;
+            uintptr_t share = (uintptr_t)qol_hm_get(shares, absolute[i]);
+            if (qol_build_log_get(objects->data[i], &entry)) estimate[i] = entry.duration_ms;
+            else if (share) estimate[i] = share - 1;
+            else estimate[i] = QOL_UNITY_FILE_MS;
+            if (estimate[i] == 0) estimate[i] = 1;
+            total += estimate[i];
+        }
+
+        // Fill batches in source order (neighbouring files tend to share headers) up to the target,
+        // which shrinks for small projects so that every job gets a batch
+        uint64_t target = project->unity_batch_ms ? project->unity_batch_ms : QOL_UNITY_BATCH_MS;
+        if (total / jobs < target) target = total / jobs > 0 ? total / jobs : 1;
+        QOL_UnityBatch batch = {0};
+        uint64_t sum = 0;
+        bool planned = true;
+        for (size_t i = 0; i <= count; i++) {
+            if (i < count && absolute[i]) {
+                qol_push(&batch.members, i);
+                sum += estimate[i];
+            }
+            if (batch.members.len == 0 || (i < count && sum < target)) continue;
+            if (batch.members.len == 1) { // Nothing to share: compile it on its own
+                batch.members.len = 0;
+                sum = 0;
+                continue;
+            }
+            size_t size = 64;
+            for (size_t j = 0; j < batch.members.len; j++) size += strlen(absolute[batch.members.data[j]]) + 16;
+            char *data = (char*)malloc(size);
+            if (!data) abort();
+            size_t len = (size_t)sprintf(data, "// Unity batch generated by build.h, do not edit\n");
+            for (size_t j = 0; j < batch.members.len; j++) {
+                len += (size_t)sprintf(data + len, "#include \"%s\"\n", absolute[batch.members.data[j]]);
+            }
+
+            if (!qol_unity_path(path, sizeof(path), obj_dir, batches->len, "c")) {
+                free(data);
+                planned = false;
+                break;
+            }
+            batch.source = strdup(path);
+            if (!batch.source || !qol_unity_path(path, sizeof(path), obj_dir, batches->len, "o")) abort(); // Same length as the source
+            batch.object = strdup(path);
+            if (!batch.object) abort();
+            qol_ensure_dir_for_file(batch.source);
+            qol_write_file_if_changed(batch.source, data, len);
+            free(data);
+            qol_push(batches, batch);
+            memset(&batch, 0, sizeof(batch));
+            sum = 0;
+        }
+        qol_release(&batch.members);
+
+        // Batches of an earlier, larger plan would skew the estimates of the next run
+        for (size_t k = batches->len; planned; k++) {
+            if (!qol_unity_path(path, sizeof(path), obj_dir, k, "c") || remove(path) != 0) break;
+            qol_stat_invalidate(path);
+            if (!qol_unity_path(path, sizeof(path), obj_dir, k, "o")) break;
+            remove(path);
+            qol_stat_invalidate(path);
+        }
+        if (!planned) {
+            for (size_t k = 0; k < batches->len; k++) {
+                free(batches->data[k].source);
+                free(batches->data[k].object);
+                qol_release(&batches->data[k].members);
+            }
+            batches->len = 0;
+        }
+
+        for (size_t i = 0; i < count; i++) free(absolute[i]);
+        free(absolute);
+        free(estimate);
+        qol_hm_release(excluded);
+        qol_hm_release(shares);
+        return planned;
+    }
+
+    // Does a unity file of the first count members of batch compile? (Output and errors discarded)
+    static bool qol_unity_probe(const QOL_Project *project, const QOL_Pch *pch, const char *obj_dir, const QOL_UnityBatch *batch, size_t count) {
+        char source[QOL_PATH_BUFFER_SIZE + 32], object[QOL_PATH_BUFFER_SIZE + 32];
+        snprintf(source, sizeof(source), "%s/unity/probe.c", obj_dir);
+        snprintf(object, sizeof(object), "%s/unity/probe.o", obj_dir);
+        FILE *fp = fopen(source, "wb");
+        if (!fp) return false;
+        for (size_t j = 0; j < count; j++) {
+            char *absolute = qol_absolute_path(project->sources.data[batch->members.data[j]]);
+            fprintf(fp, "#include \"%s\"\n", absolute ? absolute : project->sources.data[batch->members.data[j]]);
+            free(absolute);
+        }
+        fclose(fp);
+
+        QOL_Cmd cmd = {0};
+        qol_default_c_compiler(&cmd);
+        for (size_t j = 0; j < project->cflags.len; j++) qol_push(&cmd, project->cflags.data[j]);
+        qol_push(&cmd, "-c", source, "-o", object);
+        if (pch) qol_pch_use(pch, &cmd);
+#if defined(WINDOWS)
+        int null = _open("NUL", _O_WRONLY);
+#else
+        int null = open("/dev/null", O_WRONLY | O_CLOEXEC);
+#endif
+        QOL_Proc proc = qol_cmd_spawn(&cmd, null, null, false);
+        bool ok = proc != QOL_INVALID_PROC && qol_proc_wait(proc);
+#if defined(WINDOWS)
+        if (null >= 0) _close(null);
+#else
+        if (null >= 0) close(null);
+#endif
+        qol_release(&cmd);
+        remove(source);
+        remove(object);
+        return ok;
+    }
+
+    // A batch failed although its members compile on their own, so one of them clashes with an
+    // earlier one (same static name, conflicting macro). Bisect for the shortest failing prefix:
+    // its last member is the offender. Returns its index in batch->members.
+    static size_t qol_unity_find_clash(const QOL_Project *project, const QOL_Pch *pch, const char *obj_dir, const QOL_UnityBatch *batch) {
+        size_t good = 1, bad = batch->members.len; // Prefix lengths known to compile / to fail
+        while (bad - good > 1) {
+            size_t mid = good + (bad - good) / 2;
+            if (qol_unity_probe(project, pch, obj_dir, batch, mid)) good = mid;
+            else bad = mid;
+        }
+        return bad - 1;
+    }
+
+    // Write the PCH's wrapper header (if it changed) and decide where the PCH goes
+    static bool qol_pch_prepare(QOL_Pch *pch, const char *compiler) {
+        if (!pch || !pch->header) {
+            qol_log(QOL_LOG_ERRO, "Precompiled header needs a header\n");
+            return false;
+        }
+        char *absolute = qol_absolute_path(pch->header);
+        if (!absolute) {
+            qol_log(QOL_LOG_ERRO, "Could not find precompiled header `%s`\n", pch->header);
+            return false;
         }
+        const char *name = pch->header;
+        for (const char *c = pch->header; *c; c++) if (*c == '/' || *c == '\\') name = c + 1;
+        const char *dir = pch->dir ? pch->dir : QOL_PCH_DIR;
+        // clang looks for <header>.pch next to an -include'd header, GCC for <header>.gch
+        bool clang = strstr(compiler, "clang") != NULL;
+#ifdef MACOS
+        clang = clang || strcmp(compiler, "cc") == 0;
+#endif
+        // Keyed on the full path: headers of the same name in different directories get their own wrapper
+        unsigned long long key = (unsigned long long)qol_hash_fnv1a(absolute, strlen(absolute), QOL_FNV1A_INIT);
+        size_t size = strlen(dir) + strlen(name) + 32;
+        free(pch->wrapper);
+        free(pch->output);
+        pch->wrapper = (char*)malloc(size);
+        pch->output = (char*)malloc(size);
+        if (!pch->wrapper || !pch->output) abort();
+        snprintf(pch->wrapper, size, "%s/%016llx-%s", dir, key, name);
+        snprintf(pch->output, size, "%s/%016llx-%s%s", dir, key, name, clang ? ".pch" : ".gch");
+
+        size_t len = strlen(absolute) + 64;
+        char *content = (char*)malloc(len);
+        if (!content) abort();
+        len = (size_t)snprintf(content, len, "// Generated by build.h, do not edit\n#include \"%s\"\n", absolute);
+        free(absolute);
+        qol_ensure_dir_for_file(pch->wrapper);
+        bool ok = qol_write_file_if_changed(pch->wrapper, content, len);
+        free(content);
+        return ok;
+    }
 
-        // Create process using Windows API
-        STARTUPINFO si = { sizeof(si) }; // Startup info (zero-initialized)
-        PROCESS_INFORMATION pi; // Process info (filled by CreateProcess)
-        ZeroMemory(&pi, sizeof(pi)); // Zero-initialize process info
+    // Add the target compiling a prepared PCH with the dependents' flags
+    static QOL_Target *qol_pch_target(QOL_Graph *graph, const QOL_Pch *pch, const char **cflags, size_t count) {
+        QOL_Cmd cmd = {0};
+        qol_default_c_compiler(&cmd);
+        for (size_t i = 0; i < count; i++) qol_push(&cmd, cflags[i]);
+        qol_push(&cmd, "-x", "c-header", pch->wrapper, "-o", pch->output);
+        QOL_Target *target = qol_graph_add(graph, cmd);
+        if (!target) return NULL;
+        qol_push(&target->inputs, pch->wrapper, pch->header);
+        qol_push(&target->outputs, pch->output);
+        target->deps = true; // Everything the header includes
+        return target;
+    }
 
-        // CreateProcess: NULL for application name (use cmdline), cmdline contains full command
-        // Returns process handle and thread handle in PROCESS_INFORMATION
-        BOOL success = CreateProcessA(NULL, cmdline, NULL, NULL, FALSE, 0, NULL, NULL, &si, &pi);
-        if (!success) {
-            qol_log(QOL_LOG_ERRO, "Could not create process: %s\n", qol_win32_error_message(GetLastError()));
-            return QOL_INVALID_PROC;
+    QOLDEF bool qol_pch_build(QOL_Pch *pch) {
+        QOL_Cmd compiler = {0};
+        qol_default_c_compiler(&compiler);
+        bool ok = qol_pch_prepare(pch, compiler.data[0]);
+        qol_release(&compiler);
+        if (!ok) return false;
+
+        QOL_Graph graph = {0};
+        ok = qol_pch_target(&graph, pch, pch->cflags.data, pch->cflags.len) && qol_graph_build(&graph, .jobs=1);
+        qol_graph_release(&graph);
+        return ok;
+    }
+
+    QOLDEF void qol_pch_use(const QOL_Pch *pch, QOL_Cmd *cmd) {
+        if (!pch || !pch->wrapper || !cmd || cmd->len == 0) return;
+        qol_push(cmd, "-include", pch->wrapper, "-Winvalid-pch");
+        const char *added[3] = { cmd->data[cmd->len - 3], cmd->data[cmd->len - 2], cmd->data[cmd->len - 1] };
+        memmove(cmd->data + 4, cmd->data + 1, (cmd->len - 4) * sizeof(cmd->data[0]));
+        memcpy(cmd->data + 1, added, sizeof(added));
+    }
+
+    QOLDEF void qol_pch_release(QOL_Pch *pch) {
+        if (!pch) return;
+        qol_release(&pch->cflags);
+        free(pch->wrapper);
+        free(pch->output);
+        pch->wrapper = pch->output = NULL;
+    }
+
+    static QOL_Target *qol_project_compile(QOL_Graph *graph, const QOL_Project *project, const QOL_Pch *pch, const char *source, const char *object) {
+        QOL_Cmd cmd = {0};
+        qol_default_c_compiler(&cmd);
+        for (size_t j = 0; j < project->cflags.len; j++) qol_push(&cmd, project->cflags.data[j]);
+        qol_push(&cmd, "-c", source, "-o", object);
+        if (pch) qol_pch_use(pch, &cmd);
+        QOL_Target *target = qol_graph_add(graph, cmd);
+        if (!target) return NULL;
+        qol_push(&target->inputs, source);
+        if (pch) qol_push(&target->inputs, pch->output); // Rebuilt PCH -> recompile
+        qol_push(&target->outputs, object);
+        target->deps = project->deps;
+        return target;
+    }
+
+    // One pass over the project: batches that did not fail, single compiles for all other sources,
+    // then the link. Marks batches that failed to compile.
+    static bool qol_project_run(QOL_Project *project, const QOL_Pch *pch, const QOL_String *objects, QOL_UnityBatches *batches, QOL_GraphOptions opts) {
+        QOL_Graph graph = {0};
+        struct { const char **data; size_t len, cap; } inputs = {0};
+        qol_list(size_t) batch_targets = {0};
+        bool *batched = (bool*)calloc(project->sources.len, sizeof(bool));
+        if (!batched) abort();
+        bool ok = !pch || qol_pch_target(&graph, pch, project->cflags.data, project->cflags.len) != NULL;
+
+        for (size_t k = 0; k < batches->len && ok; k++) {
+            QOL_UnityBatch *batch = &batches->data[k];
+            if (batch->failed) continue;
+            QOL_Target *target = qol_project_compile(&graph, project, pch, batch->source, batch->object);
+            if (!target) { ok = false; break; }
+            for (size_t j = 0; j < batch->members.len; j++) {
+                qol_push(&target->inputs, project->sources.data[batch->members.data[j]]);
+                batched[batch->members.data[j]] = true;
+            }
+            qol_push(&batch_targets, graph.len - 1);
+            qol_push(&inputs, batch->object);
+        }
+        for (size_t i = 0; i < project->sources.len && ok; i++) {
+            if (batched[i]) continue;
+            if (!qol_project_compile(&graph, project, pch, project->sources.data[i], objects->data[i])) ok = false;
+            qol_push(&inputs, objects->data[i]);
+        }
+
+        if (ok) {
+            QOL_Cmd link = qol_default_c_link(inputs.data, inputs.len, project->output);
+            for (size_t j = 0; j < project->ldflags.len; j++) qol_push(&link, project->ldflags.data[j]);
+            QOL_Target *target = qol_graph_add(&graph, link);
+            if (!target) ok = false;
+            else {
+                for (size_t i = 0; i < inputs.len; i++) qol_push(&target->inputs, inputs.data[i]);
+                qol_push(&target->outputs, project->output);
+                ok = qol_graph_build_impl(&graph, opts);
+            }
         }
 
-        // Close thread handle (we only need process handle for waiting)
-        CloseHandle(pi.hThread);
-        return pi.hProcess; // Return process handle for later waiting
-#else
-        // Unix: Fork and exec approach
-        pid_t pid = fork(); // Create child process
-        if (pid < 0) {
-            // Fork failed
-            qol_log(QOL_LOG_ERRO, "Could not fork process: %s\n", strerror(errno));
-            return QOL_INVALID_PROC;
+        size_t next = 0;
+        for (size_t k = 0; k < batches->len && next < batch_targets.len; k++) {
+            if (batches->data[k].failed) continue;
+            if (!graph.data[batch_targets.data[next++]]->done) batches->data[k].failed = true;
         }
+        project->built += graph.built;
+        project->up_to_date += graph.up_to_date;
+        qol_graph_release(&graph);
+        qol_release(&inputs);
+        qol_release(&batch_targets);
+        free(batched);
+        return ok;
+    }
 
-        if (pid == 0) {
-            // Child process: Replace process image with command
-            // Build NULL-terminated argument array for execvp
-            QOL_Cmd cmd_null = {0};
-            for (size_t i = 0; i < cmd->len; i++) {
-                qol_push(&cmd_null, cmd->data[i]); // Copy all arguments
+    // Default object directory: next to the executable, one subdirectory per project
+    static void qol_project_obj_dir(const QOL_Project *project, char *obj_dir, size_t size) {
+        if (project->obj_dir) {
+            snprintf(obj_dir, size, "%s", project->obj_dir);
+        } else {
+            const char *name = project->output;
+            for (const char *c = project->output; *c; c++) if (*c == '/' || *c == '\\') name = c + 1;
+            snprintf(obj_dir, size, "%.*sobj/%s", (int)(name - project->output), project->output, name);
+        }
+    }
+
+    static bool qol_project_build_run(QOL_Project *project, QOL_GraphOptions opts) {
+        if (!project || !project->output || project->sources.len == 0) {
+            qol_log(QOL_LOG_ERRO, "Project needs an output and at least one source\n");
+            return false;
+        }
+        project->built = project->up_to_date = 0;
+
+        char obj_dir[QOL_PATH_BUFFER_SIZE];
+        qol_project_obj_dir(project, obj_dir, sizeof(obj_dir));
+
+        QOL_String objects = {0};
+        for (size_t i = 0; i < project->sources.len; i++) {
+            qol_push(&objects, qol_project_object_path(obj_dir, project->sources.data[i]));
+        }
+
+        // The PCH is part of the graph: built first, dependents recompile when it changed
+        QOL_Pch pch = { .header = project->pch };
+        QOL_Pch *pch_ptr = NULL;
+        char pch_dir[QOL_PATH_BUFFER_SIZE + 8];
+        if (project->pch) {
+            QOL_Cmd compiler = {0};
+            qol_default_c_compiler(&compiler);
+            snprintf(pch_dir, sizeof(pch_dir), "%s/pch", obj_dir);
+            pch.dir = pch_dir;
+            bool prepared = qol_pch_prepare(&pch, compiler.data[0]);
+            qol_release(&compiler);
+            if (!prepared) {
+                qol_release_string(&objects);
+                return false;
             }
-            qol_push(&cmd_null, NULL); // NULL terminator required by execvp
+            pch_ptr = &pch;
+        }
+
+        QOL_UnityBatches batches = {0};
+        if (project->unity && !qol_unity_plan(project, obj_dir, &objects, opts.jobs > 0 ? opts.jobs : qol_nprocs(), &batches)) {
+            qol_log(QOL_LOG_WARN, "Building %s without unity batches\n", project->output);
+        }
 
-            // execvp: Replace current process with command (searches PATH for executable)
-            // Never returns on success (process image replaced)
-            if (execvp(cmd->data[0], (char * const*) cmd_null.data) < 0) {
-                // execvp failed (shouldn't happen if command exists)
-                // Free cmd_null before exiting to avoid memory leak
-                qol_release(&cmd_null);
-                qol_log(QOL_LOG_ERRO, "Could not exec process: %s\n", strerror(errno));
-                exit(1); // Exit child process with error
+        bool ok;
+        if (batches.len == 0) {
+            ok = qol_project_run(project, pch_ptr, &objects, &batches, opts);
+        } else {
+            // Let every batch try, then build the members of failed batches one by one
+            QOL_GraphOptions unity_opts = opts;
+            unity_opts.keep_going = true;
+            unity_opts.fail_fast = false;
+            ok = qol_project_run(project, pch_ptr, &objects, &batches, unity_opts);
+            size_t failed = 0;
+            for (size_t k = 0; k < batches.len; k++) {
+                if (!batches.data[k].failed) continue;
+                qol_log(QOL_LOG_WARN, "Unity batch %s failed, building its %zu sources on their own\n", batches.data[k].source, batches.data[k].members.len);
+                failed++;
+            }
+            if (failed > 0) {
+                ok = qol_project_run(project, pch_ptr, &objects, &batches, opts);
+                // The members compile alone, so two of them clash: keep the offender out of batches
+                // (another clash among the rest shows up, and is resolved, the next time)
+                char path[QOL_PATH_BUFFER_SIZE + 32];
+                snprintf(path, sizeof(path), "%s/unity/excluded", obj_dir);
+                FILE *fp = ok ? fopen(path, "ab") : NULL;
+                for (size_t k = 0; fp && k < batches.len; k++) {
+                    if (!batches.data[k].failed) continue;
+                    size_t offender = batches.data[k].members.data[qol_unity_find_clash(project, pch_ptr, obj_dir, &batches.data[k])];
+                    qol_log(QOL_LOG_INFO, "%s clashes with the sources before it in %s, compiling it on its own from now on\n",
+                            project->sources.data[offender], batches.data[k].source);
+                    fprintf(fp, "%s\n", project->sources.data[offender]);
+                }
+                if (fp) fclose(fp);
             }
-            QOL_UNREACHABLE("qol_cmd_execute_async"); // execvp never returns on success
         }
 
-        // Parent process: Return child PID for later waiting
-        return pid;
+        for (size_t k = 0; k < batches.len; k++) {
+            free(batches.data[k].source);
+            free(batches.data[k].object);
+            qol_release(&batches.data[k].members);
+        }
+        qol_release(&batches);
+        qol_release_string(&objects);
+        qol_pch_release(&pch);
+        return ok;
+    }
+
+    QOLDEF bool qol_project_build_impl(QOL_Project *project, QOL_GraphOptions opts) {
+        qol_stat_cache_begin();
+        bool ok = qol_project_build_run(project, opts);
+        qol_stat_cache_end();
+        return ok;
+    }
+
+    QOLDEF void qol_project_release(QOL_Project *project) {
+        if (!project) return;
+        qol_release(&project->sources);
+        qol_release(&project->cflags);
+        qol_release(&project->ldflags);
+        project->built = project->up_to_date = 0;
+    }
+
+    //////////////////////////////////////////////////
+    /// WATCH ////////////////////////////////////////
+    //////////////////////////////////////////////////
+
+    // Directory part of path as it is spelled there ("" for a bare file name)
+    static size_t qol_watch_dir_len(const char *path) {
+        const char *slash = strrchr(path, '/');
+#if defined(WINDOWS)
+        const char *backslash = strrchr(path, '\\');
+        if (backslash && (!slash || backslash > slash)) slash = backslash;
 #endif
+        return slash ? (size_t)(slash - path) : 0;
     }
 
-    QOLDEF bool qol_proc_wait(QOL_Proc proc) {
-        if (proc == QOL_INVALID_PROC) return false;
+    // Record path as changed (once) and forget its cached state
+    static void qol_watch_changed(const char *path, QOL_String *changed) {
+        qol_stat_invalidate(path);
+        if (!changed) return;
+        for (size_t i = 0; i < changed->len; i++) if (strcmp(changed->data[i], path) == 0) return;
+        char *copy = strdup(path);
+        if (!copy) abort();
+        qol_push(changed, copy);
+    }
 
-#ifdef WINDOWS
-        DWORD result = WaitForSingleObject(proc, INFINITE);
-        if (result == WAIT_FAILED) {
-            qol_log(QOL_LOG_ERRO, "Could not wait on child process: %s\n", qol_win32_error_message(GetLastError()));
-            CloseHandle(proc);
-            return false;
-        }
+    static bool qol_watch_same(const QOL_FileStat *a, const QOL_FileStat *b) {
+        return a->exists == b->exists && a->mtime_ns == b->mtime_ns && a->size == b->size;
+    }
 
-        DWORD exit_code;
-        if (!GetExitCodeProcess(proc, &exit_code)) {
-            qol_log(QOL_LOG_ERRO, "Could not get process exit code: %s\n", qol_win32_error_message(GetLastError()));
-            CloseHandle(proc);
-            return false;
+#if defined(LINUX)
+    typedef struct {
+        int wd;
+        const char *path;  // One of the watched paths in this directory (its directory part is the prefix)
+        size_t dir_len;
+    } QOL_WatchDir;
+
+    // Read pending inotify events. Returns true if one of them concerns a watched path.
+    static bool qol_watch_read(int fd, const QOL_WatchDir *dirs, size_t dir_count, QOL_HashMap *watched, QOL_String *changed) {
+        bool hit = false;
+        char buffer[16 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+        ssize_t n;
+        while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char *p = buffer; p < buffer + n; p += sizeof(struct inotify_event) + ((struct inotify_event*)p)->len) {
+                const struct inotify_event *event = (const struct inotify_event*)p;
+                if (event->len == 0) continue;
+                // The same directory may be spelled differently by different paths ("src", "./src")
+                for (size_t i = 0; i < dir_count; i++) {
+                    if (dirs[i].wd != event->wd) continue;
+                    char full[QOL_PATH_BUFFER_SIZE];
+                    if (dirs[i].dir_len > 0) snprintf(full, sizeof(full), "%.*s/%s", (int)dirs[i].dir_len, dirs[i].path, event->name);
+                    else snprintf(full, sizeof(full), "%s", event->name);
+                    if (!qol_hm_get(watched, full)) continue;
+                    qol_watch_changed(full, changed);
+                    hit = true;
+                }
+            }
         }
+        return hit;
+    }
+#endif
 
-        CloseHandle(proc);
+    QOLDEF bool qol_watch_wait(const char **paths, size_t count, size_t settle_ms, QOL_String *changed) {
+        if (!paths || count == 0) return false;
+        if (settle_ms == 0) settle_ms = QOL_WATCH_SETTLE_MS;
 
-        if (exit_code != 0) {
-            qol_log(QOL_LOG_ERRO, "Command failed with exit code %lu\n", exit_code);
+        // What the last build saw: anything that differs already changed
+        QOL_FileStat *seen = (QOL_FileStat*)malloc(count * sizeof(QOL_FileStat));
+        if (!seen) abort();
+        qol_stat_last_build(paths, count, seen);
+
+#if defined(LINUX)
+        int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd < 0) {
+            qol_log(QOL_LOG_ERRO, "Could not start watching: %s\n", strerror(errno));
+            free(seen);
             return false;
         }
+        QOL_HashMap *watched = qol_hm_create();
+        QOL_HashMap *dir_seen = qol_hm_create();
+        if (!watched || !dir_seen) abort();
+        qol_list(QOL_WatchDir) dirs = {0};
+        const uint32_t mask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_ATTRIB;
+        for (size_t i = 0; i < count; i++) {
+            qol_hm_put(watched, (void*)paths[i], (void*)1);
+            size_t dir_len = qol_watch_dir_len(paths[i]);
+            char dir[QOL_PATH_BUFFER_SIZE];
+            snprintf(dir, sizeof(dir), "%.*s", (int)dir_len, paths[i]);
+            if (dir_len == 0) snprintf(dir, sizeof(dir), "%s", paths[i][0] == '/' ? "/" : ".");
+            if (qol_hm_get(dir_seen, dir)) continue;
+            qol_hm_put(dir_seen, dir, (void*)1);
+            int wd = inotify_add_watch(fd, dir, mask);
+            if (wd < 0) {
+                qol_log(QOL_LOG_WARN, "Could not watch %s: %s\n", dir, strerror(errno));
+                continue;
+            }
+            qol_push(&dirs, ((QOL_WatchDir){ .wd = wd, .path = paths[i], .dir_len = dir_len }));
+        }
+        qol_hm_release(dir_seen);
 
-        return true;
-#else
-        int wstatus;
-        if (waitpid(proc, &wstatus, 0) < 0) {
-            qol_log(QOL_LOG_ERRO, "Could not wait for process: %s\n", strerror(errno));
-            return false;
+        // Changed between the build and now (the watches are in place, nothing gets lost from here)
+        bool hit = false;
+        for (size_t i = 0; i < count; i++) {
+            QOL_FileStat now;
+            qol_stat_query(paths[i], &now);
+            if (qol_watch_same(&seen[i], &now)) continue;
+            qol_watch_changed(paths[i], changed);
+            hit = true;
         }
 
-        if (WIFEXITED(wstatus)) {
-            int exit_code = WEXITSTATUS(wstatus);
-            if (exit_code != 0) {
-                qol_log(QOL_LOG_ERRO, "Command failed with exit code %d\n", exit_code);
-                return false;
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        while (!hit && dirs.len > 0) {
+            int ready = poll(&pfd, 1, -1); // Idle: no CPU until the kernel reports an event
+            if (ready < 0 && errno == EINTR) {
+                if (qol_interrupted) qol_interrupt_cleanup();
+                continue;
             }
-        } else if (WIFSIGNALED(wstatus)) {
-            qol_log(QOL_LOG_ERRO, "Command terminated by signal %d\n", WTERMSIG(wstatus));
-            return false;
+            if (ready < 0) break;
+            hit = qol_watch_read(fd, dirs.data, dirs.len, watched, changed);
         }
+        // One save is often several events (write, rename, chmod): collect them before building
+        while (hit && poll(&pfd, 1, (int)settle_ms) > 0) qol_watch_read(fd, dirs.data, dirs.len, watched, changed);
 
+        close(fd);
+        qol_release(&dirs);
+        qol_hm_release(watched);
+        free(seen);
+        return hit;
+#else
+        // Polling: compare against the last build's view every QOL_WATCH_POLL_MS
+        bool hit = false;
+        while (!hit) {
+            for (size_t i = 0; i < count; i++) {
+                QOL_FileStat now;
+                qol_stat_query(paths[i], &now);
+                if (qol_watch_same(&seen[i], &now)) continue;
+                qol_watch_changed(paths[i], changed);
+                hit = true;
+            }
+            if (hit) break;
+    #if defined(WINDOWS)
+            Sleep(QOL_WATCH_POLL_MS);
+    #else
+            poll(NULL, 0, QOL_WATCH_POLL_MS);
+    #endif
+            if (qol_interrupted) qol_interrupt_cleanup();
+        }
+    #if defined(WINDOWS)
+        Sleep((DWORD)settle_ms);
+    #else
+        poll(NULL, 0, (int)settle_ms);
+    #endif
+        for (size_t i = 0; i < count; i++) {
+            QOL_FileStat now;
+            qol_stat_query(paths[i], &now);
+            if (!qol_watch_same(&seen[i], &now)) qol_watch_changed(paths[i], changed);
+        }
+        free(seen);
         return true;
 #endif
     }
 
-    QOLDEF bool qol_procs_wait(QOL_Procs *procs) {
-        if (!procs) return false;
+    // Add the build script and the headers it was compiled with (recorded by qol_auto_rebuild)
+    static void qol_watch_add_script(const char *script, QOL_String *paths) {
+        if (!script) return;
+        char *copy = strdup(script);
+        if (!copy) abort();
+        qol_push(paths, copy);
+#if defined(WINDOWS)
+        qol_deps_get("build_new.exe", paths);
+#else
+        char *out = qol_get_filename_no_ext(script);
+        if (out) qol_deps_get(out, paths);
+        free(out);
+#endif
+    }
 
-        bool all_success = true;
-        for (size_t i = 0; i < procs->len; i++) {
-            if (procs->data[i] != QOL_INVALID_PROC) {
-                if (!qol_proc_wait(procs->data[i])) {
-                    all_success = false;
+    // Wait for a change of paths; a change of the build script (or its headers) re-executes it.
+    // Returns false if nothing can be watched.
+    static bool qol_watch_next(const char *script, QOL_String *paths, size_t settle_ms) {
+        // Deduplicate: sources are inputs of a target and in its recorded deps
+        QOL_HashMap *unique = qol_hm_create();
+        if (!unique) abort();
+        size_t len = 0;
+        for (size_t i = 0; i < paths->len; i++) {
+            if (qol_hm_get(unique, paths->data[i])) {
+                free(paths->data[i]);
+                continue;
+            }
+            qol_hm_put(unique, paths->data[i], (void*)1);
+            paths->data[len++] = paths->data[i];
+        }
+        paths->len = len;
+        qol_hm_release(unique);
+
+        qol_log(QOL_LOG_INFO, "Watching %zu files for changes...\n", paths->len);
+        QOL_String changed = {0};
+        bool ok = qol_watch_wait((const char**)paths->data, paths->len, settle_ms, &changed);
+        for (size_t i = 0; i < changed.len; i++) qol_log(QOL_LOG_INFO, "Changed: %s\n", changed.data[i]);
+        qol_release_string(&changed);
+        qol_release_string(paths);
+        if (ok && script) qol_auto_rebuild(script); // Does not return if the script is stale
+        return ok;
+    }
+
+    QOLDEF bool qol_graph_watch_impl(QOL_Graph *graph, QOL_WatchOptions opts) {
+        if (!graph) return false;
+        for (;;) {
+            qol_graph_build_impl(graph, opts.build); // Failures are reported; the next save retries
+
+            // Inputs nobody in the graph produces, plus what the compiler reported
+            QOL_HashMap *produced = qol_hm_create();
+            if (!produced) abort();
+            for (size_t i = 0; i < graph->len; i++) {
+                for (size_t j = 0; j < graph->data[i]->outputs.len; j++) qol_hm_put(produced, (void*)graph->data[i]->outputs.data[j], (void*)1);
+            }
+            QOL_String paths = {0};
+            for (size_t i = 0; i < graph->len; i++) {
+                QOL_Target *target = graph->data[i];
+                for (size_t j = 0; j < target->inputs.len; j++) {
+                    if (qol_hm_get(produced, (void*)target->inputs.data[j])) continue;
+                    char *copy = strdup(target->inputs.data[j]);
+                    if (!copy) abort();
+                    qol_push(&paths, copy);
                 }
+                if (target->depfile) qol_deps_get(target->outputs.data[0], &paths);
+            }
+            // Recorded deps include generated headers: those are rebuilt, not watched
+            size_t len = 0;
+            for (size_t i = 0; i < paths.len; i++) {
+                if (qol_hm_get(produced, paths.data[i])) free(paths.data[i]);
+                else paths.data[len++] = paths.data[i];
             }
+            paths.len = len;
+            qol_hm_release(produced);
+            qol_watch_add_script(opts.script, &paths);
+            if (!qol_watch_next(opts.script, &paths, opts.settle_ms)) return false;
         }
-        procs->len = 0;
-        return all_success;
     }
 
-    QOLDEF bool qol_run_impl(QOL_Cmd* config, QOL_RunOptions opts) {
-        if (!config || !config->data || config->len == 0) {
-            qol_log(QOL_LOG_ERRO, "Invalid build configuration\n");
-            if (config) qol_release(config);
-            return false;
+    QOLDEF bool qol_project_watch_impl(QOL_Project *project, QOL_WatchOptions opts) {
+        if (!project) return false;
+        char obj_dir[QOL_PATH_BUFFER_SIZE];
+        char path[QOL_PATH_BUFFER_SIZE + 32];
+        for (;;) {
+            qol_project_build_impl(project, opts.build); // Failures are reported; the next save retries
+
+            qol_project_obj_dir(project, obj_dir, sizeof(obj_dir));
+            QOL_String paths = {0};
+            for (size_t i = 0; i < project->sources.len; i++) {
+                char *copy = strdup(project->sources.data[i]);
+                if (!copy) abort();
+                qol_push(&paths, copy);
+                char *object = qol_project_object_path(obj_dir, project->sources.data[i]);
+                qol_deps_get(object, &paths);
+                free(object);
+            }
+            for (size_t k = 0; project->unity; k++) {
+                snprintf(path, sizeof(path), "%s/unity/unity_%zu.o", obj_dir, k);
+                if (!qol_deps_get(path, &paths)) break;
+            }
+            if (project->pch) {
+                char *copy = strdup(project->pch);
+                if (!copy) abort();
+                qol_push(&paths, copy);
+            }
+            // Generated files below the object directory (unity batches, PCH wrapper) are not inputs
+            size_t len = 0, dir_len = strlen(obj_dir);
+            for (size_t i = 0; i < paths.len; i++) {
+                if (strncmp(paths.data[i], obj_dir, dir_len) == 0) free(paths.data[i]);
+                else paths.data[len++] = paths.data[i];
+            }
+            paths.len = len;
+            qol_watch_add_script(opts.script, &paths);
+            if (!qol_watch_next(opts.script, &paths, opts.settle_ms)) return false;
         }
+    }
 
-        const char *source = qol_cmd_get_source(config);
-        const char *output = qol_cmd_get_output(config);
-        
-        if (!source || !output) {
-            qol_log(QOL_LOG_DIAG, "Could not extract source or output from command. Run the command anyway.\n");
-            // TODO: should we rather exit with false and do something like this?
-            // if (opts.cmd) return qol_run_always_impl(config, opts);
-            return qol_run_always_impl(config, opts);
+    static bool qol_cmd_has_arg(const QOL_Cmd *cmd, const char *arg) {
+        for (size_t i = 0; i < cmd->len; i++) {
+            if (strcmp(cmd->data[i], arg) == 0) return true;
         }
+        return false;
+    }
 
-        qol_ensure_dir_for_file(output);
+    // Decide whether a single target is stale, ignoring its dependencies
+    static bool qol_target_is_stale(QOL_Target *target) {
+        if (target->outputs.len == 0) return true; // Nothing to compare against: always run
+        uint64_t hash = qol_cmd_hash(&target->cmd);
+        for (size_t i = 0; i < target->outputs.len; i++) {
+            if (qol_needs_rebuild(target->outputs.data[i], target->inputs.data, target->inputs.len) != 0) {
+                return true; // Out of date, missing output or missing input (let the command report it)
+            }
+            if (qol_build_log_cmd_changed(target->outputs.data[i], hash)) return true;
+        }
+        if (target->depfile) {
+            const char *output = target->outputs.data[0];
+            qol_deps_ingest(output, target->depfile);
+            if (qol_deps_check(output) != 0) return true; // Header changed, or deps not learned yet
+        }
+        return false;
+    }
 
-        if (!qol_is_path1_modified_after_path2(source, output)) {
-            qol_log(QOL_LOG_DIAG, "Up to date: %s\n", output);
-            qol_release(config);
-            return true;
+    // Mark a target and everything downstream of it dirty (a restat dependency did change its outputs)
+    static void qol_graph_mark_dirty(QOL_Graph *graph, size_t index) {
+        QOL_Target *target = graph->data[index];
+        if (target->dirty) return;
+        target->dirty = true;
+        for (size_t i = 0; i < target->dependents.len; i++) {
+            if (target->restat) graph->data[target->dependents.data[i]]->recheck = true;
+            else qol_graph_mark_dirty(graph, target->dependents.data[i]);
         }
+    }
+
+    // Queue of target indices that are ready to run (all dependencies finished)
+    typedef qol_list(size_t) QOL_GraphQueue;
 
-        return qol_run_always_impl(config, opts);
+    // Mark a finished target and move dependents whose last dependency just finished to the ready queue
+    static void qol_graph_finish(QOL_Graph *graph, size_t index, QOL_GraphQueue *ready) {
+        QOL_Target *target = graph->data[index];
+        target->done = true;
+        for (size_t i = 0; i < target->dependents.len; i++) {
+            QOL_Target *dependent = graph->data[target->dependents.data[i]];
+            if (--dependent->pending == 0) qol_push(ready, target->dependents.data[i]);
+        }
     }
 
-    QOLDEF bool qol_run_always_impl(QOL_Cmd* config, QOL_RunOptions opts) {
-        if (!config || !config->data || config->len == 0) {
-            qol_log(QOL_LOG_ERRO, "Invalid build configuration\n");
-            if (config) qol_release(config);
+    // Memory estimate of a target's command, 0 when no budget is enforced
+    static size_t qol_graph_mem_kb(const QOL_Target *target, size_t budget_mb) {
+        if (budget_mb == 0) return 0;
+        return qol_mem_estimate_kb(target->outputs.len > 0 ? target->outputs.data[0] : NULL);
+    }
+
+    static bool qol_graph_build_run(QOL_Graph *graph, QOL_GraphOptions opts) {
+        if (!graph) return false;
+        graph->built = graph->up_to_date = 0;
+        if (graph->len == 0) return true;
+
+        size_t jobs = opts.jobs > 0 ? opts.jobs : qol_nprocs();
+
+        // Reset scheduler state and fill in implicit inputs/outputs
+        for (size_t i = 0; i < graph->len; i++) {
+            QOL_Target *target = graph->data[i];
+            target->dependents.len = 0;
+            target->pending = 0;
+            target->dirty = false;
+            target->recheck = false;
+            target->done = false;
+            if (target->inputs.len == 0 && target->outputs.len == 0) {
+                const char *source = qol_cmd_get_source(&target->cmd);
+                const char *output = qol_cmd_get_output(&target->cmd);
+                if (source) qol_push(&target->inputs, source);
+                if (output) qol_push(&target->outputs, output);
+            }
+            target->pool_index = 0;
+            if (target->pool && !(target->pool_index = qol_pool_index(target->pool))) return false;
+            if (target->deps && !target->depfile && target->outputs.len == 1) {
+                size_t size = strlen(target->outputs.data[0]) + sizeof(".d");
+                target->depfile = (char*)malloc(size);
+                if (!target->depfile) return false;
+                snprintf(target->depfile, size, "%s.d", target->outputs.data[0]);
+            }
+        }
+
+        // Map every output to its producing target (index + 1, since the hashmap rejects NULL values)
+        QOL_HashMap *producers = qol_hm_create();
+        if (!producers) return false;
+        bool ok = true;
+        for (size_t i = 0; i < graph->len && ok; i++) {
+            QOL_Target *target = graph->data[i];
+            for (size_t j = 0; j < target->outputs.len; j++) {
+                void *key = (void*)target->outputs.data[j];
+                if (qol_hm_contains(producers, key)) {
+                    qol_log(QOL_LOG_ERRO, "Multiple targets produce `%s`\n", target->outputs.data[j]);
+                    ok = false;
+                    break;
+                }
+                qol_hm_put(producers, key, (void*)(uintptr_t)(i + 1));
+            }
+        }
+
+        // Create edges: producer -> consumer
+        for (size_t i = 0; i < graph->len && ok; i++) {
+            QOL_Target *target = graph->data[i];
+            for (size_t j = 0; j < target->inputs.len; j++) {
+                uintptr_t producer = (uintptr_t)qol_hm_get(producers, (void*)target->inputs.data[j]);
+                if (producer == 0 || producer - 1 == i) continue;
+                qol_push(&graph->data[producer - 1]->dependents, i);
+                target->pending++;
+            }
+        }
+        qol_hm_release(producers);
+        if (!ok) return false;
+
+        // Topological sort (Kahn's algorithm) on a copy of the pending counters
+        QOL_GraphQueue order = {0};
+        size_t *indegree = (size_t*)malloc(graph->len * sizeof(size_t));
+        if (!indegree) return false;
+        for (size_t i = 0; i < graph->len; i++) {
+            indegree[i] = graph->data[i]->pending;
+            if (indegree[i] == 0) qol_push(&order, i);
+        }
+        for (size_t k = 0; k < order.len; k++) {
+            QOL_Target *target = graph->data[order.data[k]];
+            for (size_t j = 0; j < target->dependents.len; j++) {
+                if (--indegree[target->dependents.data[j]] == 0) qol_push(&order, target->dependents.data[j]);
+            }
+        }
+        free(indegree);
+        if (order.len != graph->len) {
+            qol_log(QOL_LOG_ERRO, "Dependency cycle detected in build graph (%zu of %zu targets sortable)\n", order.len, graph->len);
+            qol_release(&order);
             return false;
         }
 
-        QOL_Proc proc;
-        if (opts.procs) {
-            proc = qol_cmd_execute_async(config);
-            if (proc == QOL_INVALID_PROC) {
-                qol_release(config);
-                return false;
+        // Fetch the metadata of every path the staleness checks will look at in one batch
+        QOL_String paths = {0};
+        for (size_t i = 0; i < graph->len; i++) {
+            QOL_Target *target = graph->data[i];
+            for (size_t j = 0; j < target->inputs.len; j++) qol_push(&paths, strdup(target->inputs.data[j]));
+            for (size_t j = 0; j < target->outputs.len; j++) qol_push(&paths, strdup(target->outputs.data[j]));
+            if (target->depfile) qol_deps_get(target->outputs.data[0], &paths);
+        }
+        for (size_t i = 0; i < paths.len; i++) if (!paths.data[i]) abort();
+        qol_stat_batch((const char**)paths.data, paths.len, NULL);
+        qol_release_string(&paths);
+
+        // Staleness spreads along the edges: in topological order every dependency is decided first.
+        // Behind a restat target it stops: whether its outputs change is only known once it ran.
+        for (size_t k = 0; k < order.len; k++) {
+            QOL_Target *target = graph->data[order.data[k]];
+            if (!target->dirty) target->dirty = qol_target_is_stale(target);
+            if (!target->dirty) continue;
+            for (size_t j = 0; j < target->dependents.len; j++) {
+                QOL_Target *dependent = graph->data[target->dependents.data[j]];
+                if (target->restat) dependent->recheck = true;
+                else dependent->dirty = true;
             }
-            if (opts.procs) {
-                qol_push(opts.procs, proc);
+        }
+
+        // Longest path first: a target's priority is its expected duration plus the highest priority
+        // among its dependents. Commands the build log does not know are assumed to take the average.
+        QOL_GraphSchedule schedule = { .jobs = jobs };
+        uint64_t known_ms = 0;
+        for (size_t i = 0; i < graph->len; i++) {
+            QOL_Target *target = graph->data[i];
+            target->estimate_ms = target->priority_ms = 0;
+            if (!target->dirty && !target->recheck) continue;
+            schedule.commands++;
+            QOL_BuildLogEntry entry;
+            if (target->outputs.len > 0 && qol_build_log_get(target->outputs.data[0], &entry)) {
+                target->estimate_ms = entry.duration_ms;
+                known_ms += entry.duration_ms;
+            } else {
+                target->estimate_ms = UINT64_MAX;
+                schedule.unknown++;
             }
-            qol_release(config);
-            return true;
-        } else {
-            proc = qol_cmd_execute_async(config);
+        }
+        uint64_t average_ms = schedule.commands > schedule.unknown ? known_ms / (schedule.commands - schedule.unknown) : 1;
+        for (size_t k = order.len; k-- > 0;) {
+            QOL_Target *target = graph->data[order.data[k]];
+            if (target->estimate_ms == UINT64_MAX) target->estimate_ms = average_ms;
+            uint64_t tail = 0;
+            for (size_t j = 0; j < target->dependents.len; j++) {
+                uint64_t priority = graph->data[target->dependents.data[j]]->priority_ms;
+                if (priority > tail) tail = priority;
+            }
+            target->priority_ms = target->estimate_ms + tail;
+            schedule.work_ms += target->estimate_ms;
+            if (target->priority_ms > schedule.critical_ms) schedule.critical_ms = target->priority_ms;
+        }
+        schedule.estimated_ms = schedule.work_ms / jobs > schedule.critical_ms ? schedule.work_ms / jobs : schedule.critical_ms;
+
+        // Run ready targets in parallel, refilling slots in completion order
+        if (opts.jobserver) qol_jobserver_init(jobs);
+        else qol_jobserver_join();
+        QOL_GraphQueue ready = {0};
+        for (size_t i = 0; i < graph->len; i++) {
+            if (graph->data[i]->pending == 0) qol_push(&ready, i);
+        }
+        qol_release(&order);
+        QOL_Timer wall = {0};
+        qol_timer_start(&wall);
+
+        typedef struct { QOL_Proc proc; size_t index; } QOL_GraphJob;
+        qol_list(QOL_GraphJob) running = {0};
+        QOL_Procs procs = { .fail_fast = opts.fail_fast };
+        bool keep_going = opts.keep_going && !opts.fail_fast;
+        bool failed = false;
+
+        for (;;) {
+            while (!(failed && !keep_going) && ready.len > 0 && running.len < jobs) {
+                // Take the ready target with the longest chain ahead that the pools and the memory budget
+                // admit; up to date targets always go first. If nothing is admitted, wait for a running
+                // command (or force the first target when nothing runs).
+                size_t pick = ready.len;
+                for (size_t i = 0; i < ready.len; i++) {
+                    QOL_Target *candidate = graph->data[ready.data[i]];
+                    if (!candidate->dirty) {
+                        pick = i;
+                        break;
+                    }
+                    if (pick < ready.len && (opts.fifo || candidate->priority_ms <= graph->data[ready.data[pick]]->priority_ms)) continue;
+                    if (qol_sched_admit(graph, candidate->pool_index, candidate->weight ? candidate->weight : 1,
+                                        qol_graph_mem_kb(candidate, opts.mem_budget_mb), opts.mem_budget_mb, NULL)) pick = i;
+                }
+                if (pick == ready.len) {
+                    if (running.len > 0) break;
+                    pick = 0;
+                }
+                size_t index = ready.data[pick];
+                qol_dropn(&ready, pick);
+                QOL_Target *target = graph->data[index];
+
+                if (!target->dirty && target->recheck && qol_target_is_stale(target)) qol_graph_mark_dirty(graph, index);
+                if (!target->dirty) {
+                    graph->up_to_date++;
+                    qol_graph_finish(graph, index, &ready);
+                    continue;
+                }
+                bool slot = false;
+                if (!qol_jobserver_take(&procs, &slot)) {
+                    qol_push(&ready, index); // A command exited while waiting for a token: reap it first
+                    break;
+                }
+
+                // Outputs are recorded in the build log (and the depfile ingested) when the job is reaped
+                QOL_Job job = { .hash = qol_cmd_hash(&target->cmd) };
+                for (size_t j = 0; j < target->outputs.len; j++) {
+                    qol_ensure_dir_for_file(target->outputs.data[j]);
+                    char *copy = strdup(target->outputs.data[j]);
+                    if (!copy) abort();
+                    qol_push(&job.outputs, copy);
+                }
+
+                // Extra flags go into a launch copy so that the target's command (and its hash) stays as written
+                QOL_Cmd launch = {0};
+                for (size_t j = 0; j < target->cmd.len; j++) qol_push(&launch, target->cmd.data[j]);
+                if (target->depfile && !qol_cmd_has_arg(&target->cmd, "-MMD")) {
+                    qol_push(&launch, "-MMD", "-MF", target->depfile);
+                    job.depfile = strdup(target->depfile);
+                    if (!job.depfile) abort();
+                }
+                if (opts.results) {
+                    job.results = opts.results;
+                    job.name = qol_cmd_label(&target->cmd);
+                }
+                if (target->timeout_ms && !job.name) job.name = qol_cmd_label(&target->cmd);
+                job.group = true;
+                job.timeout_ms = target->timeout_ms;
+                job.restat = target->restat;
+                job.owner = graph;
+                job.pool = target->pool_index;
+                job.weight = target->weight ? target->weight : 1;
+                job.mem_kb = qol_graph_mem_kb(target, opts.mem_budget_mb);
+                job.slot = slot;
+                qol_timer_start(&job.timer);
+                QOL_Proc proc = qol_job_spawn(&launch, &job, opts.capture, opts.capture_max);
+                qol_release(&launch);
+                if (proc == QOL_INVALID_PROC) {
+                    if (job.slot) qol_jobserver_give();
+                    qol_job_release(&job);
+                    failed = true;
+                    continue;
+                }
+                job.proc = proc;
+                qol_job_start(&job);
+                QOL_GraphJob running_job = { .proc = proc, .index = index };
+                qol_push(&running, running_job);
+                qol_push(&procs, proc);
+            }
+
+            if (running.len == 0) break;
+
+            bool success = false;
+            QOL_Proc proc = qol_procs_wait_any(&procs, &success);
             if (proc == QOL_INVALID_PROC) {
-                qol_release(config);
-                return false;
+                failed = true;
+                break;
             }
-            bool success = qol_proc_wait(proc);
-            qol_release(config);
-            return success;
+            for (size_t i = 0; i < running.len; i++) {
+                if (running.data[i].proc != proc) continue;
+                size_t index = running.data[i].index;
+                qol_dropn(&running, i);
+                if (success) {
+                    graph->built++;
+                    qol_graph_finish(graph, index, &ready);
+                } else {
+                    failed = true; // Dependents stay pending and are never started
+                }
+                break;
+            }
+        }
+
+        qol_release(&ready);
+        qol_release(&running);
+        qol_release(&procs);
+
+        for (size_t i = 0; i < graph->len; i++) {
+            if (!graph->data[i]->done) failed = true;
+        }
+        qol_log(QOL_LOG_DIAG, "Build graph: %zu targets, %zu built, %zu up to date\n", graph->len, graph->built, graph->up_to_date);
+        schedule.actual_ms = qol_timer_elapsed_ns(&wall) / 1000000;
+        if (graph->built > 0) {
+            qol_log(QOL_LOG_DIAG, "Schedule: expected %llu ms (critical path %llu ms), took %llu ms\n", (unsigned long long)schedule.estimated_ms,
+                    (unsigned long long)schedule.critical_ms, (unsigned long long)schedule.actual_ms);
+        }
+        if (opts.schedule) {
+            opts.schedule->commands += schedule.commands;
+            opts.schedule->unknown += schedule.unknown;
+            opts.schedule->jobs = schedule.jobs;
+            opts.schedule->work_ms += schedule.work_ms;
+            if (schedule.critical_ms > opts.schedule->critical_ms) opts.schedule->critical_ms = schedule.critical_ms;
+            opts.schedule->estimated_ms += schedule.estimated_ms;
+            opts.schedule->actual_ms += schedule.actual_ms;
         }
+        return !failed;
+    }
+
+    QOLDEF bool qol_graph_build_impl(QOL_Graph *graph, QOL_GraphOptions opts) {
+        qol_stat_cache_begin();
+        bool ok = qol_graph_build_run(graph, opts);
+        qol_stat_cache_end();
+        return ok;
+    }
+
+    QOLDEF void qol_graph_schedule_report(const QOL_GraphSchedule *schedule) {
+        if (!schedule) return;
+        if (schedule->commands == 0) {
+            qol_log(QOL_LOG_INFO, "Schedule: nothing to build\n");
+            return;
+        }
+        qol_log(QOL_LOG_INFO, "Schedule: %zu commands, %.1f s of expected work on %zu jobs\n", schedule->commands,
+                (double)schedule->work_ms / 1000.0, schedule->jobs);
+        if (schedule->unknown > 0) qol_log(QOL_LOG_INFO, "  %zu commands without history (assumed average)\n", schedule->unknown);
+        qol_log(QOL_LOG_INFO, "  expected wall time : %8.1f s (critical path %.1f s)\n", (double)schedule->estimated_ms / 1000.0,
+                (double)schedule->critical_ms / 1000.0);
+        qol_log(QOL_LOG_INFO, "  actual wall time   : %8.1f s (%.0f%% of expected)\n", (double)schedule->actual_ms / 1000.0,
+                schedule->estimated_ms > 0 ? 100.0 * (double)schedule->actual_ms / (double)schedule->estimated_ms : 100.0);
     }
 
     //////////////////////////////////////////////////
@@ -2459,23 +8269,6 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
         QOL_MUTEX_UNLOCK(qol_temp_alloc_mutex);
     }
 
-    //////////////////////////////////////////////////
-    /// AUTO_FREE ////////////////////////////////////
-    //////////////////////////////////////////////////
-
-    // Generic cleanup function that works with any pointer type.
-    // Uses a union to allow type-punning for the cleanup attribute's strict type checking.
-    // The cleanup attribute passes the address of the variable, which we cast to void**.
-    static inline void _qol_auto_free_impl(void *p) {
-        // Cast the void* to void** to access the pointer value
-        void **ptr = (void **)p;
-        if (ptr && *ptr) {
-            qol_diag("Auto-free: freeing memory at %p\n", *ptr);
-            free(*ptr);
-            *ptr = NULL;
-        }
-    }
-
     //////////////////////////////////////////////////
     /// FILE_OPS /////////////////////////////////////
     //////////////////////////////////////////////////
@@ -2495,6 +8288,7 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
     }
 
     QOLDEF bool qol_mkdir(const char *path) {
+        qol_stat_invalidate(path);
 #ifdef _WIN32
         int result = _mkdir(path);
 #else
@@ -2510,6 +8304,7 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 
     QOLDEF bool qol_copy_file(const char *src_path, const char *dst_path) {
         if (!src_path || !dst_path) return false;
+        qol_stat_invalidate(dst_path);
 
         FILE *src = fopen(src_path, "rb");
         if (!src) {
@@ -2543,6 +8338,7 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 
     QOLDEF bool qol_copy_dir_rec(const char *src_path, const char *dst_path) {
         if (!src_path || !dst_path) return false;
+        qol_stat_invalidate(NULL); // A whole tree changes
 
 #if defined(MACOS) || defined(LINUX)
         DIR *dir = opendir(src_path);
@@ -2873,6 +8669,7 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 
     QOLDEF bool qol_write_file(const char *path, const void *data, size_t size) {
         if (!path || !data) return false;
+        qol_stat_invalidate(path);
 
         FILE *fp = fopen(path, "wb");
         if (!fp) {
@@ -2903,6 +8700,7 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 
     QOLDEF bool qol_delete_file(const char *path) {
         if (!path) return false;
+        qol_stat_invalidate(path);
 
 #if defined(MACOS) || defined(LINUX)
         if (unlink(path) != 0) {
@@ -2927,6 +8725,7 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
 
     QOLDEF bool qol_delete_dir(const char *path) {
         if (!path) return false;
+        qol_stat_invalidate(NULL); // A whole tree changes
 
 #if defined(MACOS) || defined(LINUX)
         DIR *dir = opendir(path);
@@ -3309,6 +9108,8 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
     }
 
     QOLDEF bool qol_rename(const char *old_path, const char *new_path) {
+        qol_stat_invalidate(old_path);
+        qol_stat_invalidate(new_path);
         qol_log(QOL_LOG_INFO, "renaming %s -> %s\n", old_path, new_path);
 #ifdef WINDOWS
         if (!MoveFileEx(old_path, new_path, MOVEFILE_REPLACE_EXISTING)) {
@@ -3382,75 +9183,39 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
     }
 
     QOLDEF int qol_needs_rebuild(const char *output_path, const char **input_paths, size_t input_paths_count) {
-#ifdef WINDOWS
-        // Windows: Use FILETIME (100-nanosecond intervals since 1601) for precise comparison
-        BOOL bSuccess;
-
-        // Get output file modification time
-        HANDLE output_path_fd = CreateFile(output_path, GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, NULL);
-        if (output_path_fd == INVALID_HANDLE_VALUE) {
-            // Output doesn't exist: rebuild needed
-            if (GetLastError() == ERROR_FILE_NOT_FOUND) return 1;
-            qol_log(QOL_LOG_ERRO, "Could not open file %s: %s\n", output_path, qol_win32_error_message(GetLastError()));
+        QOL_FileStat output;
+        int64_t output_mtime, input_mtime;
+        if (!qol_file_mtime_ns(output_path, &output_mtime)) {
+            bool missing; // As opposed to not queryable (permissions, I/O error)
+            qol_stat_query_cacheable(output_path, &output, &missing);
+            if (missing) return 1; // Output doesn't exist: rebuild needed
+            qol_log(QOL_LOG_ERRO, "could not stat %s\n", output_path);
             return -1;
         }
-        FILETIME output_path_time;
-        // GetFileTime: NULL for creation/access time, we only need modification time
-        bSuccess = GetFileTime(output_path_fd, NULL, NULL, &output_path_time);
-        CloseHandle(output_path_fd);
-        if (!bSuccess) {
-            qol_log(QOL_LOG_ERRO, "Could not get time of %s: %s\n", output_path, qol_win32_error_message(GetLastError()));
-            return -1;
+        // Large input sets are stat'ed in one batch (see qol_deps_check())
+        QOL_FileStat *stats = NULL;
+        if (input_paths_count >= QOL_STAT_BATCH_MIN) {
+            stats = (QOL_FileStat*)malloc(input_paths_count * sizeof(*stats));
+            if (!stats) abort();
+            qol_stat_batch(input_paths, input_paths_count, stats);
         }
 
         // Check each input file: if any is newer than output, rebuild needed
+        int result = 0; // All inputs are older than output: no rebuild needed
         for (size_t i = 0; i < input_paths_count; ++i) {
-            const char *input_path = input_paths[i];
-            HANDLE input_path_fd = CreateFile(input_path, GENERIC_READ, 0, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, NULL);
-            if (input_path_fd == INVALID_HANDLE_VALUE) {
-                qol_log(QOL_LOG_ERRO, "Could not open file %s: %s\n", input_path, qol_win32_error_message(GetLastError()));
-                return -1;
-            }
-            FILETIME input_path_time;
-            bSuccess = GetFileTime(input_path_fd, NULL, NULL, &input_path_time);
-            CloseHandle(input_path_fd);
-            if (!bSuccess) {
-                qol_log(QOL_LOG_ERRO, "Could not get time of %s: %s\n", input_path, qol_win32_error_message(GetLastError()));
-                return -1;
+            bool exists = stats ? qol_input_mtime_from(input_paths[i], &stats[i], &input_mtime) : qol_input_mtime_ns(input_paths[i], &input_mtime);
+            if (!exists) {
+                qol_log(QOL_LOG_ERRO, "could not stat %s\n", input_paths[i]);
+                result = -1;
+                break;
             }
-
-            // CompareFileTime returns 1 if input_path_time > output_path_time (input is newer)
-            if (CompareFileTime(&input_path_time, &output_path_time) == 1) return 1;
-        }
-
-        return 0; // All inputs are older than output: no rebuild needed
-#else
-        // Unix: Use stat() to get modification time (seconds since epoch)
-        struct stat statbuf = {0};
-
-        // Get output file modification time
-        if (stat(output_path, &statbuf) < 0) {
-            // Output doesn't exist: rebuild needed
-            if (errno == ENOENT) return 1;
-            qol_log(QOL_LOG_ERRO, "could not stat %s: %s\n", output_path, strerror(errno));
-            return -1;
-        }
-        int output_path_time = statbuf.st_mtime; // Modification time (seconds since epoch)
-
-        // Check each input file: if any is newer than output, rebuild needed
-        for (size_t i = 0; i < input_paths_count; ++i) {
-            const char *input_path = input_paths[i];
-            if (stat(input_path, &statbuf) < 0) {
-                qol_log(QOL_LOG_ERRO, "could not stat %s: %s\n", input_path, strerror(errno));
-                return -1;
+            if (input_mtime > output_mtime) {
+                result = 1;
+                break;
             }
-            int input_path_time = statbuf.st_mtime;
-            // Simple integer comparison: newer files have larger timestamps
-            if (input_path_time > output_path_time) return 1;
         }
-
-        return 0; // All inputs are older than output: no rebuild needed
-#endif
+        free(stats);
+        return result;
     }
 
     QOLDEF int qol_needs_rebuild1(const char *output_path, const char *input_path) {
@@ -3472,8 +9237,7 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
     }
 
     QOLDEF bool qol_hm_keys_equal(void* key1, void* key2) {
-        size_t key_size = strlen(key1) + 1;
-        return memcmp(key1, key2, key_size) == 0;
+        return strcmp((const char*)key1, (const char*)key2) == 0; // memcmp over key1's size could read past a shorter key2
     }
 
     QOLDEF QOL_HashMap* qol_hm_create() {
@@ -3571,8 +9335,10 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
         size_t index = hash;
 
         // Linear probing: Handle collisions by checking next bucket
-        // Continue until we find empty slot or matching key
+        // Continue until we find empty slot or matching key; remember the first tombstone for reuse
+        size_t tombstone = hm->capacity;
         while (hm->buckets[index].state != QOL_HM_EMPTY) {
+            if (hm->buckets[index].state == QOL_HM_DELETED && tombstone == hm->capacity) tombstone = index;
             // Check if this bucket contains our key (collision resolution)
             if (hm->buckets[index].state == QOL_HM_USED && qol_hm_keys_equal(hm->buckets[index].key, key)) {
                 qol_log(QOL_LOG_DIAG, "Updating entry for key: %s\n", (const char*)key);
@@ -3594,11 +9360,13 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
             // Collision: Move to next bucket (wrap around if needed)
             index = (index + 1) % hm->capacity;
             if (index == hash) {
+                if (tombstone < hm->capacity) break; // Only used and deleted buckets: reuse a tombstone
                 // Wrapped all the way around: table is full (shouldn't happen with proper resizing)
                 qol_log(QOL_LOG_ERRO, "Hashmap table is full\n");
                 return;
             }
         }
+        if (tombstone < hm->capacity) index = tombstone;
 
         // Found empty or deleted slot: Insert new entry
         if (hm->buckets[index].state == QOL_HM_EMPTY || hm->buckets[index].state == QOL_HM_DELETED) {
@@ -3695,8 +9463,8 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
                 free(hm->buckets[i].value);
                 hm->buckets[i].key = NULL;
                 hm->buckets[i].value = NULL;
-                hm->buckets[i].state = QOL_HM_EMPTY;
             }
+            hm->buckets[i].state = QOL_HM_EMPTY; // Tombstones too, or probing never ends early again
         }
         hm->size = 0;
     }
@@ -3958,13 +9726,71 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
     #define get_filename_no_ext     qol_get_filename_no_ext
     #define default_compiler_flags  qol_default_compiler_flags
     #define default_c_build         qol_default_c_build
+    #define default_c_compile       qol_default_c_compile
+    #define default_c_link          qol_default_c_link
     #define run                     qol_run
     #define run_always              qol_run_always
     #define proc_wait               qol_proc_wait
     #define procs_wait              qol_procs_wait
+    #define procs_wait_any          qol_procs_wait_any
+    #define procs_cancel            qol_procs_cancel
+    #define nprocs                  qol_nprocs
+    #define jobserver_init          qol_jobserver_init
+    #define jobserver_stop          qol_jobserver_stop
+    #define ProcCallback            QOL_ProcCallback
+    #define procs_poll              qol_procs_poll
+    #define WorkerOutput            QOL_WorkerOutput
+    #define WorkerHandler           QOL_WorkerHandler
+    #define worker_main             qol_worker_main
+    #define worker_printf           qol_worker_printf
+    #define workers_shutdown        qol_workers_shutdown
+    #define pool_define             qol_pool_define
+    #define mem_available_mb        qol_mem_available_mb
+    #define MEM_AVAILABLE           QOL_MEM_AVAILABLE
     #define Cmd                     QOL_Cmd
     #define Procs                   QOL_Procs
     #define RunOptions              QOL_RunOptions
+    #define Target                  QOL_Target
+    #define Graph                   QOL_Graph
+    #define GraphOptions            QOL_GraphOptions
+    #define graph_add               qol_graph_add
+    #define graph_build             qol_graph_build
+    #define graph_release           qol_graph_release
+    #define GraphSchedule           QOL_GraphSchedule
+    #define graph_schedule_report   qol_graph_schedule_report
+    #define Project                 QOL_Project
+    #define project_build           qol_project_build
+    #define project_release         qol_project_release
+    #define WatchOptions            QOL_WatchOptions
+    #define watch_wait              qol_watch_wait
+    #define graph_watch             qol_graph_watch
+    #define project_watch           qol_project_watch
+    #define Pch                     QOL_Pch
+    #define pch_build               qol_pch_build
+    #define pch_use                 qol_pch_use
+    #define pch_release             qol_pch_release
+    #define depfile_parse           qol_depfile_parse
+    #define deps_record             qol_deps_record
+    #define deps_ingest             qol_deps_ingest
+    #define deps_get                qol_deps_get
+    #define deps_check              qol_deps_check
+    #define deps_log_open           qol_deps_log_open
+    #define BuildLogEntry           QOL_BuildLogEntry
+    #define hash_fnv1a              qol_hash_fnv1a
+    #define cmd_hash                qol_cmd_hash
+    #define build_log_record        qol_build_log_record
+    #define build_log_get           qol_build_log_get
+    #define build_log_open          qol_build_log_open
+    #define CacheStats              QOL_CacheStats
+    #define cache_stats             qol_cache_stats
+    #define MemoOptions             QOL_MemoOptions
+    #define cmd_memo                qol_cmd_memo
+    #define trace_begin             qol_trace_begin
+    #define trace_end               qol_trace_end
+    #define ProcResult              QOL_ProcResult
+    #define ProcResults             QOL_ProcResults
+    #define proc_results_report     qol_proc_results_report
+    #define proc_results_release    qol_proc_results_release
 
     // DYN_ARRAY
     #define grow                    qol_grow
@@ -4012,6 +9838,14 @@ QOLDEF void qol_timer_reset(QOL_Timer *timer);
     #define str_icmp                qol_str_icmp
     #define needs_rebuild           qol_needs_rebuild
     #define needs_rebuild1          qol_needs_rebuild1
+    #define FileStat                QOL_FileStat
+    #define StatCacheStats          QOL_StatCacheStats
+    #define stat_cached             qol_stat_cached
+    #define stat_invalidate         qol_stat_invalidate
+    #define stat_cache_stats        qol_stat_cache_stats
+    #define stat_cache_begin        qol_stat_cache_begin
+    #define stat_cache_end          qol_stat_cache_end
+    #define stat_batch              qol_stat_batch
 
     // TEMP_ALLOCATOR
     #define temp_strdup             qol_temp_strdup
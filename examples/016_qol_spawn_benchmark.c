@@ -0,0 +1,88 @@
+/*
+ * ===========================================================================
+ * 016_qol_spawn_benchmark.c
+ *
+ * Benchmark for process launching: the old fork()+execvp() path against
+ * qol_cmd_execute_async() (posix_spawnp). Usage:
+ *
+ *     ./016_qol_spawn_benchmark [commands] [ballast MiB]
+ *
+ * The ballast is touched memory in the parent; fork() has to copy its page
+ * tables for every child, posix_spawnp() does not.
+ *
+ * Created: 16 Oct 2026
+ * Author : Raphaele Salvatore Licciardo
+ *
+ * Copyright (c) 2026 Raphaele Salvatore Licciardo
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define QOL_IMPLEMENTATION
+#define QOL_STRIP_PREFIX
+#include "../build.h"
+
+#if defined(WINDOWS)
+int main() {
+    info("The spawn benchmark compares POSIX launchers and does not apply to Windows\n");
+    return 0;
+}
+#else
+
+// The launcher as it used to be: fork, then build the argv inside the child
+static pid_t fork_exec(Cmd *cmd) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        Cmd cmd_null = {0};
+        for (size_t i = 0; i < cmd->len; i++) push(&cmd_null, cmd->data[i]);
+        push(&cmd_null, NULL);
+        execvp(cmd->data[0], (char * const*)cmd_null.data);
+        _exit(127);
+    }
+    return pid;
+}
+
+static double bench(const char *name, size_t count, bool use_fork) {
+    Cmd cmd = {0};
+    push(&cmd, "true");
+
+    Timer t = {0};
+    timer_start(&t);
+    for (size_t i = 0; i < count; i++) {
+        Proc proc = use_fork ? fork_exec(&cmd) : qol_cmd_execute_async(&cmd);
+        if (proc == INVALID_PROC || !proc_wait(proc)) {
+            erro("%s: command %zu failed\n", name, i);
+            break;
+        }
+    }
+    double ms = timer_elapsed_ms(&t);
+    release(&cmd);
+    return ms;
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 10000;
+    size_t ballast_mib = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 256;
+    if (count == 0) count = 1;
+
+    // Simulate a big build driver (graph, logs, caches in memory)
+    char *ballast = (char*)malloc(ballast_mib * 1024 * 1024 + 1);
+    if (ballast) memset(ballast, 1, ballast_mib * 1024 * 1024 + 1);
+
+    init_logger(.level=LOG_ERRO); // The per-command EXEC log line would dominate the measurement
+    double fork_ms = bench("fork", count, true);
+    double spawn_ms = bench("posix_spawnp", count, false);
+
+    init_logger(.level=LOG_INFO);
+    info("%zu commands, %zu MiB parent RSS ballast\n", count, ballast_mib);
+    info("  fork + execvp : %8.1f ms total, %6.1f us per command\n", fork_ms, fork_ms * 1000.0 / (double)count);
+    info("  posix_spawnp  : %8.1f ms total, %6.1f us per command\n", spawn_ms, spawn_ms * 1000.0 / (double)count);
+    info("  speedup       : %.2fx\n", fork_ms / spawn_ms);
+
+    free(ballast);
+    return 0;
+}
+#endif
@@ -0,0 +1,76 @@
+/*
+ * ===========================================================================
+ * 018_qol_longest_first_benchmark.c
+ *
+ * Benchmark for the graph scheduler: the same graph built in insertion
+ * order (.fifo=true) and longest path first (the default). Usage:
+ *
+ *     ./018_qol_longest_first_benchmark [short jobs] [jobs]
+ *
+ * The slow command is added last, like the one big translation unit that
+ * happens to sort at the end. The first round only fills the build log with
+ * durations; the scheduler needs them to know which command is slow.
+ *
+ * Created: 16 Oct 2026
+ * Author : Raphaele Salvatore Licciardo
+ *
+ * Copyright (c) 2026 Raphaele Salvatore Licciardo
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define QOL_IMPLEMENTATION
+#define QOL_STRIP_PREFIX
+#include "../build.h"
+
+#if defined(WINDOWS)
+int main() {
+    info("The scheduling benchmark uses sh and sleep and does not apply to Windows\n");
+    return 0;
+}
+#else
+
+#define DIR "out/longest_first_benchmark"
+
+static GraphSchedule build(size_t count, size_t jobs, bool fifo) {
+    Graph graph = {0};
+    for (size_t i = 0; i <= count; i++) {
+        const char *output = temp_sprintf(DIR "/out_%zu", i);
+        if (file_exists(output)) delete_file(output);
+        Cmd cmd = {0};
+        push(&cmd, "sh", "-c", temp_sprintf("sleep %s && touch %s", i == count ? "1.0" : "0.2", output));
+        Target *target = graph_add(&graph, cmd);
+        push(&target->outputs, output);
+    }
+    GraphSchedule schedule = {0};
+    if (!graph_build(&graph, .jobs=jobs, .fifo=fifo, .schedule=&schedule)) erro("Build failed\n");
+    graph_release(&graph);
+    return schedule;
+}
+
+int main(int argc, char **argv) {
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 12;
+    size_t jobs = argc > 2 ? (size_t)strtoull(argv[2], NULL, 10) : 4;
+    if (jobs == 0) jobs = 1;
+
+    init_logger(.level=LOG_ERRO); // One EXEC line per command would bury the report
+    mkdir_if_not_exists("out");
+    mkdir_if_not_exists(DIR);
+    build(count, jobs, true);
+    GraphSchedule fifo = build(count, jobs, true);
+    GraphSchedule longest = build(count, jobs, false);
+
+    init_logger(.level=LOG_INFO);
+    info("%zu commands of 0.2 s and one of 1.0 s (added last) on %zu jobs\n", count, jobs);
+    info("-- insertion order --\n");
+    graph_schedule_report(&fifo);
+    info("-- longest path first --\n");
+    graph_schedule_report(&longest);
+    info("speedup: %.2fx\n", (double)fifo.actual_ms / (double)(longest.actual_ms ? longest.actual_ms : 1));
+    temp_reset();
+    return 0;
+}
+#endif
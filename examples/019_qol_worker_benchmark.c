@@ -0,0 +1,78 @@
+/*
+ * ===========================================================================
+ * 019_qol_worker_benchmark.c
+ *
+ * Benchmark for persistent workers: the same tool invoked once per request
+ * as a fresh process against requests sent to long-lived workers (.worker).
+ * The benchmark is its own tool. Usage:
+ *
+ *     ./019_qol_worker_benchmark [requests]
+ *
+ * The tool does next to no work, so the difference is the process startup
+ * (exec, dynamic loading, libc init) that workers pay only once.
+ *
+ * Created: 16 Oct 2026
+ * Author : Raphaele Salvatore Licciardo
+ *
+ * Copyright (c) 2026 Raphaele Salvatore Licciardo
+ * ===========================================================================
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define QOL_IMPLEMENTATION
+#define QOL_STRIP_PREFIX
+#include "../build.h"
+
+// The tool: sums the digits of its argument
+static int handle(int argc, char **argv, WorkerOutput *out) {
+    (void)out;
+    if (argc < 3) return 1;
+    int sum = 0;
+    for (const char *p = argv[2]; *p; p++) sum += *p - '0';
+    return sum >= 0 ? 0 : 1;
+}
+
+static double bench(const char *self, size_t count, bool worker) {
+    Procs procs = {.max_jobs = nprocs()};
+    char number[32];
+    Timer t = {0};
+    timer_start(&t);
+    for (size_t i = 0; i < count; i++) {
+        snprintf(number, sizeof(number), "%zu", i);
+        Cmd cmd = {0};
+        push(&cmd, self, "tool", number);
+        run_always(&cmd, .procs=&procs, .worker=worker);
+    }
+    if (!procs_wait(&procs)) erro("%s: some requests failed\n", worker ? "workers" : "processes");
+    double ms = timer_elapsed_ms(&t);
+    release(&procs);
+    return ms;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && (strcmp(argv[1], "tool") == 0 || strcmp(argv[1], QOL_WORKER_FLAG) == 0)) {
+        return worker_main(argc, argv, handle);
+    }
+#if defined(WINDOWS)
+    info("Windows runs worker commands as plain processes, there is nothing to compare\n");
+    return 0;
+#else
+    size_t count = argc > 1 ? (size_t)strtoull(argv[1], NULL, 10) : 2000;
+    if (count == 0) count = 1;
+
+    init_logger(.level=LOG_ERRO); // The per-command EXEC log line would dominate the measurement
+    double process_ms = bench(argv[0], count, false);
+    double worker_ms = bench(argv[0], count, true);
+    workers_shutdown();
+
+    init_logger(.level=LOG_INFO);
+    info("%zu requests, up to %zu at a time\n", count, nprocs());
+    info("  process each : %8.1f ms total, %6.1f us per request\n", process_ms, process_ms * 1000.0 / (double)count);
+    info("  workers      : %8.1f ms total, %6.1f us per request\n", worker_ms, worker_ms * 1000.0 / (double)count);
+    info("  speedup      : %.2fx\n", process_ms / worker_ms);
+    return 0;
+#endif
+}
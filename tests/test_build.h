@@ -110,3 +110,354 @@ QOL_TEST(test_get_filename_no_ext) {
     QOL_TEST_STREQ(name4, "noext", "no extension");
     free(name4);
 }
+
+QOL_TEST(test_depfile_parse) {
+    const char *depfile = "/tmp/qol_test_main.o.d";
+    const char *text = "out/main.o: main.c inc/a\\ b.h \\\n  inc/c$$.h\n\ninc/c$$.h:\n";
+    write_file(depfile, text, strlen(text));
+
+    String deps = {0};
+    QOL_TEST_TRUTHY(depfile_parse(depfile, &deps), "depfile parses");
+    QOL_TEST_EQ(deps.len, 3, "three dependencies, phony rule ignored");
+    QOL_TEST_STREQ(deps.data[0], "main.c", "source");
+    QOL_TEST_STREQ(deps.data[1], "inc/a b.h", "escaped space");
+    QOL_TEST_STREQ(deps.data[2], "inc/c$.h", "continuation and dollar");
+    release_string(&deps);
+    delete_file(depfile);
+}
+
+QOL_TEST(test_deps_record_check) {
+    mkdir_if_not_exists("/tmp/qol_deps_test");
+    write_file("/tmp/qol_deps_test/a.h", "a", 1);
+    write_file("/tmp/qol_deps_test/a.o", "o", 1);
+
+    const char *deps[] = { "/tmp/qol_deps_test/a.h" };
+    QOL_TEST_EQ(deps_check("/tmp/qol_deps_test/unknown.o"), -1, "unknown output");
+    QOL_TEST_TRUTHY(deps_record("/tmp/qol_deps_test/a.o", deps, 1), "deps recorded");
+    QOL_TEST_EQ(deps_check("/tmp/qol_deps_test/a.o"), 0, "up to date");
+
+    String got = {0};
+    QOL_TEST_TRUTHY(deps_get("/tmp/qol_deps_test/a.o", &got), "deps found");
+    QOL_TEST_EQ(got.len, 1, "one dependency");
+    release_string(&got);
+
+    FileStat st;
+    QOL_TEST_TRUTHY(qol_stat_query("/tmp/qol_deps_test/a.o", &st), "output exists");
+    struct utimbuf later = { .actime = (time_t)(st.mtime_ns / 1000000000) + 10, .modtime = (time_t)(st.mtime_ns / 1000000000) + 10 };
+    QOL_TEST_EQ(utime("/tmp/qol_deps_test/a.o", &later), 0, "output rewritten");
+    QOL_TEST_EQ(deps_check("/tmp/qol_deps_test/a.o"), -1, "record of an older build is not trusted");
+    QOL_TEST_TRUTHY(deps_record("/tmp/qol_deps_test/a.o", deps, 1), "deps recorded again");
+
+    delete_file("/tmp/qol_deps_test/a.h");
+    QOL_TEST_EQ(deps_check("/tmp/qol_deps_test/a.o"), 1, "missing header forces rebuild");
+    delete_dir("/tmp/qol_deps_test");
+}
+
+QOL_TEST(test_deps_log_open) {
+    const char *deps[] = { "/tmp/qol_deps_open_test.h" };
+    delete_file("/tmp/qol_deps_open_test.deps");
+    QOL_TEST_TRUTHY(deps_record("/tmp/qol_deps_open_test.o", deps, 1), "recorded in the test log");
+    QOL_TEST_TRUTHY(deps_log_open("/tmp/qol_deps_open_test.deps"), "switched logs");
+    String got = {0};
+    QOL_TEST_FALSY(deps_get("/tmp/qol_deps_open_test.o", &got), "other log knows nothing");
+    QOL_TEST_TRUTHY(deps_record("/tmp/qol_deps_open_test.o", deps, 1), "recorded in the other log");
+    QOL_TEST_TRUTHY(file_exists("/tmp/qol_deps_open_test.deps"), "other log written");
+
+    QOL_TEST_TRUTHY(deps_log_open("/tmp/qol_unittests.deps"), "switched back");
+    QOL_TEST_TRUTHY(deps_get("/tmp/qol_deps_open_test.o", &got) && got.len == 1, "first log read again");
+    release_string(&got);
+    delete_file("/tmp/qol_deps_open_test.deps");
+}
+
+QOL_TEST(test_cmd_hash) {
+    Cmd a = {0}, b = {0}, c = {0};
+    push(&a, "cc", "-O2", "main.c");
+    push(&b, "cc", "-O2", "main.c");
+    push(&c, "cc", "-O2 main.c");
+    QOL_TEST_EQ(cmd_hash(&a), cmd_hash(&b), "same argv, same hash");
+    QOL_TEST_TRUTHY(cmd_hash(&a) != cmd_hash(&c), "argument boundaries are part of the hash");
+    release(&a);
+    release(&b);
+    release(&c);
+}
+
+QOL_TEST(test_build_log_cmd_change) {
+    mkdir_if_not_exists("/tmp/qol_log_test");
+    write_file("/tmp/qol_log_test/m.c", "int m(void) { return 0; }\n", 26);
+    delete_file("/tmp/qol_log_test/m.o");
+
+    Cmd cmd = {0};
+    push(&cmd, "cc", "-c", "/tmp/qol_log_test/m.c", "-o", "/tmp/qol_log_test/m.o");
+    uint64_t hash = cmd_hash(&cmd);
+    QOL_TEST_TRUTHY(run(&cmd), "first build");
+    BuildLogEntry entry = {0};
+    QOL_TEST_TRUTHY(build_log_get("/tmp/qol_log_test/m.o", &entry), "output recorded");
+    QOL_TEST_EQ(entry.hash, hash, "argv hash recorded");
+
+    push(&cmd, "cc", "-c", "-O2", "/tmp/qol_log_test/m.c", "-o", "/tmp/qol_log_test/m.o");
+    uint64_t changed = cmd_hash(&cmd);
+    QOL_TEST_TRUTHY(run(&cmd), "build with changed flags");
+    QOL_TEST_TRUTHY(build_log_get("/tmp/qol_log_test/m.o", &entry), "output still recorded");
+    QOL_TEST_EQ(entry.hash, changed, "flag change forced a rebuild");
+    delete_dir("/tmp/qol_log_test");
+}
+
+QOL_TEST(test_build_log_open) {
+    delete_file("/tmp/qol_log_open_test.log");
+    QOL_TEST_TRUTHY(build_log_record("/tmp/qol_log_open_test.o", &(BuildLogEntry){ .duration_ms = 42 }), "recorded in the test log");
+    QOL_TEST_TRUTHY(build_log_open("/tmp/qol_log_open_test.log"), "switched logs");
+    BuildLogEntry entry = {0};
+    QOL_TEST_FALSY(build_log_get("/tmp/qol_log_open_test.o", &entry), "other log knows nothing");
+    QOL_TEST_TRUTHY(build_log_record("/tmp/qol_log_open_test.o", &(BuildLogEntry){ .duration_ms = 7 }), "recorded in the other log");
+    QOL_TEST_TRUTHY(file_exists("/tmp/qol_log_open_test.log"), "other log written");
+
+    QOL_TEST_TRUTHY(build_log_open("/tmp/qol_unittests.log"), "switched back");
+    QOL_TEST_TRUTHY(build_log_get("/tmp/qol_log_open_test.o", &entry) && entry.duration_ms == 42, "first log read again");
+    delete_file("/tmp/qol_log_open_test.log");
+}
+
+#ifndef WINDOWS
+// Fresh scratch directory under /tmp with QOL_CACHE_DIR pointing into it
+static void qol_test_cache_begin(const char *root) {
+    delete_dir(root);
+    mkdir_if_not_exists(root);
+    setenv("QOL_CACHE_DIR", temp_sprintf("%s/cache", root), 1);
+}
+
+static void qol_test_cache_end(const char *root) {
+    unsetenv("QOL_CACHE_DIR");
+    delete_dir(root);
+}
+
+QOL_TEST(test_compile_cache_hit) {
+    qol_test_cache_begin("/tmp/qol_cache_test");
+    write_file("/tmp/qol_cache_test/k.c", "int k(void) { return 42; }\n", 27);
+
+    CacheStats before = cache_stats();
+    Cmd cmd = {0};
+    push(&cmd, "cc", "-c", "/tmp/qol_cache_test/k.c", "-o", "/tmp/qol_cache_test/k.o");
+    QOL_TEST_TRUTHY(run_always(&cmd, .cache=true), "first compile");
+    QOL_TEST_TRUTHY(file_exists("/tmp/qol_cache_test/k.o"), "object built");
+
+    delete_file("/tmp/qol_cache_test/k.o");
+    pool_define("test_cache", 1);
+    Procs procs = {0};
+    push(&cmd, "cc", "-c", "/tmp/qol_cache_test/k.c", "-o", "/tmp/qol_cache_test/k.o");
+    QOL_TEST_TRUTHY(run_always(&cmd, .cache=true, .procs=&procs, .pool="test_cache"), "second compile");
+    QOL_TEST_TRUTHY(procs_wait(&procs), "nothing left to wait for");
+    QOL_TEST_TRUTHY(file_exists("/tmp/qol_cache_test/k.o"), "object restored");
+    QOL_TEST_EQ(qol_pools.data[qol_pool_index("test_cache") - 1].used, 0, "cache hit leaves the pool alone");
+    release(&procs);
+
+    CacheStats after = cache_stats();
+    QOL_TEST_EQ(after.hits, before.hits + 1, "second compile was a cache hit");
+    qol_test_cache_end("/tmp/qol_cache_test");
+}
+
+QOL_TEST(test_compile_cache_async) {
+    // A slow compiler driver: the preprocessor runs inside the job, so queueing does not wait for it
+    qol_test_cache_begin("/tmp/qol_cache_async_test");
+    const char *script = "#!/bin/sh\nsleep 0.3\nexec cc \"$@\"\n";
+    write_file("/tmp/qol_cache_async_test/slowcc", script, strlen(script));
+    chmod("/tmp/qol_cache_async_test/slowcc", 0755);
+    write_file("/tmp/qol_cache_async_test/a.c", "int a(void) { return 1; }\n", 26);
+    write_file("/tmp/qol_cache_async_test/b.c", "int b(void) { return 2; }\n", 26);
+
+    for (int round = 0; round < 2; round++) {
+        CacheStats before = cache_stats();
+        Procs procs = {.max_jobs = 2};
+        Timer t = {0};
+        timer_start(&t);
+        Cmd cmd = {0};
+        push(&cmd, "/tmp/qol_cache_async_test/slowcc", "-c", "/tmp/qol_cache_async_test/a.c", "-o", "/tmp/qol_cache_async_test/a.o");
+        QOL_TEST_TRUTHY(run_always(&cmd, .cache=true, .procs=&procs), "first compile queued");
+        push(&cmd, "/tmp/qol_cache_async_test/slowcc", "-c", "/tmp/qol_cache_async_test/b.c", "-o", "/tmp/qol_cache_async_test/b.o");
+        QOL_TEST_TRUTHY(run_always(&cmd, .cache=true, .procs=&procs), "second compile queued");
+        QOL_TEST_TRUTHY(timer_elapsed_ms(&t) < 250.0, "queueing does not wait for the preprocessor");
+        QOL_TEST_TRUTHY(procs_wait(&procs), "both compiles finished");
+        release(&procs);
+        QOL_TEST_TRUTHY(file_exists("/tmp/qol_cache_async_test/a.o") && file_exists("/tmp/qol_cache_async_test/b.o"), "objects there");
+        CacheStats after = cache_stats();
+        if (round == 0) QOL_TEST_EQ(after.misses, before.misses + 2, "cold cache misses");
+        else QOL_TEST_EQ(after.hits, before.hits + 2, "warm cache hits");
+        delete_file("/tmp/qol_cache_async_test/a.o");
+        delete_file("/tmp/qol_cache_async_test/b.o");
+    }
+    qol_test_cache_end("/tmp/qol_cache_async_test");
+}
+
+QOL_TEST(test_cmd_memo) {
+    qol_test_cache_begin("/tmp/qol_memo_test");
+    const char *probe = "echo run >> /tmp/qol_memo_test/runs\necho \"flags $QOL_MEMO_TEST\"\n";
+    write_file("/tmp/qol_memo_test/probe.sh", probe, strlen(probe));
+    const char *env[] = { "QOL_MEMO_TEST", NULL };
+
+    char *outputs[3] = {0};
+    size_t size = 0;
+    for (int i = 0; i < 3; i++) {
+        if (i == 2) setenv("QOL_MEMO_TEST", "-DX", 1);
+        Cmd cmd = {0};
+        push(&cmd, "sh", "/tmp/qol_memo_test/probe.sh");
+        outputs[i] = cmd_memo(&cmd, .env=env, .size=&size);
+    }
+    QOL_TEST_TRUTHY(outputs[0] && strcmp(outputs[0], "flags \n") == 0, "stdout captured");
+    QOL_TEST_TRUTHY(outputs[1] && strcmp(outputs[0], outputs[1]) == 0, "memoized output returned");
+    QOL_TEST_TRUTHY(outputs[2] && strcmp(outputs[2], "flags -DX\n") == 0, "environment is part of the key");
+    QOL_TEST_EQ(size, 10, "size reported");
+    String runs = {0};
+    read_file("/tmp/qol_memo_test/runs", &runs);
+    QOL_TEST_EQ(runs.len, 2, "probe ran once per key");
+    release_string(&runs);
+
+    // An input edited during a build changes the key even though the stat cache saw it before
+    const char *inputs[] = { "/tmp/qol_memo_test/probe.sh", NULL };
+    stat_cache_begin();
+    for (int i = 0; i < 2; i++) {
+        FileStat st;
+        struct utimbuf later = { .actime = time(NULL) + 10, .modtime = time(NULL) + 10 };
+        if (i == 1 && qol_stat_cached(inputs[0], &st)) utime(inputs[0], &later);
+        Cmd cmd = {0};
+        push(&cmd, "sh", "/tmp/qol_memo_test/probe.sh");
+        free(cmd_memo(&cmd, .env=env, .inputs=inputs));
+    }
+    stat_cache_end();
+    read_file("/tmp/qol_memo_test/runs", &runs);
+    QOL_TEST_EQ(runs.len, 4, "edited input asked again");
+    release_string(&runs);
+
+    Cmd fail = {0};
+    push(&fail, "sh", "-c", "exit 1");
+    QOL_TEST_TRUTHY(cmd_memo(&fail) == NULL, "failed probe");
+    for (int i = 0; i < 3; i++) free(outputs[i]);
+    unsetenv("QOL_MEMO_TEST");
+    qol_test_cache_end("/tmp/qol_memo_test");
+}
+
+QOL_TEST(test_rebuild_cached_impl) {
+    // Code before the #include stays with the script: the cached object only gets the directives
+    qol_test_cache_begin("/tmp/qol_impl_test");
+    char *header = realpath("build.h", NULL); // Tests run from the repository root
+    QOL_TEST_TRUTHY(header != NULL, "header found");
+    if (!header) return;
+    const char *script = temp_sprintf(
+        "#include <stdio.h>\n"
+        "int verbose = 0;\n"
+        "#define QOL_IMPLEMENTATION\n"
+        "#include \"%s\"\n"
+        "int main(void) { return verbose; }\n", header);
+    write_file("/tmp/qol_impl_test/b.c", script, strlen(script));
+    for (int i = 0; i < 2; i++) {
+        delete_file("/tmp/qol_impl_test/b");
+        QOL_TEST_EQ(qol_rebuild_cached_impl("/tmp/qol_impl_test/b.c", "/tmp/qol_impl_test/b", "/tmp/qol_impl_test/b.d"), 1, "script linked against the cached object");
+        QOL_TEST_TRUTHY(file_exists("/tmp/qol_impl_test/b"), "executable built");
+    }
+    Cmd run_script = {0};
+    push(&run_script, "/tmp/qol_impl_test/b");
+    QOL_TEST_TRUTHY(run_always(&run_script), "executable runs");
+    free(header);
+    qol_test_cache_end("/tmp/qol_impl_test");
+}
+#endif
+
+QOL_TEST(test_project_build) {
+    delete_dir("/tmp/qol_project_test");
+    mkdir_if_not_exists("/tmp/qol_project_test");
+    write_file("/tmp/qol_project_test/a.c", "int b(void);\nint main(void) { return b(); }\n", 44);
+    write_file("/tmp/qol_project_test/b.c", "int c(void);\nint b(void) { return c(); }\n", 41);
+    write_file("/tmp/qol_project_test/c.c", "int c(void) { return 0; }\n", 26);
+
+    Project project = {.output = "/tmp/qol_project_test/out/app"};
+    push(&project.sources, "/tmp/qol_project_test/a.c", "/tmp/qol_project_test/b.c", "/tmp/qol_project_test/c.c");
+    QOL_TEST_TRUTHY(project_build(&project, .jobs=2), "first build");
+    QOL_TEST_EQ(project.built, 4, "three compiles and a link");
+    QOL_TEST_TRUTHY(file_exists("/tmp/qol_project_test/out/obj/app/tmp/qol_project_test/b.o"), "object below obj dir");
+
+    QOL_TEST_TRUTHY(project_build(&project), "no-op build");
+    QOL_TEST_EQ(project.built, 0, "nothing rebuilt");
+
+    struct utimbuf old = { .actime = time(NULL) - 3600, .modtime = time(NULL) - 3600 };
+    utime("/tmp/qol_project_test/out/obj/app/tmp/qol_project_test/b.o", &old);
+    QOL_TEST_TRUTHY(project_build(&project), "incremental build");
+    QOL_TEST_EQ(project.built, 2, "one compile and the link");
+
+    project_release(&project);
+    delete_dir("/tmp/qol_project_test");
+}
+
+QOL_TEST(test_project_object_path) {
+    const char *sources[][2] = {
+        {"src/a.c", "obj/src/a.o"},
+        {"../lib/a.c", "obj/%2E%2E/lib/a.o"},
+        {"__/lib/a.c", "obj/__/lib/a.o"},
+        {"%2E%2E/lib/a.c", "obj/%252E%252E/lib/a.o"},
+        {"src/..x/a.c", "obj/src/..x/a.o"},
+    };
+    for (size_t i = 0; i < sizeof(sources) / sizeof(sources[0]); i++) {
+        char *object = qol_project_object_path("obj", sources[i][0]);
+        QOL_TEST_STREQ(object, sources[i][1], "parent directories never share objects with real directories");
+        free(object);
+    }
+}
+
+QOL_TEST(test_project_unity_fallback) {
+    delete_dir("/tmp/qol_unity_test");
+    mkdir_if_not_exists("/tmp/qol_unity_test");
+    write_file("/tmp/qol_unity_test/a.c", "int b(void);\nint main(void) { return b(); }\n", 44);
+    write_file("/tmp/qol_unity_test/b.c", "static int helper(void) { return 0; }\nint b(void) { return helper(); }\n", 70);
+    write_file("/tmp/qol_unity_test/c.c", "static int helper(void) { return 1; }\nint c(void) { return helper(); }\n", 70);
+
+    Project project = {.output = "/tmp/qol_unity_test/out/app", .unity = true};
+    push(&project.sources, "/tmp/qol_unity_test/a.c", "/tmp/qol_unity_test/b.c", "/tmp/qol_unity_test/c.c");
+    QOL_TEST_TRUTHY(project_build(&project, .jobs=1), "clashing batch falls back to single compiles");
+    String excluded = {0};
+    QOL_TEST_TRUTHY(read_file("/tmp/qol_unity_test/out/obj/app/unity/excluded", &excluded), "clashing sources remembered");
+    QOL_TEST_EQ(excluded.len, 1, "only the offender is excluded");
+    QOL_TEST_STREQ(excluded.data[0], "/tmp/qol_unity_test/c.c", "offender is the later clashing source");
+    release_string(&excluded);
+    QOL_TEST_TRUTHY(file_exists("/tmp/qol_unity_test/out/app"), "program linked");
+
+    QOL_TEST_TRUTHY(project_build(&project, .jobs=1), "second build batches the rest");
+    QOL_TEST_TRUTHY(project_build(&project, .jobs=1), "third build");
+    QOL_TEST_EQ(project.built, 0, "excluded sources stay out of batches");
+    project_release(&project);
+
+    delete_dir("/tmp/qol_unity_test/out");
+    Project clean = {.output = "/tmp/qol_unity_test/out/app", .unity = true};
+    push(&clean.sources, "/tmp/qol_unity_test/a.c", "/tmp/qol_unity_test/b.c");
+    QOL_TEST_TRUTHY(project_build(&clean, .jobs=1), "unity build");
+    QOL_TEST_EQ(clean.built, 2, "one batch and the link");
+    project_release(&clean);
+    delete_dir("/tmp/qol_unity_test");
+}
+
+QOL_TEST(test_project_pch) {
+    delete_dir("/tmp/qol_pch_test");
+    mkdir_if_not_exists("/tmp/qol_pch_test");
+    write_file("/tmp/qol_pch_test/common.h", "#include <stdio.h>\n#define ANSWER 42\n", 37);
+    write_file("/tmp/qol_pch_test/main.c", "int main(void) { return ANSWER - 42; }\n", 40);
+
+    Project project = {.output = "/tmp/qol_pch_test/out/app", .pch = "/tmp/qol_pch_test/common.h"};
+    push(&project.sources, "/tmp/qol_pch_test/main.c");
+    QOL_TEST_TRUTHY(project_build(&project), "build with precompiled header");
+    QOL_TEST_EQ(project.built, 3, "pch, compile and link");
+    QOL_TEST_TRUTHY(project_build(&project), "no-op build");
+    QOL_TEST_EQ(project.built, 0, "pch not rebuilt");
+    project_release(&project);
+
+    // Headers of the same name in different directories keep their own wrapper and PCH
+    Pch pchs[2] = { {.header = "/tmp/qol_pch_test/a/common.h"}, {.header = "/tmp/qol_pch_test/b/common.h"} };
+    for (int i = 0; i < 2; i++) {
+        mkdir_if_not_exists(i == 0 ? "/tmp/qol_pch_test/a" : "/tmp/qol_pch_test/b");
+        write_file(pchs[i].header, i == 0 ? "#define SIDE 1\n" : "#define SIDE 2\n", 15);
+        pchs[i].dir = "/tmp/qol_pch_test/out/pch";
+        QOL_TEST_TRUTHY(pch_build(&pchs[i]), "pch built");
+    }
+    QOL_TEST_TRUTHY(strcmp(pchs[0].wrapper, pchs[1].wrapper) != 0, "wrappers keyed on the full path");
+    QOL_TEST_TRUTHY(file_exists(pchs[0].output) && file_exists(pchs[1].output), "both pchs kept");
+    String wrapper = {0};
+    QOL_TEST_TRUTHY(read_file(pchs[0].wrapper, &wrapper) && wrapper.len == 2 && str_contains(wrapper.data[1], "/a/common.h"),
+                    "first wrapper still includes its own header");
+    release_string(&wrapper);
+    for (int i = 0; i < 2; i++) pch_release(&pchs[i]);
+    delete_dir("/tmp/qol_pch_test");
+}
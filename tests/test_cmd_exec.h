@@ -69,7 +69,427 @@ QOL_TEST(test_needs_rebuild1) {
     
     int result = needs_rebuild1("test_output1.txt", "test_input1.txt");
     QOL_TEST_ASSERT(result >= 0, "needs_rebuild1 should not error");
+
+#ifndef WINDOWS
+    // An output that exists but cannot be queried is an error, not a missing file
+    remove("test_loop");
+    QOL_TEST_TRUTHY(symlink("test_loop", "test_loop") == 0, "symlink loop created");
+    QOL_TEST_EQ(needs_rebuild1("test_loop", "test_input1.txt"), -1, "stat error reported");
+    remove("test_loop");
+#endif
     
     delete_file("test_input1.txt");
     delete_file("test_output1.txt");
 }
+
+QOL_TEST(test_procs_max_jobs) {
+    Procs procs = {.max_jobs = 2};
+    for (int i = 0; i < 5; i++) {
+        Cmd cmd = {0};
+#ifdef WINDOWS
+        push(&cmd, "cmd", "/c", "exit", "0");
+#else
+        push(&cmd, "true");
+#endif
+        QOL_TEST_TRUTHY(run_always(&cmd, .procs=&procs), "async command starts");
+        QOL_TEST_TRUTHY(procs.len <= 2, "pool never exceeds max_jobs");
+    }
+    QOL_TEST_TRUTHY(procs_wait(&procs), "all jobs succeed");
+    QOL_TEST_EQ(procs.len, 0, "procs cleared after wait");
+    release(&procs);
+}
+
+QOL_TEST(test_procs_wait_any_failure) {
+    Procs procs = {.max_jobs = 1};
+    Cmd fail = {0};
+#ifdef WINDOWS
+    push(&fail, "cmd", "/c", "exit", "1");
+#else
+    push(&fail, "false");
+#endif
+    run_always(&fail, .procs=&procs);
+
+    Cmd ok = {0};
+#ifdef WINDOWS
+    push(&ok, "cmd", "/c", "exit", "0");
+#else
+    push(&ok, "true");
+#endif
+    run_always(&ok, .procs=&procs); // reaps the failed job to free the slot
+    QOL_TEST_EQ(procs.failed, 1, "failure recorded when slot was freed");
+
+    bool success = true;
+    QOL_Proc proc = procs_wait_any(&procs, &success);
+    QOL_TEST_TRUTHY(proc != QOL_INVALID_PROC, "wait_any reaps remaining job");
+    QOL_TEST_TRUTHY(success, "remaining job succeeded");
+    QOL_TEST_FALSY(procs_wait(&procs), "procs_wait reports earlier failure");
+    QOL_TEST_EQ(procs.failed, 0, "failure counter reset");
+    release(&procs);
+}
+
+#ifndef WINDOWS
+QOL_TEST(test_procs_wait_any_owned) {
+    // A child the library did not start exits first; it must stay with its own waiter
+    pid_t foreign = fork();
+    if (foreign == 0) _exit(7);
+    Procs procs = {0};
+    for (int i = 0; i < 2; i++) {
+        Cmd cmd = {0};
+        push(&cmd, "sleep", "0.1");
+        run_always(&cmd, .procs=&procs);
+    }
+    bool success = false;
+    QOL_TEST_TRUTHY(procs_wait_any(&procs, &success) != QOL_INVALID_PROC && success, "own job reaped");
+    QOL_TEST_TRUTHY(procs_wait(&procs), "other job reaped");
+    int wstatus = 0;
+    QOL_TEST_EQ(waitpid(foreign, &wstatus, 0), foreign, "foreign child left alone");
+    QOL_TEST_EQ(WEXITSTATUS(wstatus), 7, "foreign exit status intact");
+    release(&procs);
+}
+
+QOL_TEST(test_procs_capture_large_output) {
+    // Each job writes more than a pipe buffer: the wait must drain the pipes or it deadlocks
+    Procs procs = {.max_jobs = 2, .capture = true, .capture_max = 64};
+    for (int i = 0; i < 3; i++) {
+        Cmd cmd = {0};
+        push(&cmd, "sh", "-c", "yes captured | head -n 40000");
+        QOL_TEST_TRUTHY(run_always(&cmd, .procs=&procs), "captured job started");
+    }
+    QOL_TEST_TRUTHY(procs_wait(&procs), "captured jobs finished");
+    QOL_TEST_EQ(procs.len, 0, "all jobs reaped");
+    release(&procs);
+}
+
+QOL_TEST(test_procs_capture_streams) {
+    // Captured stderr stays on stderr and the failure line follows the captured block
+    const char *path = "/tmp/qol_capture_err.txt";
+    fflush(stderr);
+    int saved = dup(STDERR_FILENO);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    dup2(fd, STDERR_FILENO);
+    close(fd);
+    init_logger(.level=LOG_ERRO);
+
+    Procs procs = {.capture = true};
+    Cmd cmd = {0};
+    push(&cmd, "sh", "-c", "echo out; echo err >&2; exit 3");
+    QOL_TEST_TRUTHY(run_always(&cmd, .procs=&procs), "captured job started");
+    QOL_TEST_FALSY(procs_wait(&procs), "captured job failed");
+
+    init_logger(.only=LOG_HINT, .only_set=true, .time=true, .color=true);
+    fflush(stderr);
+    dup2(saved, STDERR_FILENO);
+    close(saved);
+
+    String lines = {0};
+    QOL_TEST_TRUTHY(read_file(path, &lines), "stderr readable");
+    long err = -1, failed = -1;
+    bool out = false;
+    for (size_t i = 0; i < lines.len; i++) {
+        if (strcmp(lines.data[i], "out") == 0) out = true;
+        if (err < 0 && strcmp(lines.data[i], "err") == 0) err = (long)i;
+        if (failed < 0 && str_contains(lines.data[i], "exit code 3")) failed = (long)i;
+    }
+    QOL_TEST_FALSY(out, "stdout not sent to stderr");
+    QOL_TEST_TRUTHY(err >= 0, "captured stderr printed to stderr");
+    QOL_TEST_TRUTHY(failed > err, "failure reported after the captured output");
+    release_string(&lines);
+    release(&procs);
+    delete_file(path);
+}
+#endif
+
+QOL_TEST(test_trace_json) {
+    QOL_TEST_TRUTHY(trace_begin("/tmp/qol_trace_test.json"), "tracing started");
+    QOL_TEST_FALSY(trace_begin("/tmp/qol_trace_test.json"), "tracing cannot be nested");
+    Procs procs = {0};
+    for (int i = 0; i < 2; i++) {
+        Cmd cmd = {0};
+#ifdef WINDOWS
+        push(&cmd, "cmd", "/c", "exit", "0");
+#else
+        push(&cmd, "true");
+#endif
+        run_always(&cmd, .procs=&procs);
+    }
+    QOL_TEST_TRUTHY(procs_wait(&procs), "traced commands succeed");
+    QOL_TEST_TRUTHY(trace_end(), "trace written");
+
+    String lines = {0};
+    QOL_TEST_TRUTHY(read_file("/tmp/qol_trace_test.json", &lines), "trace readable");
+    size_t complete = 0;
+    for (size_t i = 0; i < lines.len; i++) {
+        if (str_contains(lines.data[i], "\"ph\":\"X\"")) complete++;
+    }
+    QOL_TEST_EQ(complete, 2, "one complete event per command");
+    release_string(&lines);
+    release(&procs);
+    delete_file("/tmp/qol_trace_test.json");
+}
+
+#ifndef WINDOWS
+QOL_TEST(test_procs_results) {
+    ProcResults results = {0};
+    Procs procs = {.max_jobs = 2, .results = &results};
+    Cmd ok = {0};
+    push(&ok, "true");
+    run_always(&ok, .procs=&procs);
+    Cmd fail = {0};
+    push(&fail, "sh", "-c", "exit 3");
+    run_always(&fail, .procs=&procs);
+    QOL_TEST_FALSY(procs_wait(&procs), "failing command reported");
+
+    QOL_TEST_EQ(results.len, 2, "one result per command");
+    size_t failures = 0;
+    for (size_t i = 0; i < results.len; i++) {
+        if (results.data[i].exit_code == 3) failures++;
+        QOL_TEST_TRUTHY(results.data[i].max_rss_kb > 0, "peak memory reported");
+        QOL_TEST_TRUTHY(results.data[i].name != NULL, "result is labelled");
+    }
+    QOL_TEST_EQ(failures, 1, "exit code recorded");
+    proc_results_report(&results, 10);
+    proc_results_release(&results);
+    release(&procs);
+}
+
+QOL_TEST(test_pool_serializes) {
+    QOL_TEST_TRUTHY(pool_define("test_serial", 1), "pool defined");
+    Procs procs = {.max_jobs = 4};
+    Timer t = {0};
+    timer_start(&t);
+    for (int i = 0; i < 2; i++) {
+        Cmd cmd = {0};
+        push(&cmd, "sh", "-c", "sleep 0.2");
+        QOL_TEST_TRUTHY(run_always(&cmd, .procs=&procs, .pool="test_serial"), "pooled command started");
+    }
+    QOL_TEST_TRUTHY(procs_wait(&procs), "pooled commands succeed");
+    QOL_TEST_TRUTHY(timer_elapsed_ms(&t) >= 390.0, "pool of depth 1 runs commands one after another");
+
+    Cmd unknown = {0};
+    push(&unknown, "true");
+    QOL_TEST_FALSY(run_always(&unknown, .procs=&procs, .pool="no_such_pool"), "undefined pool rejected");
+    release(&procs);
+}
+
+QOL_TEST(test_mem_budget_available) {
+    Procs procs = {.max_jobs = 4, .mem_budget_mb = MEM_AVAILABLE};
+    for (int i = 0; i < 2; i++) {
+        Cmd cmd = {0};
+        push(&cmd, "sh", "-c", "sleep 0.05");
+        QOL_TEST_TRUTHY(run_always(&cmd, .procs=&procs), "budgeted command started");
+    }
+    QOL_TEST_TRUTHY(procs_wait(&procs), "budgeted commands succeed");
+    QOL_TEST_EQ(procs.mem_budget_mb, MEM_AVAILABLE, "budget keeps following the available memory");
+    if (mem_available_mb() > 0) {
+        // A terabyte granted to running commands does not lift the budget above the first launch
+        QOL_TEST_TRUTHY(qol_mem_budget_now((size_t)1 << 40) < ((size_t)1 << 30), "capped at the memory of the first launch");
+    }
+    release(&procs);
+}
+
+QOL_TEST(test_procs_fail_fast) {
+    Procs procs = {.max_jobs = 4, .fail_fast = true};
+    Timer t = {0};
+    timer_start(&t);
+    Cmd slow = {0};
+    push(&slow, "sh", "-c", "sleep 5");
+    run_always(&slow, .procs=&procs);
+    Cmd fail = {0};
+    push(&fail, "sh", "-c", "exit 1");
+    run_always(&fail, .procs=&procs);
+    QOL_TEST_FALSY(procs_wait(&procs), "failure reported");
+    QOL_TEST_TRUTHY(timer_elapsed_ms(&t) < 3000.0, "running command was cancelled");
+    QOL_TEST_FALSY(procs.cancelled, "procs reusable after wait");
+    release(&procs);
+}
+
+QOL_TEST(test_run_timeout) {
+    Timer t = {0};
+    timer_start(&t);
+    Cmd hang = {0};
+    push(&hang, "sleep", "5");
+    QOL_TEST_FALSY(run_always(&hang, .timeout_ms=200), "timed out command fails");
+    QOL_TEST_TRUTHY(timer_elapsed_ms(&t) < 3000.0, "timeout enforced");
+
+#ifndef WINDOWS
+    // The whole process tree is killed, not only the shell
+    struct sigaction before, after;
+    sigaction(SIGINT, NULL, &before);
+    remove("/tmp/qol_timeout_orphan");
+    Cmd tree = {0};
+    push(&tree, "sh", "-c", "(sleep 0.3; touch /tmp/qol_timeout_orphan) & wait");
+    QOL_TEST_FALSY(run_always(&tree, .timeout_ms=100), "timed out tree fails");
+    Cmd settle = {0};
+    push(&settle, "sleep", "0.5");
+    run_always(&settle);
+    QOL_TEST_FALSY(file_exists("/tmp/qol_timeout_orphan"), "grandchild killed with the shell");
+    sigaction(SIGINT, NULL, &after);
+    QOL_TEST_TRUTHY(after.sa_handler == before.sa_handler, "interrupt handler restored");
+#endif
+}
+
+static void qol_test_on_exit(Proc proc, bool success, void *user) {
+    (void)proc;
+    int *counts = (int*)user;
+    counts[success ? 0 : 1]++;
+}
+
+QOL_TEST(test_procs_poll) {
+    int counts[2] = {0};
+    Procs procs = {0};
+    Cmd slow = {0};
+    push(&slow, "sleep", "0.2");
+    run_always(&slow, .procs=&procs, .on_exit=qol_test_on_exit, .user=counts);
+    Cmd fail = {0};
+    push(&fail, "sh", "-c", "exit 3");
+    run_always(&fail, .procs=&procs, .on_exit=qol_test_on_exit, .user=counts);
+
+    size_t reaped = 0;
+    Timer t = {0};
+    timer_start(&t);
+    while (procs.len > 0 && timer_elapsed_ms(&t) < 5000.0) reaped += procs_poll(&procs, 50);
+    QOL_TEST_EQ(reaped, 2, "both commands reaped");
+    QOL_TEST_EQ(counts[0], 1, "success callback");
+    QOL_TEST_EQ(counts[1], 1, "failure callback");
+    QOL_TEST_EQ(procs.failed, 1, "failure counted");
+    QOL_TEST_EQ(procs_poll(&procs, 0), 0, "nothing left to reap");
+
+    Cmd quick = {0};
+    push(&quick, "true");
+    run_always(&quick, .procs=&procs);
+    QOL_TEST_EQ(procs_poll(&procs, -1), 1, "blocking poll waits for the command");
+    QOL_TEST_FALSY(procs_wait(&procs), "wait reports the earlier failure");
+    QOL_TEST_EQ(procs.failed, 0, "wait resets the failure count");
+    release(&procs);
+}
+
+QOL_TEST(test_procs_wait_any_foreign_exit) {
+    // Children of another array that polled once stay registered for exit notifications: once
+    // they exit, waiting on a different array must not spin until its own children are done
+    Procs other = {0};
+    for (int i = 0; i < 2; i++) {
+        Cmd cmd = {0};
+        push(&cmd, "sleep", "0.05");
+        run_always(&cmd, .procs=&other);
+    }
+    QOL_TEST_EQ(procs_poll(&other, 10), 0, "other array still running");
+
+    Procs procs = {0};
+    for (int i = 0; i < 2; i++) {
+        Cmd cmd = {0};
+        push(&cmd, "sleep", "0.5");
+        run_always(&cmd, .procs=&procs);
+    }
+    clock_t cpu = clock();
+    bool success = false;
+    QOL_TEST_TRUTHY(procs_wait_any(&procs, &success) != QOL_INVALID_PROC && success, "own job reaped");
+    double cpu_ms = (double)(clock() - cpu) * 1000.0 / CLOCKS_PER_SEC;
+    QOL_TEST_TRUTHY(cpu_ms < 100.0, "waiting does not burn CPU");
+    QOL_TEST_TRUTHY(procs_wait(&procs), "other own job reaped");
+    QOL_TEST_TRUTHY(procs_wait(&other), "other array collects its stashed children");
+    release(&procs);
+    release(&other);
+}
+
+QOL_TEST(test_jobserver) {
+    const char *before = getenv("MAKEFLAGS");
+    char *saved = before ? strdup(before) : NULL;
+    QOL_TEST_TRUTHY(jobserver_init(2), "jobserver in use");
+    QOL_TEST_TRUTHY(jobserver_init(4), "jobserver grown");
+    const char *makeflags = getenv("MAKEFLAGS");
+    QOL_TEST_TRUTHY(makeflags && strstr(makeflags, "--jobserver-auth=") != NULL, "jobserver exported");
+    QOL_TEST_TRUTHY(makeflags && strstr(makeflags, "-j4 ") != NULL, "largest limit exported");
+
+    Cmd child = {0};
+    push(&child, "sh", "-c", "case \"$MAKEFLAGS\" in *--jobserver-auth=*) exit 0;; esac; exit 1");
+    QOL_TEST_TRUTHY(run_always(&child), "children see the jobserver");
+
+    Procs procs = {.max_jobs = 4};
+    for (int i = 0; i < 8; i++) {
+        Cmd cmd = {0};
+        push(&cmd, "sh", "-c", "sleep 0.05");
+        run_always(&cmd, .procs=&procs);
+    }
+    QOL_TEST_TRUTHY(procs_wait(&procs), "commands ran");
+    release(&procs);
+
+    QOL_TEST_TRUTHY(jobserver_stop(), "all slots released");
+    const char *after = getenv("MAKEFLAGS");
+    QOL_TEST_TRUTHY(saved ? after && strcmp(after, saved) == 0 : after == NULL, "MAKEFLAGS restored");
+    free(saved);
+}
+
+QOL_TEST(test_worker) {
+    // A tool that records which process served a request in the file it is given
+    const char *tool =
+        "#define QOL_IMPLEMENTATION\n"
+        "#include \"build.h\"\n"
+        "static int handle(int argc, char **argv, QOL_WorkerOutput *out) {\n"
+        "    if (argc < 2 || strcmp(argv[1], \"fail\") == 0) return 1;\n"
+        "    FILE *f = fopen(argv[1], \"w\");\n"
+        "    if (!f) return 1;\n"
+        "    fprintf(f, \"%d\", (int)getpid());\n"
+        "    fclose(f);\n"
+        "    qol_worker_printf(out, \"served %s\", argv[1]);\n"
+        "    return 0;\n"
+        "}\n"
+        "int main(int argc, char **argv) { return qol_worker_main(argc, argv, handle); }\n";
+    QOL_TEST_TRUTHY(write_file("/tmp/qol_test_worker.c", tool, strlen(tool)), "tool source written");
+    Cmd cc = {0};
+    push(&cc, "cc", "-I.", "-o", "/tmp/qol_test_worker", "/tmp/qol_test_worker.c");
+    QOL_TEST_TRUTHY(run_always(&cc), "tool compiled");
+
+    char path[64];
+    for (int i = 0; i < 4; i++) {
+        snprintf(path, sizeof(path), "/tmp/qol_test_worker_%d.txt", i);
+        Cmd cmd = {0};
+        push(&cmd, "/tmp/qol_test_worker", path);
+        QOL_TEST_TRUTHY(run_always(&cmd, .worker=true), "sync request served");
+    }
+    Cmd fail = {0};
+    push(&fail, "/tmp/qol_test_worker", "fail");
+    QOL_TEST_FALSY(run_always(&fail, .worker=true), "failed request reported");
+
+    int served[2] = {0};
+    Procs procs = {.max_jobs = 2};
+    for (int i = 4; i < 10; i++) {
+        snprintf(path, sizeof(path), "/tmp/qol_test_worker_%d.txt", i);
+        Cmd cmd = {0};
+        push(&cmd, "/tmp/qol_test_worker", path);
+        run_always(&cmd, .procs=&procs, .worker=true, .on_exit=qol_test_on_exit, .user=served);
+        if (qol_workers_pending(&procs) > 2) served[1]++;
+    }
+    QOL_TEST_TRUTHY(procs_wait(&procs), "async requests served");
+    QOL_TEST_EQ(served[0], 6, "callbacks ran");
+    QOL_TEST_EQ(served[1], 0, "requests stayed within max_jobs");
+
+    // Sync requests share one worker, the failed request recycles it
+    String pids[10] = {0};
+    for (int i = 0; i < 10; i++) {
+        snprintf(path, sizeof(path), "/tmp/qol_test_worker_%d.txt", i);
+        read_file(path, &pids[i]);
+        delete_file(path);
+    }
+    QOL_TEST_TRUTHY(pids[0].len > 0 && pids[3].len > 0 && strcmp(pids[0].data[0], pids[3].data[0]) == 0, "worker persisted");
+    QOL_TEST_TRUTHY(pids[3].len > 0 && pids[4].len > 0 && strcmp(pids[3].data[0], pids[4].data[0]) != 0, "worker recycled after failure");
+    for (int i = 0; i < 10; i++) release_string(&pids[i]);
+
+    // A program that does not speak the protocol still runs, as a plain process
+    Cmd plain = {0};
+    push(&plain, "echo", "not a worker");
+    QOL_TEST_TRUTHY(run_always(&plain, .worker=true), "first request falls back");
+    push(&plain, "echo", "not a worker");
+    QOL_TEST_TRUTHY(run_always(&plain, .worker=true, .procs=&procs), "later requests run as processes");
+    QOL_TEST_TRUTHY(procs_wait(&procs), "fallback reaped");
+
+    workers_shutdown();
+    QOL_TEST_EQ(qol_workers.len, 0, "workers stopped");
+    release(&procs);
+
+    // A request cut short is a protocol error, not a clean shutdown
+    QOL_TEST_TRUTHY(system("printf '\\010\\000\\000\\000abc' | /tmp/qol_test_worker " QOL_WORKER_FLAG " >/dev/null") != 0, "truncated request fails the worker");
+    QOL_TEST_TRUTHY(system("/tmp/qol_test_worker " QOL_WORKER_FLAG " </dev/null") == 0, "closed stdin ends the worker cleanly");
+    delete_file("/tmp/qol_test_worker");
+    delete_file("/tmp/qol_test_worker.c");
+}
+#endif
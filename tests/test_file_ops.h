@@ -37,3 +37,140 @@ QOL_TEST(test_file_get_filename_no_ext) {
     free(name);
 }
 
+
+QOL_TEST(test_stat_cache) {
+    const char* dir = qol_temp_dir_path();
+    QOL_TEST_TRUTHY(mkdir_if_not_exists(dir), "mkdir_if_not_exists works");
+    char file_path[512];
+    snprintf(file_path, sizeof(file_path), "%s/%s", dir, "stat_cache.txt");
+    QOL_TEST_TRUTHY(write_file(file_path, "abc", 3), "write_file succeeds");
+
+    FileStat st = {0};
+    stat_cache_begin();
+    StatCacheStats before = stat_cache_stats();
+    QOL_TEST_TRUTHY(stat_cached(file_path, &st), "file exists");
+    QOL_TEST_EQ(st.size, 3, "size is reported");
+    QOL_TEST_TRUTHY(stat_cached(file_path, &st), "second lookup");
+    StatCacheStats after = stat_cache_stats();
+    QOL_TEST_EQ(after.misses - before.misses, 1, "first lookup stats the file");
+    QOL_TEST_EQ(after.hits - before.hits, 1, "second lookup is a hit");
+
+    // Written behind the cache's back: the stale entry stays until invalidated
+    FILE *fp = fopen(file_path, "ab");
+    QOL_TEST_TRUTHY(fp != NULL, "append to file");
+    fputs("def", fp);
+    fclose(fp);
+    stat_cached(file_path, &st);
+    QOL_TEST_EQ(st.size, 3, "cached size until invalidated");
+    stat_invalidate(file_path);
+    stat_cached(file_path, &st);
+    QOL_TEST_EQ(st.size, 6, "fresh size after invalidation");
+
+    // The file helpers invalidate on their own
+    QOL_TEST_TRUTHY(delete_file(file_path), "delete_file succeeds");
+    QOL_TEST_FALSY(stat_cached(file_path, &st), "deleted file is gone");
+    QOL_TEST_FALSY(st.exists, "exists flag cleared");
+    stat_cache_end();
+
+    // Outside of a build nothing is cached
+    QOL_TEST_TRUTHY(write_file(file_path, "abc", 3), "file written again");
+    stat_cached(file_path, &st);
+    fp = fopen(file_path, "ab");
+    QOL_TEST_TRUTHY(fp != NULL, "append to file");
+    fputs("def", fp);
+    fclose(fp);
+    stat_cached(file_path, &st);
+    QOL_TEST_EQ(st.size, 6, "fresh size without a scope");
+    delete_file(file_path);
+}
+
+QOL_TEST(test_stat_batch) {
+    const char* dir = qol_temp_dir_path();
+    QOL_TEST_TRUTHY(mkdir_if_not_exists(dir), "mkdir_if_not_exists works");
+
+    // Enough paths to fan out over several threads, every tenth one missing
+    enum { COUNT = 300 };
+    static char names[COUNT][512];
+    const char *paths[COUNT];
+    for (size_t i = 0; i < COUNT; i++) {
+        snprintf(names[i], sizeof(names[i]), "%s/batch_%zu.txt", dir, i);
+        if (i % 10 != 0) write_file(names[i], "abcd", i % 4 + 1);
+        else stat_invalidate(names[i]);
+        paths[i] = names[i];
+    }
+
+    FileStat stats[COUNT];
+    stat_cache_begin();
+    stat_batch(paths, COUNT, stats);
+    size_t wrong = 0;
+    for (size_t i = 0; i < COUNT; i++) {
+        if (i % 10 == 0) wrong += stats[i].exists;
+        else wrong += !stats[i].exists || stats[i].size != (int64_t)(i % 4 + 1) || stats[i].mtime_ns == 0;
+    }
+    QOL_TEST_EQ(wrong, 0, "every path reported in order");
+
+    StatCacheStats before = stat_cache_stats();
+    stat_batch(paths, COUNT, NULL);
+    StatCacheStats after = stat_cache_stats();
+    QOL_TEST_EQ(after.hits - before.hits, COUNT, "second batch is served from the cache");
+    stat_cache_end();
+
+    // Outside of a build the batch is not cached: each input is still stat'ed only once
+    const char *inputs[COUNT];
+    size_t input_count = 0;
+    for (size_t i = 0; i < COUNT; i++) if (i % 10 != 0) inputs[input_count++] = names[i];
+    char output[512];
+    snprintf(output, sizeof(output), "%s/batch_out.txt", dir);
+    write_file(output, "x", 1);
+    before = stat_cache_stats();
+    QOL_TEST_EQ(needs_rebuild(output, inputs, input_count), 0, "output is up to date");
+    after = stat_cache_stats();
+    QOL_TEST_EQ(after.misses - before.misses, input_count + 1, "one stat per path");
+    delete_file(output);
+
+    for (size_t i = 0; i < COUNT; i++) if (i % 10 != 0) delete_file(names[i]);
+}
+
+QOL_TEST(test_watch_wait) {
+    const char* dir = qol_temp_dir_path();
+    QOL_TEST_TRUTHY(mkdir_if_not_exists(dir), "mkdir_if_not_exists works");
+    char watched[512], other[512];
+    snprintf(watched, sizeof(watched), "%s/watched.txt", dir);
+    snprintf(other, sizeof(other), "%s/other.txt", dir);
+    QOL_TEST_TRUTHY(write_file(watched, "abc", 3), "write watched file");
+    stat_cache_begin(); // What the "last build" saw
+    stat_cached(watched, NULL);
+    stat_cache_end();
+
+    // Another file in the same directory first, then the watched one
+    Cmd cmd = {0};
+    char script[1200];
+    snprintf(script, sizeof(script), "sleep 0.1; echo x > %s; sleep 0.1; echo changed > %s", other, watched);
+    push(&cmd, "sh", "-c", script);
+    Procs procs = {0};
+    QOL_TEST_TRUTHY(run_always(&cmd, .procs=&procs), "writer started");
+
+    const char *paths[] = { watched };
+    QOL_String changed = {0};
+    QOL_TEST_TRUTHY(watch_wait(paths, 1, 0, &changed), "watch reports a change");
+    // Woken by other.txt, the watch would return before the watched file is rewritten
+    FileStat now;
+    QOL_TEST_TRUTHY(stat_cached(watched, &now) && now.size == 8, "unrelated file in the directory is ignored");
+    QOL_TEST_EQ(changed.len, 1, "one changed path");
+    if (changed.len == 1) QOL_TEST_STREQ(changed.data[0], watched, "the watched path");
+    release_string(&changed);
+    procs_wait(&procs);
+    release(&cmd);
+    release(&procs);
+
+    // A change the watcher did not see happen is reported right away
+    FileStat st;
+    stat_cache_begin();
+    QOL_TEST_TRUTHY(stat_cached(watched, &st) && st.size == 8, "watched file rewritten");
+    stat_cache_end();
+    FILE *fp = fopen(watched, "ab");
+    if (fp) { fputs("more", fp); fclose(fp); }
+    QOL_TEST_TRUTHY(watch_wait(paths, 1, 0, NULL), "missed change is caught up");
+    delete_file(watched);
+    delete_file(other);
+}
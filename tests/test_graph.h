@@ -0,0 +1,146 @@
+#define QOL_IMPLEMENTATION
+#define QOL_STRIP_PREFIX
+#include "../build.h"
+
+static Cmd qol_test_copy_cmd(const char *src, const char *dst) {
+    Cmd cmd = {0};
+    push(&cmd, "cp", src, dst);
+    return cmd;
+}
+
+#ifndef WINDOWS
+QOL_TEST(test_graph_build_chain) {
+    mkdir_if_not_exists("/tmp/qol_graph_test");
+    write_file("/tmp/qol_graph_test/a.txt", "a", 1);
+    delete_file("/tmp/qol_graph_test/b.txt");
+    delete_file("/tmp/qol_graph_test/c.txt");
+
+    Graph graph = {0};
+    // Added in reverse order on purpose: the scheduler has to sort them
+    Target *c = graph_add(&graph, qol_test_copy_cmd("/tmp/qol_graph_test/b.txt", "/tmp/qol_graph_test/c.txt"));
+    push(&c->inputs, "/tmp/qol_graph_test/b.txt");
+    push(&c->outputs, "/tmp/qol_graph_test/c.txt");
+    Target *b = graph_add(&graph, qol_test_copy_cmd("/tmp/qol_graph_test/a.txt", "/tmp/qol_graph_test/b.txt"));
+    push(&b->inputs, "/tmp/qol_graph_test/a.txt");
+    push(&b->outputs, "/tmp/qol_graph_test/b.txt");
+
+    QOL_TEST_TRUTHY(graph_build(&graph, .jobs=2), "graph builds");
+    QOL_TEST_EQ(graph.built, 2, "both targets ran");
+    QOL_TEST_TRUTHY(file_exists("/tmp/qol_graph_test/c.txt"), "final output exists");
+
+    QOL_TEST_TRUTHY(graph_build(&graph), "no-op build succeeds");
+    QOL_TEST_EQ(graph.built, 0, "nothing ran on no-op build");
+    QOL_TEST_EQ(graph.up_to_date, 2, "both targets up to date");
+
+    graph_release(&graph);
+    QOL_TEST_EQ(graph.len, 0, "graph released");
+    delete_dir("/tmp/qol_graph_test");
+}
+#endif
+
+QOL_TEST(test_graph_build_cycle) {
+    Graph graph = {0};
+    Target *x = graph_add(&graph, qol_test_copy_cmd("/tmp/qol_graph_test/y", "/tmp/qol_graph_test/x"));
+    push(&x->inputs, "/tmp/qol_graph_test/y");
+    push(&x->outputs, "/tmp/qol_graph_test/x");
+    Target *y = graph_add(&graph, qol_test_copy_cmd("/tmp/qol_graph_test/x", "/tmp/qol_graph_test/y"));
+    push(&y->inputs, "/tmp/qol_graph_test/x");
+    push(&y->outputs, "/tmp/qol_graph_test/y");
+
+    QOL_TEST_FALSY(graph_build(&graph), "cycle is rejected");
+    QOL_TEST_EQ(graph.built, 0, "nothing ran");
+    graph_release(&graph);
+}
+
+#ifndef WINDOWS
+QOL_TEST(test_graph_build_restat) {
+    mkdir_if_not_exists("/tmp/qol_restat_test");
+    write_file("/tmp/qol_restat_test/src.txt", "v1", 2);
+    delete_file("/tmp/qol_restat_test/gen.h");
+    delete_file("/tmp/qol_restat_test/app.txt");
+    struct utimbuf old = { .actime = time(NULL) - 3600, .modtime = time(NULL) - 3600 };
+    utime("/tmp/qol_restat_test/src.txt", &old);
+    stat_invalidate("/tmp/qol_restat_test/src.txt");
+
+    Graph graph = {0};
+    Target *gen = graph_add(&graph, qol_test_copy_cmd("/tmp/qol_restat_test/src.txt", "/tmp/qol_restat_test/gen.h"));
+    push(&gen->inputs, "/tmp/qol_restat_test/src.txt");
+    push(&gen->outputs, "/tmp/qol_restat_test/gen.h");
+    gen->restat = true;
+    Target *app = graph_add(&graph, qol_test_copy_cmd("/tmp/qol_restat_test/gen.h", "/tmp/qol_restat_test/app.txt"));
+    push(&app->inputs, "/tmp/qol_restat_test/gen.h");
+    push(&app->outputs, "/tmp/qol_restat_test/app.txt");
+
+    QOL_TEST_TRUTHY(graph_build(&graph), "initial build");
+    QOL_TEST_EQ(graph.built, 2, "both targets ran");
+
+    // The generator has to run again but writes the same content
+    struct utimbuf older = { .actime = time(NULL) - 7200, .modtime = time(NULL) - 7200 };
+    utime("/tmp/qol_restat_test/gen.h", &older);
+    stat_invalidate("/tmp/qol_restat_test/gen.h");
+    QOL_TEST_TRUTHY(graph_build(&graph), "generator rerun");
+    QOL_TEST_EQ(graph.built, 1, "only the generator ran");
+    QOL_TEST_EQ(graph.up_to_date, 1, "dependent kept");
+    struct stat sb;
+    QOL_TEST_TRUTHY(stat("/tmp/qol_restat_test/gen.h", &sb) == 0 && sb.st_mtime > time(NULL) - 60, "output timestamp left alone");
+
+    QOL_TEST_TRUTHY(graph_build(&graph), "no-op build");
+    QOL_TEST_EQ(graph.built, 0, "restat output counts as current");
+
+    write_file("/tmp/qol_restat_test/src.txt", "v2", 2);
+    QOL_TEST_TRUTHY(graph_build(&graph), "changed generator output");
+    QOL_TEST_EQ(graph.built, 2, "dependent rebuilt");
+    graph_release(&graph);
+    delete_dir("/tmp/qol_restat_test");
+}
+#endif
+
+#ifndef WINDOWS
+static Target *qol_test_order_target(Graph *graph, const char *name, uint64_t duration_ms) {
+    Cmd cmd = {0};
+    push(&cmd, "sh", "-c", temp_sprintf("echo %s >> /tmp/qol_ljf_test/order && touch /tmp/qol_ljf_test/%s", name, name));
+    Target *target = graph_add(graph, cmd);
+    const char *output = temp_sprintf("/tmp/qol_ljf_test/%s", name);
+    push(&target->outputs, output);
+    delete_file(output);
+    build_log_record(output, &(BuildLogEntry){ .duration_ms = duration_ms }); // History of an earlier build
+    return target;
+}
+
+QOL_TEST(test_graph_build_longest_first) {
+    mkdir_if_not_exists("/tmp/qol_ljf_test");
+    for (int fifo = 0; fifo <= 1; fifo++) {
+        delete_file("/tmp/qol_ljf_test/order");
+        Graph graph = {0};
+        qol_test_order_target(&graph, "fast1", 10);
+        qol_test_order_target(&graph, "fast2", 10);
+        qol_test_order_target(&graph, "slow", 5000);
+        GraphSchedule schedule = {0};
+        QOL_TEST_TRUTHY(graph_build(&graph, .jobs=1, .fifo=fifo, .schedule=&schedule), "graph builds");
+        QOL_TEST_EQ(schedule.commands, 3, "all targets scheduled");
+        QOL_TEST_EQ(schedule.critical_ms, 5000, "critical path from the build log");
+        QOL_TEST_EQ(schedule.estimated_ms, 5020, "one job runs all the work");
+
+        String order = {0};
+        QOL_TEST_TRUTHY(read_file("/tmp/qol_ljf_test/order", &order), "order recorded");
+        QOL_TEST_TRUTHY(order.len == 3 && str_contains(order.data[0], fifo ? "fast1" : "slow"),
+                        fifo ? "fifo keeps insertion order" : "longest job first");
+        release_string(&order);
+        graph_release(&graph);
+    }
+
+    // Two graphs in one schedule: the work adds up, the critical path is the longest single one
+    GraphSchedule both = {0};
+    for (int k = 0; k < 2; k++) {
+        Graph graph = {0};
+        qol_test_order_target(&graph, "fast1", 10);
+        qol_test_order_target(&graph, "slow", 5000);
+        QOL_TEST_TRUTHY(graph_build(&graph, .jobs=1, .schedule=&both), "graph builds");
+        graph_release(&graph);
+    }
+    QOL_TEST_EQ(both.commands, 4, "schedules add up");
+    QOL_TEST_EQ(both.work_ms, 10020, "work adds up");
+    QOL_TEST_EQ(both.critical_ms, 5000, "critical path is per graph");
+    delete_dir("/tmp/qol_ljf_test");
+}
+#endif
@@ -7,6 +7,7 @@
 #include "test_cmd_exec.h"
 #include "test_dynarray.h"
 #include "test_file_ops.h"
+#include "test_graph.h"
 #include "test_hashmap.h"
 #include "test_helper.h"
 #include "test_logger.h"
@@ -15,5 +16,10 @@
 
 int main() {
     init_logger(.only=LOG_HINT, .only_set=true, .time=true, .color=true);
+    // Tests record made-up build history: keep it out of the checkout's .qol_log and .qol_deps
+    delete_file("/tmp/qol_unittests.log");
+    build_log_open("/tmp/qol_unittests.log");
+    delete_file("/tmp/qol_unittests.deps");
+    deps_log_open("/tmp/qol_unittests.deps");
     return test_run_all();
 }